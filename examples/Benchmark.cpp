@@ -0,0 +1,527 @@
+#include <SFGUI/SFGUI.hpp>
+#include <SFGUI/Adjustment.hpp>
+#include <SFGUI/Box.hpp>
+#include <SFGUI/Button.hpp>
+#include <SFGUI/Label.hpp>
+#include <SFGUI/ListBox.hpp>
+#include <SFGUI/ScrolledWindow.hpp>
+#include <SFGUI/Scrollbar.hpp>
+#include <SFGUI/Window.hpp>
+#include <SFGUI/Context.hpp>
+#include <SFGUI/Desktop.hpp>
+#include <SFGUI/Engine.hpp>
+#include <SFGUI/Renderer.hpp>
+#include <SFGUI/RenderQueue.hpp>
+#include <SFGUI/Primitive.hpp>
+#include <SFGUI/PrimitiveTexture.hpp>
+#include <SFGUI/PrimitiveVertex.hpp>
+
+#include <SFML/Graphics.hpp>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Each benchmark sets up a scenario, measures the operation in question
+// and prints the result to the console. Make sure to run a release build,
+// debug builds are not representative.
+
+namespace {
+
+void PrintResult( const std::string& name, const sf::Time& time ) {
+	std::cout << name << ": " << time.asMicroseconds() << " microsecs\n";
+}
+
+std::vector<std::unique_ptr<sfg::RenderQueue>> CreateQueues( std::size_t queue_count, std::size_t primitives_per_queue ) {
+	std::vector<std::unique_ptr<sfg::RenderQueue>> queues;
+	queues.reserve( queue_count );
+
+	for( std::size_t queue_index = 0; queue_index < queue_count; ++queue_index ) {
+		std::unique_ptr<sfg::RenderQueue> queue( new sfg::RenderQueue );
+
+		for( std::size_t primitive_index = 0; primitive_index < primitives_per_queue; ++primitive_index ) {
+			auto position = sf::Vector2f( static_cast<float>( primitive_index * 10 ), static_cast<float>( queue_index % 60 * 10 ) );
+			queue->Add( sfg::Renderer::Get().CreateRect( sf::FloatRect( position, sf::Vector2f( 8.f, 8.f ) ) ) );
+		}
+
+		queues.push_back( std::move( queue ) );
+	}
+
+	return queues;
+}
+
+// Teardown of 100k primitives, the way destroying a huge ListBox or Table
+// releases them: every RenderQueue unregisters its primitives at once.
+void BenchmarkPrimitiveTeardown( sf::RenderWindow& render_window, sfg::SFGUI& sfgui ) {
+	const static std::size_t queue_count = 10000;
+	const static std::size_t primitives_per_queue = 10;
+
+	std::cout << "Primitive teardown (" << queue_count * primitives_per_queue << " primitives)\n";
+
+	{
+		auto queues = CreateQueues( queue_count, primitives_per_queue );
+		sfgui.Display( render_window );
+
+		sf::Clock clock;
+		queues.clear();
+		PrintResult( "  RenderQueue destruction", clock.getElapsedTime() );
+
+		clock.restart();
+		sfgui.Display( render_window );
+		PrintResult( "  First display afterwards", clock.getElapsedTime() );
+	}
+
+	{
+		auto queues = CreateQueues( queue_count, primitives_per_queue );
+		sfgui.Display( render_window );
+
+		// Unregister one primitive at a time, back to front
+		// like RenderQueue used to, for comparison.
+		sf::Clock clock;
+
+		for( const auto& queue : queues ) {
+			const auto& primitives = queue->GetPrimitives();
+
+			for( auto iter = primitives.rbegin(); iter != primitives.rend(); ++iter ) {
+				sfg::Renderer::Get().RemovePrimitive( *iter );
+			}
+		}
+
+		PrintResult( "  Individual RemovePrimitive calls", clock.getElapsedTime() );
+	}
+}
+
+void PrintAtlasStatistics() {
+	const auto statistics = sfg::Renderer::Get().GetAtlasStatistics();
+
+	for( std::size_t page = 0; page < statistics.size(); ++page ) {
+		std::cout << "  Page " << page << ": " << statistics[page].size.x << "x" << statistics[page].size.y
+		          << ", " << statistics[page].allocation_count << " images"
+		          << ", occupancy " << statistics[page].occupancy * 100.f << "%"
+		          << ", " << statistics[page].free_rect_count << " free rects"
+		          << ", fragmentation " << statistics[page].fragmentation * 100.f << "%\n";
+	}
+}
+
+// Load a few thousand icon sized images into the atlas, release every other
+// one and fill the holes again, the way widgets come and go over time.
+void BenchmarkAtlasPacking() {
+	const static std::size_t image_count = 4000;
+
+	std::cout << "Atlas packing (" << image_count << " images)\n";
+
+	std::mt19937 generator( 42 );
+	std::uniform_int_distribution<unsigned int> size_distribution( 8, 64 );
+
+	std::vector<sf::Image> images( image_count );
+
+	for( auto& image : images ) {
+		image.create( size_distribution( generator ), size_distribution( generator ), sf::Color::Red );
+	}
+
+	std::vector<sfg::PrimitiveTexture::Ptr> textures;
+	textures.reserve( image_count );
+
+	sf::Clock clock;
+
+	for( const auto& image : images ) {
+		textures.push_back( sfg::Renderer::Get().LoadTexture( image ) );
+	}
+
+	PrintResult( "  Loading", clock.getElapsedTime() );
+	PrintAtlasStatistics();
+
+	for( std::size_t index = 0; index < image_count; index += 2 ) {
+		textures[index].reset();
+	}
+
+	std::cout << "  After releasing every other image:\n";
+	PrintAtlasStatistics();
+
+	clock.restart();
+
+	for( std::size_t index = 0; index < image_count; index += 2 ) {
+		textures[index] = sfg::Renderer::Get().LoadTexture( images[index] );
+	}
+
+	PrintResult( "  Reloading", clock.getElapsedTime() );
+	PrintAtlasStatistics();
+}
+
+// Build a few thousand lines of text, the way a long ListBox or a log
+// window does, once from sf::Text and once from a plain string.
+void BenchmarkTextCreation() {
+	const static std::size_t text_count = 5000;
+
+	std::cout << "Text creation (" << text_count << " lines)\n";
+
+	const auto font = sfg::Context::Get().GetEngine().GetResourceManager().GetFont( "Default" );
+	const sf::String string( "The quick brown fox jumps over the lazy dog. 0123456789" );
+
+	std::vector<std::shared_ptr<sfg::Primitive>> primitives;
+	primitives.reserve( text_count );
+
+	sf::Clock clock;
+
+	for( std::size_t index = 0; index < text_count; ++index ) {
+		sf::Text text( string, *font, 12 );
+		text.setPosition( 0.f, static_cast<float>( index % 40 * 14 ) );
+
+		primitives.push_back( sfg::Renderer::Get().CreateText( text ) );
+	}
+
+	PrintResult( "  From sf::Text", clock.getElapsedTime() );
+
+	sfg::Renderer::Get().RemovePrimitives( primitives );
+	primitives.clear();
+
+	sfg::Renderer::TextStyle style;
+	style.font = font.get();
+	style.character_size = 12;
+
+	clock.restart();
+
+	for( std::size_t index = 0; index < text_count; ++index ) {
+		primitives.push_back( sfg::Renderer::Get().CreateText( string, sf::Vector2f( 0.f, static_cast<float>( index % 40 * 14 ) ), style ) );
+	}
+
+	PrintResult( "  From string and style", clock.getElapsedTime() );
+
+	sfg::Renderer::Get().RemovePrimitives( primitives );
+}
+
+// Build one big primitive out of quads, the way custom drawables do,
+// once with duplicate vertex search and once with known topology.
+void BenchmarkPrimitiveBuilding() {
+	const static std::size_t quad_count = 5000;
+
+	std::cout << "Primitive building (" << quad_count << " quads)\n";
+
+	std::vector<sfg::PrimitiveVertex> vertices( quad_count * 4 );
+
+	for( std::size_t index = 0; index < vertices.size(); ++index ) {
+		vertices[index].position = sf::Vector2f( static_cast<float>( index / 4 % 100 * 8 + index % 2 * 8 ), static_cast<float>( index / 400 * 8 + index / 2 % 2 * 8 ) );
+	}
+
+	sfg::Primitive deduplicated;
+
+	sf::Clock clock;
+
+	for( std::size_t index = 0; index < vertices.size(); index += 4 ) {
+		deduplicated.AddVertex( vertices[index + 0], true );
+		deduplicated.AddVertex( vertices[index + 2], true );
+		deduplicated.AddVertex( vertices[index + 1], true );
+		deduplicated.AddVertex( vertices[index + 1], true );
+		deduplicated.AddVertex( vertices[index + 2], true );
+		deduplicated.AddVertex( vertices[index + 3], true );
+	}
+
+	PrintResult( "  AddVertex with deduplication", clock.getElapsedTime() );
+
+	sfg::Primitive quads;
+
+	clock.restart();
+
+	quads.Reserve( vertices.size(), quad_count * 6 );
+
+	for( std::size_t index = 0; index < vertices.size(); index += 4 ) {
+		quads.AddQuad( vertices[index + 0], vertices[index + 2], vertices[index + 3], vertices[index + 1] );
+	}
+
+	PrintResult( "  AddQuad", clock.getElapsedTime() );
+}
+
+// Scroll through a 10k row list one step per frame. Scrolling
+// shouldn't have to rebuild or upload any of the rows.
+void BenchmarkViewportScrolling( sf::RenderWindow& render_window, sfg::SFGUI& sfgui ) {
+	const static std::size_t row_count = 10000;
+	const static std::size_t frame_count = 500;
+
+	std::cout << "Viewport scrolling (" << row_count << " rows, " << frame_count << " frames)\n";
+
+	auto box = sfg::Box::Create( sfg::Box::Orientation::VERTICAL );
+
+	for( std::size_t row = 0; row < row_count; ++row ) {
+		box->Pack( sfg::Label::Create( "Row " + std::to_string( row ) ) );
+	}
+
+	auto scrolled_window = sfg::ScrolledWindow::Create();
+	scrolled_window->SetScrollbarPolicy( sfg::ScrolledWindow::HORIZONTAL_NEVER | sfg::ScrolledWindow::VERTICAL_AUTOMATIC );
+	scrolled_window->AddWithViewport( box );
+	scrolled_window->SetAllocation( sf::FloatRect( 0.f, 0.f, 400.f, 600.f ) );
+	scrolled_window->Update( 0.f );
+
+	sfgui.Display( render_window );
+
+	auto adjustment = scrolled_window->GetVerticalAdjustment();
+
+	std::size_t rebuilt_vertex_count = 0;
+	std::size_t uploaded_bytes = 0;
+
+	sf::Clock clock;
+
+	for( std::size_t frame = 0; frame < frame_count; ++frame ) {
+		adjustment->SetValue( static_cast<float>( frame * 20 ) );
+		scrolled_window->Update( 0.f );
+
+		sfgui.Display( render_window );
+
+		const auto& statistics = sfgui.GetRenderer().GetFrameStatistics();
+
+		rebuilt_vertex_count += statistics.rebuilt_vertex_count;
+		uploaded_bytes += statistics.uploaded_vertex_bytes + statistics.uploaded_index_bytes + statistics.uploaded_texture_bytes;
+	}
+
+	PrintResult( "  Scrolling", clock.getElapsedTime() );
+
+	std::cout << "  Rebuilt vertices: " << rebuilt_vertex_count << ", uploaded bytes: " << uploaded_bytes << "\n";
+}
+
+// Every widget throws away its RenderQueue and builds a new one each frame.
+// Once the pool is warmed up no primitive should have to be allocated.
+void BenchmarkWidgetInvalidation( sf::RenderWindow& render_window, sfg::SFGUI& sfgui ) {
+	const static std::size_t button_count = 1000;
+	const static std::size_t frame_count = 100;
+
+	std::cout << "Widget invalidation (" << button_count << " buttons, " << frame_count << " frames)\n";
+
+	auto box = sfg::Box::Create( sfg::Box::Orientation::VERTICAL );
+
+	for( std::size_t button = 0; button < button_count; ++button ) {
+		box->Pack( sfg::Button::Create( "Button " + std::to_string( button ) ) );
+	}
+
+	box->SetAllocation( sf::FloatRect( 0.f, 0.f, 800.f, 600.f ) );
+	box->Update( 0.f );
+
+	sfgui.Display( render_window );
+
+	std::size_t created_count = 0;
+	std::size_t recycled_count = 0;
+
+	sf::Clock clock;
+
+	for( std::size_t frame = 0; frame < frame_count; ++frame ) {
+		for( const auto& child : box->GetChildren() ) {
+			child->Invalidate();
+		}
+
+		box->Update( 0.f );
+
+		sfgui.Display( render_window );
+
+		const auto& statistics = sfgui.GetRenderer().GetFrameStatistics();
+
+		// The first frame still has to fill the pool.
+		if( frame ) {
+			created_count += statistics.created_primitive_count;
+			recycled_count += statistics.recycled_primitive_count;
+		}
+	}
+
+	PrintResult( "  Invalidation", clock.getElapsedTime() );
+
+	std::cout << "  Created primitives: " << created_count << ", recycled primitives: " << recycled_count << "\n";
+}
+
+// Clicking a window brings it to the front and restacks every window in
+// front of it. Raising the backmost window every frame restacks all of them,
+// none of them should have to recreate its drawable for that.
+void BenchmarkWindowRestacking( sf::RenderWindow& render_window, sfg::SFGUI& sfgui ) {
+	const static std::size_t window_count = 200;
+	const static std::size_t frame_count = 500;
+
+	std::cout << "Window restacking (" << window_count << " windows, " << frame_count << " frames)\n";
+
+	sfg::Desktop desktop;
+
+	std::vector<sfg::Window::Ptr> windows;
+
+	for( std::size_t index = 0; index < window_count; ++index ) {
+		auto window = sfg::Window::Create();
+		window->SetTitle( "Window " + std::to_string( index ) );
+		window->Add( sfg::Button::Create( "Button " + std::to_string( index ) ) );
+		window->SetPosition( sf::Vector2f( static_cast<float>( index % 20 * 30 ), static_cast<float>( index / 20 * 40 ) ) );
+
+		desktop.Add( window );
+		windows.push_back( window );
+	}
+
+	desktop.Update( 0.f );
+
+	sfgui.Display( render_window );
+
+	std::size_t created_primitive_count = 0;
+
+	sf::Clock clock;
+
+	for( std::size_t frame = 0; frame < frame_count; ++frame ) {
+		desktop.BringToFront( windows[frame % window_count] );
+		desktop.Update( 0.f );
+
+		sfgui.Display( render_window );
+
+		const auto& statistics = sfgui.GetRenderer().GetFrameStatistics();
+
+		created_primitive_count += statistics.created_primitive_count + statistics.recycled_primitive_count;
+	}
+
+	PrintResult( "  Restacking", clock.getElapsedTime() );
+
+	std::cout << "  Primitives created: " << created_primitive_count << "\n";
+}
+
+// Fill a window with labels and change their texts afterwards. Each of these
+// requests a resize, the layout should still only be calculated once per frame.
+void BenchmarkLayout( sf::RenderWindow& render_window, sfg::SFGUI& sfgui ) {
+	const static std::size_t label_count = 5000;
+
+	std::cout << "Layout (" << label_count << " labels)\n";
+
+	sfg::Desktop desktop;
+
+	auto window = sfg::Window::Create();
+	auto box = sfg::Box::Create( sfg::Box::Orientation::VERTICAL );
+
+	window->Add( box );
+	desktop.Add( window );
+
+	std::vector<sfg::Label::Ptr> labels;
+	labels.reserve( label_count );
+
+	sf::Clock clock;
+
+	for( std::size_t index = 0; index < label_count; ++index ) {
+		labels.push_back( sfg::Label::Create( "Label " + std::to_string( index ) ) );
+		box->Pack( labels.back() );
+	}
+
+	desktop.Update( 0.f );
+
+	PrintResult( "  Packing", clock.getElapsedTime() );
+
+	sfgui.Display( render_window );
+
+	clock.restart();
+
+	for( std::size_t index = 0; index < label_count; ++index ) {
+		labels[index]->SetText( "Changed label " + std::to_string( index ) );
+	}
+
+	desktop.Update( 0.f );
+
+	PrintResult( "  Changing texts", clock.getElapsedTime() );
+
+	sfgui.Display( render_window );
+}
+
+// Fill a ListBox one item at a time and change some of the items afterwards.
+// Only the new or changed items' texts should have to be measured.
+void BenchmarkListBoxFilling( sf::RenderWindow& render_window, sfg::SFGUI& sfgui ) {
+	const static std::size_t item_count = 10000;
+	const static std::size_t frame_count = 100;
+
+	std::cout << "ListBox filling (" << item_count << " items, " << frame_count << " frames)\n";
+
+	sfg::Desktop desktop;
+
+	auto window = sfg::Window::Create();
+	auto list_box = sfg::ListBox::Create();
+
+	window->Add( list_box );
+	desktop.Add( window );
+
+	sf::Clock clock;
+
+	for( std::size_t index = 0; index < item_count; ++index ) {
+		list_box->AppendItem( "Item " + std::to_string( index ) );
+
+		// Keep the layout up to date the way an application filling
+		// the list over several frames would.
+		if( index % ( item_count / frame_count ) == 0 ) {
+			desktop.Update( 0.f );
+		}
+	}
+
+	desktop.Update( 0.f );
+
+	PrintResult( "  Filling", clock.getElapsedTime() );
+
+	sfgui.Display( render_window );
+
+	clock.restart();
+
+	for( std::size_t frame = 0; frame < frame_count; ++frame ) {
+		list_box->ChangeItemText( static_cast<sfg::ListBox::IndexType>( frame * 13 % item_count ), "Changed item " + std::to_string( frame ) );
+		desktop.Update( 0.f );
+	}
+
+	PrintResult( "  Changing items", clock.getElapsedTime() );
+
+	sfgui.Display( render_window );
+}
+
+// Scroll through a ListBox backed by a million item model. Only the
+// items scrolling into view should have to be fetched.
+void BenchmarkListBoxModel( sf::RenderWindow& render_window, sfg::SFGUI& sfgui ) {
+	const static sfg::ListBox::IndexType item_count = 1000000;
+	const static std::size_t frame_count = 500;
+
+	std::cout << "ListBox model (" << item_count << " items, " << frame_count << " frames)\n";
+
+	std::size_t fetch_count = 0;
+
+	auto list_box = sfg::ListBox::Create();
+	list_box->SetItemModel( item_count, [&fetch_count]( sfg::ListBox::IndexType index ) {
+		++fetch_count;
+		return sfg::ListBox::Item{ "Symbol " + std::to_string( index ), sf::Image() };
+	} );
+
+	list_box->SetAllocation( sf::FloatRect( 0.f, 0.f, 400.f, 600.f ) );
+	list_box->Update( 0.f );
+
+	sfgui.Display( render_window );
+
+	// The scrollbar is the ListBox's only child.
+	auto adjustment = std::static_pointer_cast<sfg::Scrollbar>( list_box->GetChildren().front() )->GetAdjustment();
+
+	fetch_count = 0;
+
+	sf::Clock clock;
+
+	for( std::size_t frame = 0; frame < frame_count; ++frame ) {
+		adjustment->SetValue( static_cast<float>( frame * 3 ) );
+		list_box->Update( 0.f );
+
+		sfgui.Display( render_window );
+	}
+
+	PrintResult( "  Scrolling", clock.getElapsedTime() );
+
+	std::cout << "  Fetched items: " << fetch_count << "\n";
+}
+
+}
+
+int main() {
+	sf::RenderWindow render_window( sf::VideoMode( 800, 600 ), "SFGUI Benchmark" );
+	sfg::SFGUI sfgui;
+
+	render_window.resetGLStates();
+
+	std::cout << "Renderer: " << sfgui.GetRenderer().GetName() << "\n";
+
+	BenchmarkPrimitiveTeardown( render_window, sfgui );
+	BenchmarkAtlasPacking();
+	BenchmarkTextCreation();
+	BenchmarkPrimitiveBuilding();
+	BenchmarkViewportScrolling( render_window, sfgui );
+	BenchmarkWidgetInvalidation( render_window, sfgui );
+	BenchmarkWindowRestacking( render_window, sfgui );
+	BenchmarkLayout( render_window, sfgui );
+	BenchmarkListBoxFilling( render_window, sfgui );
+	BenchmarkListBoxModel( render_window, sfgui );
+
+	return 0;
+}
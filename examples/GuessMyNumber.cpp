@@ -117,6 +117,9 @@ int main() {
 
 	reset_game();
 
+	// The window's size is needed right away to center it.
+	sfg::Widget::FlushLayout();
+
 	window->SetPosition(
 		sf::Vector2f(
 			static_cast<float>( render_window.getSize().x / 2 ) - window->GetAllocation().width / 2.f,
@@ -28,6 +28,7 @@ class SampleApp {
 		void OnToggleSpinner();
 		void OnMirrorImageClick();
 		void OnSwitchRendererClick();
+		void OnStreamingBuffersToggle();
 		void RenderCustomGL();
 		void RenderCustomSFML();
 
@@ -55,6 +56,7 @@ class SampleApp {
 		sfg::Canvas::Ptr m_gl_canvas;
 		//sfg::Canvas::Ptr m_sfml_canvas;
 		sfg::Button::Ptr m_switch_renderer;
+		sfg::CheckButton::Ptr m_streaming_check;
 
 		sfg::Desktop m_desktop;
 
@@ -342,6 +344,10 @@ void SampleApp::Run() {
 
 	boxtoolbar2->Pack( m_switch_renderer, false );
 
+	m_streaming_check = sfg::CheckButton::Create( L"Streaming buffers" );
+
+	boxtoolbar2->Pack( m_streaming_check, false );
+
 	auto frame2 = sfg::Frame::Create( L"Toolbar 2" );
 	frame2->Add( boxtoolbar2 );
 	frame2->SetAlignment( sf::Vector2f( .8f, .0f ) );
@@ -467,6 +473,7 @@ void SampleApp::Run() {
 	spinner_toggle->GetSignal( sfg::Widget::OnLeftClick ).Connect( [this] { OnToggleSpinner(); } );
 	mirror_image->GetSignal( sfg::Widget::OnLeftClick ).Connect( [this] { OnMirrorImageClick(); } );
 	m_switch_renderer->GetSignal( sfg::Widget::OnLeftClick ).Connect( [this] { OnSwitchRendererClick(); } );
+	m_streaming_check->GetSignal( sfg::ToggleButton::OnToggle ).Connect( [this] { OnStreamingBuffersToggle(); } );
 
 	spinbutton->SetValue( 20.f );
 	spinbutton->GetAdjustment()->SetMinorStep( .8f );
@@ -540,6 +547,10 @@ void SampleApp::Run() {
 
 	std::fill( std::begin( frame_times ), std::end( frame_times ), 0 );
 
+	// Frame times with streaming buffers disabled and enabled, for comparison.
+	sf::Int64 streaming_frame_time_totals[2] = { 0, 0 };
+	sf::Int64 streaming_frame_counts[2] = { 0, 0 };
+
 	m_desktop.Update( 0.f );
 
 	while( m_window.isOpen() ) {
@@ -586,6 +597,10 @@ void SampleApp::Run() {
 		frame_times[ frame_times_index ] = frame_time;
 		frame_times_index = ( frame_times_index + 1 ) % 5000;
 
+		const auto streaming_index = m_streaming_check->IsActive() ? 1 : 0;
+		streaming_frame_time_totals[streaming_index] += frame_time;
+		++streaming_frame_counts[streaming_index];
+
 		if( m_fps_clock.getElapsedTime().asMicroseconds() >= 1000000 ) {
 			m_fps_clock.restart();
 
@@ -599,7 +614,9 @@ void SampleApp::Run() {
 			sstr << "SFGUI test -- FPS: " << m_fps_counter << " -- Frame Time (microsecs): min: "
 			<< *std::min_element( frame_times, frame_times + 5000 ) << " max: "
 			<< *std::max_element( frame_times, frame_times + 5000 ) << " avg: "
-			<< static_cast<float>( total_time ) / 5000.f;
+			<< static_cast<float>( total_time ) / 5000.f << " -- Streaming buffers avg off: "
+			<< static_cast<float>( streaming_frame_time_totals[0] ) / static_cast<float>( std::max( streaming_frame_counts[0], sf::Int64( 1 ) ) ) << " on: "
+			<< static_cast<float>( streaming_frame_time_totals[1] ) / static_cast<float>( std::max( streaming_frame_counts[1], sf::Int64( 1 ) ) );
 
 			m_window.setTitle( sstr.str() );
 
@@ -754,6 +771,7 @@ void SampleApp::OnSwitchRendererClick() {
 
 		renderer->TuneUseFBO( true );
 		renderer->TuneCull( true );
+		renderer->TuneUseStreamingBuffers( m_streaming_check->IsActive() );
 
 		m_switch_renderer->SetLabel( "Renderer: NLR" );
 
@@ -774,6 +792,12 @@ void SampleApp::OnSwitchRendererClick() {
 	}
 }
 
+void SampleApp::OnStreamingBuffersToggle() {
+	if( sfg::Renderer::Get().GetName() == "Non-Legacy Renderer" ) {
+		static_cast<sfg::NonLegacyRenderer*>( &sfg::Renderer::Get() )->TuneUseStreamingBuffers( m_streaming_check->IsActive() );
+	}
+}
+
 void SampleApp::RenderCustomGL() {
 	static sf::Clock clock;
 
@@ -46,6 +46,8 @@ class SFGUI_API BREW : public Engine {
 		std::unique_ptr<RenderQueue> CreateListBoxDrawable( std::shared_ptr<const ListBox> listbox ) const override;
 
 	private:
+		bool UpdateButtonDrawable( std::shared_ptr<const Button> button, RenderQueue& queue ) const;
+
 		static std::unique_ptr<RenderQueue> CreateBorder( const sf::FloatRect& rect, float border_width, const sf::Color& light_color, const sf::Color& dark_color );
 		static std::unique_ptr<RenderQueue> CreateSlider( const sf::FloatRect& rect, sf::Color& background_color, float border_width, const sf::Color& border_color, int border_color_shift );
 		static std::unique_ptr<RenderQueue> CreateStepper( const sf::FloatRect& rect, sf::Color& background_color, float border_width, const sf::Color& border_color, int border_color_shift, bool pressed = false );
@@ -8,6 +8,8 @@
 
 namespace sfg {
 
+class PrimitiveTexture;
+
 /** Image.
  */
 class SFGUI_API Image : public Widget, public Misc {
@@ -44,7 +46,7 @@ class SFGUI_API Image : public Widget, public Misc {
 
 	private:
 		sf::Image m_image;
-		mutable sf::Vector2f m_texture_offset;
+		mutable std::weak_ptr<PrimitiveTexture> m_texture;
 };
 
 }
@@ -6,7 +6,14 @@
 #include <SFML/Graphics/Image.hpp>
 #include <SFML/System/String.hpp>
 
+namespace sf {
+class Font;
+}
+
+#include <deque>
+#include <functional>
 #include <initializer_list>
+#include <map>
 #include <memory>
 #include <set>
 #include <vector>
@@ -24,6 +31,7 @@ class SFGUI_API ListBox : public Container {
 		typedef std::shared_ptr<ListBox> Ptr; //!< Shared pointer.
 		typedef std::shared_ptr<const ListBox> PtrConst; //!< Shared pointer.
 		typedef int IndexType;
+		typedef std::function<Item( IndexType )> ItemFetcher; //!< Returns the item at an index of an item model.
 
 		static const IndexType NONE;
 
@@ -62,10 +70,21 @@ class SFGUI_API ListBox : public Container {
 		void RemoveItem( IndexType index );
 		void Clear();
 
+		/** Let the listbox fetch its items from a model instead of storing them.
+		 * Only the displayed items are fetched and kept, the listbox's width is
+		 * calculated from those. Stored items are removed and the functions
+		 * modifying items are ignored until Clear() is called. Call again
+		 * whenever the model's items change.
+		 * @param items_count Number of items in the model.
+		 * @param fetcher Callback returning the item at an index.
+		 */
+		void SetItemModel( IndexType items_count, ItemFetcher fetcher );
+		bool HasItemModel() const;
+
 		IndexType GetItemsCount() const;
-		const sf::String& GetItemText( IndexType index ) const;
-		const sf::String& GetDisplayedItemText( IndexType index ) const;
-		const sf::Image& GetItemImage( IndexType index ) const;
+		sf::String GetItemText( IndexType index ) const;
+		sf::String GetDisplayedItemText( IndexType index ) const;
+		sf::Image GetItemImage( IndexType index ) const;
 
 		IndexType GetHighlightedItem() const;
 
@@ -78,7 +97,7 @@ class SFGUI_API ListBox : public Container {
 		bool IsItemSelected( IndexType index ) const;
         IndexType GetSelectedItemsCount() const;
 		IndexType GetSelectedItemIndex( IndexType index = 0 ) const;
-		const sf::String& GetSelectedItemText( IndexType index = 0 ) const;
+		sf::String GetSelectedItemText( IndexType index = 0 ) const;
 
 		IndexType GetFirstDisplayedItemIndex() const;
 		IndexType GetDisplayedItemsCount() const;
@@ -120,6 +139,10 @@ class SFGUI_API ListBox : public Container {
 
 		IndexType GetItemAt( float y ) const;
 
+		const Item* GetStoredItem( IndexType index ) const;
+
+		bool CanModifyItems() const;
+
 		bool IsScrollbarVisible() const;
 
 		void UpdateDisplayedItems();
@@ -128,10 +151,31 @@ class SFGUI_API ListBox : public Container {
 
 		void UpdateDisplayedItemsText();
 
+		void FetchDisplayedItems();
+
+		void MeasureItems( const std::shared_ptr<const sf::Font>& font, unsigned int font_size );
+		void ForgetItemWidth( std::size_t index );
+
 		void OnScrollbarChanged();
 
 		std::vector<Item> m_items;
 
+		// Text width of each item, negative until it is measured. The widths
+		// are counted as well, so the widest item is known without a scan.
+		std::vector<float> m_item_widths;
+		std::map<float, IndexType> m_item_width_counts;
+		IndexType m_unmeasured_items_count;
+		std::shared_ptr<const sf::Font> m_measured_font;
+		unsigned int m_measured_font_size;
+
+		ItemFetcher m_item_fetcher;
+		IndexType m_model_items_count;
+
+		// Displayed items of the model, starting at m_fetched_items_first.
+		// Items still displayed after scrolling are kept.
+		std::deque<Item> m_fetched_items;
+		IndexType m_fetched_items_first;
+
 		SelectionMode m_selection_mode;
 		std::set<IndexType> m_selected_items;
 
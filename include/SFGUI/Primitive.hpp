@@ -3,7 +3,9 @@
 #include <SFGUI/Config.hpp>
 #include <SFGUI/PrimitiveVertex.hpp>
 
+#include <SFML/Graphics/Rect.hpp>
 #include <SFML/System/Vector2.hpp>
+#include <cstdint>
 #include <vector>
 #include <memory>
 
@@ -29,10 +31,44 @@ class SFGUI_API Primitive {
 		 */
 		void Add( Primitive& primitive );
 
-		/** Add vertex to this primitive.
+		/** Reserve space for vertices and indices that are about to be added.
+		 * @param vertex_count Number of vertices that will be added.
+		 * @param index_count Number of indices that will be added.
+		 */
+		void Reserve( std::size_t vertex_count, std::size_t index_count );
+
+		/** Add vertex to this primitive and index it.
+		 * Every 3 vertices added this way form a triangle.
+		 * Searching for duplicates takes time linear in the number of vertices
+		 * in this primitive, prefer AddQuad or AddTriangleIndexed when the
+		 * topology is known up front.
+		 * @param vertex Vertex to add.
+		 * @param deduplicate true to index an identical vertex that is already part of this primitive instead of adding it again.
+		 */
+		void AddVertex( const PrimitiveVertex& vertex, bool deduplicate = false );
+
+		/** Add vertex to this primitive without indexing it.
+		 * Use AddTriangleIndexed to build triangles out of the added vertices.
 		 * @param vertex Vertex to add.
+		 * @return Index of the added vertex.
+		 */
+		unsigned int AddUnindexedVertex( const PrimitiveVertex& vertex );
+
+		/** Add a triangle made up of vertices that are already part of this primitive.
+		 * @param index0 Index of the first vertex of the triangle.
+		 * @param index1 Index of the second vertex of the triangle.
+		 * @param index2 Index of the third vertex of the triangle.
+		 */
+		void AddTriangleIndexed( unsigned int index0, unsigned int index1, unsigned int index2 );
+
+		/** Add a quad made up of two triangles to this primitive.
+		 * The vertices are added as they are, without searching for duplicates.
+		 * @param top_left Top left vertex of the quad.
+		 * @param bottom_left Bottom left vertex of the quad.
+		 * @param bottom_right Bottom right vertex of the quad.
+		 * @param top_right Top right vertex of the quad.
 		 */
-		void AddVertex( const PrimitiveVertex& vertex );
+		void AddQuad( const PrimitiveVertex& top_left, const PrimitiveVertex& bottom_left, const PrimitiveVertex& bottom_right, const PrimitiveVertex& top_right );
 
 		/** Add texture to this primitive.
 		 * @param texture Texture to add.
@@ -82,6 +118,7 @@ class SFGUI_API Primitive {
 		int GetLevel() const;
 
 		/** Get vertices in this primitive.
+		 * Moving vertices through the returned reference doesn't update GetBounds().
 		 * @return Vertices in this primitive.
 		 */
 		std::vector<PrimitiveVertex>& GetVertices();
@@ -96,7 +133,16 @@ class SFGUI_API Primitive {
 		 */
 		const std::vector<unsigned int>& GetIndices() const;
 
+		/** Get the bounding box of the vertices in this primitive.
+		 * It is kept up to date while vertices are added and doesn't include the position.
+		 * @return Bounding box of the vertices in this primitive.
+		 */
+		const sf::FloatRect& GetBounds() const;
+
 		/** Set whether the primitive is synced with the VBO.
+		 * Only changes to the geometry of the primitive (its vertices and indices)
+		 * clear this flag. Position, viewport, layer, level and visibility are
+		 * picked up by the renderer without having to resync the vertex data.
 		 * @param synced true to flag that primitive is synced with the VBO.
 		 */
 		void SetSynced( bool synced = true );
@@ -126,12 +172,25 @@ class SFGUI_API Primitive {
 		 */
 		std::shared_ptr<Signal> GetCustomDrawCallback() const;
 
+		/** Set the handle the renderer registered this primitive under.
+		 * @param handle Handle of this primitive, 0 if not registered.
+		 */
+		void SetHandle( std::uint64_t handle );
+
+		/** Get the handle the renderer registered this primitive under.
+		 * @return Handle of this primitive, 0 if not registered.
+		 */
+		std::uint64_t GetHandle() const;
+
 		/** Reset the primitive back to its default state.
 		 * This clears all vertices, textures, indices and any other saved values.
 		 */
 		void Clear();
 
 	private:
+		void ExtendBounds( std::size_t first_vertex );
+		void Damage();
+
 		sf::Vector2f m_position;
 		std::shared_ptr<RendererViewport> m_viewport;
 		std::shared_ptr<Signal> m_custom_draw_callback;
@@ -142,6 +201,10 @@ class SFGUI_API Primitive {
 		std::vector<std::shared_ptr<PrimitiveTexture>> m_textures;
 		std::vector<unsigned int> m_indices;
 
+		sf::FloatRect m_bounds;
+
+		std::uint64_t m_handle;
+
 		bool m_synced;
 		bool m_visible;
 };
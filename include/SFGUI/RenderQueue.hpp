@@ -3,6 +3,7 @@
 #include <SFGUI/Config.hpp>
 
 #include <SFML/System/Vector2.hpp>
+#include <functional>
 #include <vector>
 #include <memory>
 
@@ -88,12 +89,25 @@ class SFGUI_API RenderQueue {
 		 */
 		std::shared_ptr<RendererViewport> GetViewport() const;
 
+		/** Set the function that updates this queue in place when the state of its widget changes.
+		 * Engines set it for drawables whose states only differ in colors.
+		 * @param updater Function rewriting the primitives of the queue, returns false if the queue has to be recreated instead.
+		 */
+		void SetStateUpdater( std::function<bool( RenderQueue& )> updater );
+
+		/** Update this queue in place after the state of its widget changed.
+		 * @return true if the queue was updated, false if it has to be recreated.
+		 */
+		bool UpdateState();
+
 	private:
 		std::vector<std::shared_ptr<Primitive>> m_primitives;
 
 		sf::Vector2f m_position;
 		std::shared_ptr<RendererViewport> m_viewport;
 
+		std::function<bool( RenderQueue& )> m_state_updater;
+
 		int m_z_order;
 		int m_level;
 
@@ -1,14 +1,22 @@
 #pragma once
 
 #include <SFGUI/Config.hpp>
+#include <SFGUI/RendererAtlasPage.hpp>
+#include <SFGUI/RendererGlyphCopy.hpp>
+#include <SFGUI/RendererGlyphTable.hpp>
+#include <SFGUI/RendererPrimitiveSlot.hpp>
+#include <SFGUI/RendererTargetState.hpp>
 #include <SFGUI/RendererTextureNode.hpp>
 
 #include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
 #include <SFML/Graphics/Rect.hpp>
-#include <deque>
+#include <SFML/System/Time.hpp>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace sf {
@@ -19,7 +27,7 @@ class RenderTexture;
 class Texture;
 class Font;
 class Text;
-class Image;
+class String;
 }
 
 namespace sfg {
@@ -29,6 +37,12 @@ class Primitive;
 class PrimitiveTexture;
 class Signal;
 
+namespace priv {
+struct RendererBatch;
+struct RendererPrimitiveRange;
+class WorkerPool;
+}
+
 /** SFGUI Renderer interface.
  */
 class SFGUI_API Renderer {
@@ -38,7 +52,51 @@ class SFGUI_API Renderer {
 			INVALIDATE_COLOR = 1 << 1, //!< Color data needs a sync.
 			INVALIDATE_TEXTURE = 1 << 2, //!< Texture data needs a sync.
 			INVALIDATE_INDEX = 1 << 3, //!< Index data needs a sync.
-			INVALIDATE_ALL = INVALIDATE_VERTEX | INVALIDATE_COLOR | INVALIDATE_TEXTURE | INVALIDATE_INDEX //!< All data needs a sync.
+			INVALIDATE_VIEWPORT = 1 << 4, //!< Viewport source origins need a sync.
+			INVALIDATE_ALL = INVALIDATE_VERTEX | INVALIDATE_COLOR | INVALIDATE_TEXTURE | INVALIDATE_INDEX | INVALIDATE_VIEWPORT //!< All data needs a sync.
+		};
+
+		/** Occupancy of a single texture atlas page.
+		 */
+		struct AtlasPageStatistics {
+			sf::Vector2u size; //!< Size of the page texture.
+			std::size_t allocation_count; //!< Number of images stored in the page.
+			std::size_t allocated_area; //!< Pixels occupied by images, including padding.
+			std::size_t free_rect_count; //!< Number of disjoint free rectangles within the page texture.
+			std::size_t largest_free_area; //!< Pixels in the largest free rectangle within the page texture.
+			float occupancy; //!< Fraction of the page texture occupied by images.
+			float fragmentation; //!< 1 - largest free rectangle / total free area within the page texture.
+		};
+
+		/** Statistics of a single displayed frame.
+		 * Primitive and batch counts describe what was drawn, they only
+		 * change in frames in which the renderer rebuilt its data.
+		 */
+		struct FrameStatistics {
+			std::size_t primitive_count = 0; //!< Number of primitives registered with the renderer.
+			std::size_t visible_primitive_count = 0; //!< Number of primitives drawn.
+			std::size_t culled_primitive_count = 0; //!< Number of visible primitives skipped because they lie outside of their viewport.
+			std::size_t batch_count = 0; //!< Number of batches the primitives are grouped into.
+			std::size_t draw_call_count = 0; //!< Number of draw calls issued, including custom draws and cache blits.
+			std::size_t rebuilt_vertex_count = 0; //!< Number of vertices written into the renderer's vertex data.
+			std::size_t rebuilt_index_count = 0; //!< Number of indices written into the renderer's index data.
+			std::size_t uploaded_vertex_bytes = 0; //!< Bytes of vertex data (positions, colors and texture coordinates) sent to the GPU.
+			std::size_t uploaded_index_bytes = 0; //!< Bytes of index data sent to the GPU.
+			std::size_t uploaded_texture_bytes = 0; //!< Bytes of texture data sent to the GPU, e.g. primitive transforms.
+			sf::Time refresh_time; //!< Time spent rebuilding the renderer's data.
+			std::size_t atlas_page_count = 0; //!< Number of atlas pages.
+			float atlas_occupancy = 0.f; //!< Fraction of the atlas page textures occupied by images.
+			std::size_t created_primitive_count = 0; //!< Number of primitives constructed since the previous frame because the pool was empty.
+			std::size_t recycled_primitive_count = 0; //!< Number of primitives reused from the pool since the previous frame, along with their vertex and index storage.
+			bool cache_hit = false; //!< true if the frame was displayed from the cache without redrawing anything.
+		};
+
+		/** Appearance of text created with CreateText.
+		 */
+		struct TextStyle {
+			const sf::Font* font = nullptr; //!< Font to draw the text with.
+			unsigned int character_size = 0; //!< Character size in pixels.
+			sf::Color color = sf::Color::White; //!< Fill color of the text.
 		};
 
 		Renderer( const Renderer& ) = delete;
@@ -46,6 +104,7 @@ class SFGUI_API Renderer {
 
 		/** Create the Renderer singleton instance.
 		 * SFGUI will automatically detect what is the best renderer for your given hardware.
+		 * Setting the environment variable SFGUI_RENDERER to "software" selects the SoftwareRenderer instead.
 		 * @return Renderer instance.
 		 */
 		static Renderer& Create();
@@ -89,6 +148,15 @@ class SFGUI_API Renderer {
 		 */
 		std::shared_ptr<Primitive> CreateText( const sf::Text& text );
 
+		/** Create and register a new text primitive with the renderer.
+		 * Saves having to set up an sf::Text just to describe the text.
+		 * @param string String to be drawn.
+		 * @param position Position of the top left corner of the text.
+		 * @param style Font, character size and color of the text.
+		 * @return New text primitive.
+		 */
+		std::shared_ptr<Primitive> CreateText( const sf::String& string, const sf::Vector2f& position, const TextStyle& style );
+
 		/** Create and register a new quad primitive with the renderer.
 		 * @param top_left Top left corner of the quad.
 		 * @param bottom_left Bottom left corner of the quad.
@@ -166,6 +234,23 @@ class SFGUI_API Renderer {
 		 */
 		std::shared_ptr<Primitive> CreateGLCanvas( std::shared_ptr<Signal> callback );
 
+		/** Change the colors of a pane created with CreatePane in place.
+		 * Only the colors are synced, the renderer doesn't have to lay out its primitives again.
+		 * @param primitive Pane to recolor.
+		 * @param color Color of the pane.
+		 * @param border_color Border color.
+		 * @param border_color_shift Border color shift.
+		 * @return false if the vertices can't be told apart, the pane has to be recreated then.
+		 */
+		bool RecolorPane( Primitive& primitive, const sf::Color& color, const sf::Color& border_color = sf::Color::Black, int border_color_shift = 0 );
+
+		/** Change the color of every vertex of a primitive in place, e.g. of text created with CreateText.
+		 * Only the colors are synced, the renderer doesn't have to lay out its primitives again.
+		 * @param primitive Primitive to recolor.
+		 * @param color New color.
+		 */
+		void RecolorPrimitive( Primitive& primitive, const sf::Color& color );
+
 		/** Register a primitive with the renderer.
 		 * @param primitive Primitive to be registered.
 		 */
@@ -176,14 +261,40 @@ class SFGUI_API Renderer {
 		 */
 		void RemovePrimitive( std::shared_ptr<Primitive> primitive );
 
+		/** Unregister multiple primitives from the renderer at once.
+		 * This is a lot cheaper than removing the primitives one by one.
+		 * @param primitives Primitives to be unregistered.
+		 */
+		void RemovePrimitives( const std::vector<std::shared_ptr<Primitive>>& primitives );
+
 		/// @cond
 
-		/** Load a Font at the given size and retrieve the texture atlas offset.
-		 * @param font sf::Font containing the font.
+		/** Move a registered primitive to its new place in the draw order.
+		 * Called by the primitive whenever its layer or level changes.
+		 * @param primitive Primitive whose layer or level changed.
+		 */
+		void ReorderPrimitive( const Primitive& primitive );
+
+		/** Queue the area of a registered primitive for redrawing.
+		 * Called by the primitive whenever its geometry, position, viewport or visibility changes.
+		 * @param primitive Primitive that changed.
+		 */
+		void DamagePrimitive( const Primitive& primitive );
+
+		/** Redraw the area of a viewport.
+		 * Called by the viewport before and after it scrolls, moves or is resized.
+		 * @param viewport Viewport that changes.
+		 */
+		void DamageViewport( const RendererViewport& viewport );
+
+		/** Load a glyph of a Font at the given size and retrieve its texture atlas offset.
+		 * Glyphs are copied into the atlas the first time they are requested.
+		 * @param font sf::Font containing the glyph.
+		 * @param codepoint Codepoint of the glyph.
 		 * @param size Size of the font.
-		 * @return Offset into the atlas the font texture is located at.
+		 * @return Offset into the atlas the glyph texture is located at.
 		 */
-		sf::Vector2f LoadFont( const sf::Font& font, unsigned int size );
+		sf::Vector2f LoadGlyph( const sf::Font& font, sf::Uint32 codepoint, unsigned int size );
 
 		/** Load an sf::Texture into the atlas and return a handle to the allocated texture.
 		 * This merely copies the data from the origin sf::Texture into the atlas.
@@ -193,6 +304,8 @@ class SFGUI_API Renderer {
 		std::shared_ptr<PrimitiveTexture> LoadTexture( const sf::Texture& texture );
 
 		/** Load an sf::Image into the atlas and return a handle to the allocated texture.
+		 * If an image with identical contents is already loaded, the returned handle
+		 * shares its atlas space. The space is released once the last handle is destroyed.
 		 * @param image sf::Image containing the image data.
 		 * @return Shared handle to the allocated texture.
 		 */
@@ -210,11 +323,22 @@ class SFGUI_API Renderer {
 		 */
 		void UpdateImage( const sf::Vector2f& offset, const sf::Image& data );
 
+		/** Check whether more than one handle refers to the image at the given offset.
+		 * @param offset The offset the image is at in the texture atlas.
+		 * @return true if updating the image would change what other handles show.
+		 */
+		bool IsImageShared( const sf::Vector2f& offset ) const;
+
 		/// @endcond
 
+		/** Get occupancy and fragmentation of every texture atlas page.
+		 * @return Statistics of every atlas page, in page order.
+		 */
+		std::vector<AtlasPageStatistics> GetAtlasStatistics() const;
+
 		/** Invalidate renderer datasets so they are resynchronized with fresh data.
 		 * @param datasets The datasets to invalidate. Default: INVALIDATE_ALL
-		 * Bitwise OR of INVALIDATE_VERTEX, INVALIDATE_COLOR, INVALIDATE_TEXTURE or INVALIDATE_INDEX.
+		 * Bitwise OR of INVALIDATE_VERTEX, INVALIDATE_COLOR, INVALIDATE_TEXTURE, INVALIDATE_INDEX or INVALIDATE_VIEWPORT.
 		 */
 		void Invalidate( unsigned char datasets = INVALIDATE_ALL );
 
@@ -233,19 +357,59 @@ class SFGUI_API Renderer {
 		 */
 		virtual void Display( sf::RenderTexture& target ) const = 0;
 
+		/** Release everything the renderer keeps for an sf::Window.
+		 * Render targets are told apart by their address. Call this before
+		 * destroying a target the GUI was displayed on, otherwise the GL objects
+		 * kept for it leak and a target created at the same address later on
+		 * picks them up. The target's context is activated to delete them.
+		 * @param target sf::Window that isn't drawn to anymore.
+		 */
+		void ForgetTarget( sf::Window& target );
+
+		/** Release everything the renderer keeps for an sf::RenderWindow.
+		 * @param target sf::RenderWindow that isn't drawn to anymore.
+		 */
+		void ForgetTarget( sf::RenderWindow& target );
+
+		/** Release everything the renderer keeps for an sf::RenderTexture.
+		 * @param target sf::RenderTexture that isn't drawn to anymore.
+		 */
+		void ForgetTarget( sf::RenderTexture& target );
+
 		/** Force the renderer to discard its cache's FBO image and redraw.
 		 */
 		void Redraw();
 
+		/** Get the statistics of the last displayed frame.
+		 * @return Statistics of the last displayed frame.
+		 */
+		const FrameStatistics& GetFrameStatistics() const;
+
+		/** Get the statistics of the most recently displayed frames.
+		 * @return Statistics of the most recently displayed frames, oldest first.
+		 */
+		std::vector<FrameStatistics> GetFrameStatisticsHistory() const;
+
+		/** Set the number of frames whose statistics are kept.
+		 * @param size Number of frames whose statistics are kept, at least 1.
+		 */
+		void SetFrameStatisticsHistorySize( std::size_t size );
+
+		/** Get the area of the window that changed during the last Display() call.
+		 * Everything outside of it looks exactly like it did the frame before,
+		 * applications can use this to only present part of the window.
+		 * @return Changed area in window coordinates, empty if nothing changed.
+		 */
+		const sf::IntRect& GetDamagedArea() const;
+
 		/** Get the size of the window the last time the GUI was displayed.
 		 * @return Size of the window the last time the GUI was displayed.
 		 */
 		const sf::Vector2i& GetWindowSize() const;
 
-		/** Add a required character set to the character sets that the Renderer will load for new fonts.
-		 * This is required if using a script whose glyphs are not smaller than codepoint 0x370
-		 * such as Greek, Cyrillic, Hebrew, Arabic etc.
-		 * By default, only the Latin script and its extensions are loaded.
+		/** Add a character set to the character sets that the Renderer will preload for new fonts.
+		 * Glyphs are loaded on demand, so this is never required. It merely moves
+		 * the cost of loading a script's glyphs to the time a font is first used.
 		 * @param low_bound Lower boundary of the character set, i.e. the glyph with the smallest codepoint.
 		 * @param high_bound Higher boundary of the character set, i.e. the glyph with the largest codepoint.
 		 */
@@ -260,41 +424,161 @@ class SFGUI_API Renderer {
 
 	protected:
 		typedef std::pair<void*, unsigned int> FontID;
+		typedef std::pair<std::uint64_t, std::uint64_t> PrimitiveKey; // ( ( layer, level ), sequence )
 
 		/** Ctor.
+		 * @param keep_atlas_images true to keep a copy of every atlas page in m_atlas_images.
 		 */
-		Renderer();
+		explicit Renderer( bool keep_atlas_images = false );
 
 		virtual void InvalidateImpl( unsigned char datasets );
 
+		/** Called whenever the contents of an atlas page change.
+		 * @param page Index of the atlas page.
+		 * @param rect Region of the page that changed.
+		 */
+		virtual void InvalidateAtlasImpl( std::size_t page, const sf::IntRect& rect );
+
 		void SortPrimitives();
 
+		/** Add the window area of every primitive that changed since the last call to the damaged area.
+		 * Only the primitives that reported a change are looked at.
+		 */
+		void CollectDamage();
+
+		/** Lay out the visible primitives for rebuilding the vertex and index data from scratch.
+		 * Culls primitives that lie outside of their viewport if requested, assigns every other
+		 * primitive its place in the vertex and index data and splits them up into batches.
+		 * The ranges of different primitives never overlap, so they can be filled in in parallel.
+		 * Marks all primitives synced.
+		 * @param cull true to cull primitives that lie outside of their viewport.
+		 * @param ranges Receives the primitives whose vertices and indices have to be filled in.
+		 * @param batches Receives the batches to draw.
+		 * @param vertex_count Receives the total number of vertices.
+		 * @param index_count Receives the total number of indices.
+		 */
+		void LayoutPrimitives( bool cull, std::vector<priv::RendererPrimitiveRange>& ranges, std::vector<priv::RendererBatch>& batches, int& vertex_count, int& index_count );
+
+		/** Switch to the state kept for a render target.
+		 * Every render target remembers the size it was last drawn at, its
+		 * pending damage and whatever the backend caches for it. Drawing to
+		 * several targets in turn doesn't make them throw away each other's state.
+		 * The state is kept until ForgetTarget() is called for the target.
+		 * @param target Render target about to be drawn to.
+		 */
+		void SelectTarget( const void* target ) const;
+
+		/** Discard the state kept for a render target.
+		 * @param target Render target whose state to discard.
+		 */
+		void ForgetTargetState( const void* target );
+
+		/** Called whenever a different render target is selected.
+		 * Backends swap their per target state in and out here.
+		 * @param previous_target Render target drawn to so far, nullptr if none.
+		 * @param target Render target about to be drawn to.
+		 */
+		virtual void SelectTargetImpl( const void* previous_target, const void* target ) const;
+
+		/** Called when a render target's state is discarded.
+		 * Backends delete the objects they keep for the target here,
+		 * the target's context is active.
+		 * @param target Render target whose state to discard.
+		 * @param current true if the target is the one selected at the moment.
+		 */
+		virtual void ForgetTargetImpl( const void* target, bool current );
+
+		/** Finish the damaged area of the current frame.
+		 * @param full_redraw true if the whole window is redrawn regardless of what changed.
+		 */
+		void UpdateDamagedArea( bool full_redraw ) const;
+
+		/** Reset the per frame counters of m_frame_statistics.
+		 */
+		void BeginFrameStatistics() const;
+
+		/** Complete m_frame_statistics and add it to the history.
+		 */
+		void EndFrameStatistics() const;
+
 		int GetMaxTextureSize() const;
 
+		/** Get the atlas page a primitive is drawn with when only one page can be bound.
+		 * The bound texture can only change between triangles,
+		 * the last triangle decides which page the primitive is drawn with.
+		 * @param primitive Primitive.
+		 * @return Atlas page, 0 if the primitive has no vertices.
+		 */
+		int GetAtlasPage( Primitive& primitive ) const;
+
 		void WipeStateCache( sf::RenderTarget& target ) const;
 
 		std::vector<std::shared_ptr<Primitive>> m_primitives;
 		std::vector<std::unique_ptr<sf::Texture>> m_texture_atlas;
+		std::vector<sf::Image> m_atlas_images; // Copies of the atlas pages, only if asked for.
 
 		std::shared_ptr<RendererViewport> m_default_viewport;
 
+		std::unique_ptr<priv::WorkerPool> m_worker_pool; // Spreads rebuilding the vertex data over all cores.
+
 		int m_vertex_count;
 		int m_index_count;
 
 		mutable sf::Vector2i m_window_size;
 		mutable sf::Vector2i m_last_window_size;
+		mutable sf::IntRect m_damaged_area;
+		mutable FrameStatistics m_frame_statistics;
 		mutable bool m_force_redraw;
 
 	private:
 		virtual void DisplayImpl() const = 0;
 
-		std::deque<priv::RendererTextureNode> m_textures;
-		std::map<FontID, std::shared_ptr<PrimitiveTexture>> m_fonts;
+		priv::RendererPrimitiveSlot* GetPrimitiveSlot( const Primitive& primitive );
+		bool UnregisterPrimitive( Primitive& primitive );
+		std::shared_ptr<Primitive> CreatePrimitive();
+		void RecyclePrimitives();
+
+		priv::RendererGlyphTable& GetGlyphTable( const sf::Font& font, unsigned int size );
+		std::size_t GetGlyphIndex( priv::RendererGlyphTable& table, const sf::Font& font, sf::Uint32 codepoint, unsigned int size );
+		sf::Vector2i AllocateAtlasSpace( const sf::Vector2i& size, std::size_t& page_index );
+		void CopyGlyph( const sf::Texture& source, const sf::IntRect& source_rect, std::size_t page, const sf::Vector2i& position );
+		void FlushGlyphCopies();
+		void UpdateAtlas( std::size_t page, const sf::Image& image, const sf::Vector2i& position );
+		void ResizeAtlasPage( std::size_t page, const sf::Vector2u& size );
+		sf::FloatRect GetSourceBounds( const Primitive& primitive ) const;
+		sf::FloatRect GetWindowArea( const sf::FloatRect& bounds, const RendererViewport* viewport ) const;
+		void AddDamage( const sf::FloatRect& rect ) const;
+
+		std::unordered_map<std::uint64_t, priv::RendererTextureNode> m_textures;
+		std::unordered_map<std::uint64_t, std::uint64_t> m_texture_cache;
+		std::vector<priv::RendererAtlasPage> m_atlas_pages;
+		std::map<FontID, priv::RendererGlyphTable> m_fonts;
 		std::vector<std::pair<sf::Uint32, sf::Uint32>> m_character_sets;
+		std::vector<priv::RendererGlyphCopy> m_pending_glyph_copies;
+		bool m_keep_atlas_images;
 
 		std::shared_ptr<PrimitiveTexture> m_pseudo_texture;
 
+		std::map<PrimitiveKey, std::uint32_t> m_primitive_order;
+		std::vector<priv::RendererPrimitiveSlot> m_primitive_slots;
+		std::vector<std::uint32_t> m_free_primitive_slots;
+		std::vector<std::uint32_t> m_damaged_primitive_slots;
+		std::uint64_t m_primitive_sequence;
+
+		std::vector<std::shared_ptr<Primitive>> m_released_primitives;
+		std::vector<std::shared_ptr<Primitive>> m_primitive_pool;
+
+		mutable sf::FloatRect m_pending_damage;
+
+		mutable std::unordered_map<const void*, priv::RendererTargetState> m_target_states;
+		mutable const void* m_current_target;
+
 		bool m_primitives_sorted;
+
+		mutable std::vector<FrameStatistics> m_frame_statistics_history;
+		mutable std::size_t m_frame_statistics_history_position;
+		std::size_t m_frame_statistics_history_size;
+		mutable FrameStatistics m_last_frame_statistics;
 };
 
 }
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <SFGUI/Config.hpp>
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace sfg {
+namespace priv {
+
+struct SFGUI_API RendererAtlasPage {
+	std::vector<sf::IntRect> free_rects;
+	sf::Vector2i extent;
+	std::size_t allocated_area = 0;
+};
+
+}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <SFGUI/Config.hpp>
+
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+
+namespace sfg {
+namespace priv {
+
+struct SFGUI_API RendererBufferSlot {
+	sf::Vector2f position_transform;
+	std::size_t offset = 0;
+	std::size_t capacity = 0;
+	std::size_t vertex_count = 0;
+	std::size_t transform_index = 0;
+	std::size_t viewport_index = 0;
+	unsigned int sync_pass = 0;
+	int atlas_page = 0;
+};
+
+}
+}
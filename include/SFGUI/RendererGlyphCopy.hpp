@@ -0,0 +1,26 @@
+#pragma once
+
+#include <SFGUI/Config.hpp>
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+
+namespace sf {
+class Texture;
+}
+
+namespace sfg {
+namespace priv {
+
+/** Glyph waiting to be copied from SFML's font page into the atlas.
+ */
+struct SFGUI_API RendererGlyphCopy {
+	const sf::Texture* source = nullptr;
+	sf::IntRect source_rect;
+	std::size_t page = 0;
+	sf::Vector2i position;
+};
+
+}
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <SFGUI/Config.hpp>
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Config.hpp>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace sfg {
+namespace priv {
+
+struct SFGUI_API RendererGlyph {
+	sf::FloatRect bounds;
+	sf::Vector2f texture_offset;
+	sf::Vector2f texture_size;
+	float advance = 0.f;
+};
+
+struct SFGUI_API RendererGlyphTable {
+	std::vector<RendererGlyph> glyphs;
+	std::vector<std::uint32_t> direct_index; // Glyph index + 1 for low codepoints, 0 if not loaded.
+	std::unordered_map<sf::Uint32, std::uint32_t> indirect_index; // Glyph index + 1 for all other codepoints.
+	std::unordered_map<std::uint64_t, float> kerning; // ( first << 32 ) | second
+	float line_height = 0.f;
+	float space_advance = 0.f;
+};
+
+}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <SFGUI/Config.hpp>
+
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+
+namespace sfg {
+
+class Primitive;
+
+namespace priv {
+
+struct SFGUI_API RendererPrimitiveRange {
+	Primitive* primitive = nullptr;
+	sf::Vector2f position_transform;
+	std::size_t vertex_offset = 0;
+	std::size_t index_offset = 0;
+	int atlas_page = 0;
+	bool culled = false;
+};
+
+}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <SFGUI/Config.hpp>
+
+#include <SFML/Graphics/Rect.hpp>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace sfg {
+
+class Primitive;
+class RendererViewport;
+
+namespace priv {
+
+struct SFGUI_API RendererPrimitiveSlot {
+	std::shared_ptr<Primitive> primitive;
+	std::pair<std::uint64_t, std::uint64_t> key;
+	std::shared_ptr<RendererViewport> drawn_viewport; // Viewport it was last drawn in.
+	sf::FloatRect drawn_bounds; // Area covered when it was last drawn, in the viewport's source coordinates.
+	std::uint32_t generation = 1;
+	bool damaged = false; // Queued for CollectDamage().
+};
+
+}
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SFGUI/Config.hpp>
+
+#include <SFML/Graphics/Rect.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace sfg {
+namespace priv {
+
+/** Uniform grid of rectangles for finding the ones that reach into an area.
+ * Items are identified by the number they were inserted with. Rectangles
+ * that would cover too many cells are kept aside and tested one by one.
+ */
+class SFGUI_API RendererSpatialGrid {
+	public:
+		/** Ctor.
+		 * @param cell_size Width and height of a grid cell.
+		 */
+		explicit RendererSpatialGrid( float cell_size = 256.f );
+
+		/** Remove all items.
+		 */
+		void Clear();
+
+		/** Insert an item.
+		 * @param item Number identifying the item.
+		 * @param rect Area covered by the item.
+		 */
+		void Insert( std::size_t item, const sf::FloatRect& rect );
+
+		/** Find the items intersecting an area.
+		 * The items are appended in ascending order, each of them once.
+		 * @param rect Area to look in.
+		 * @param items Vector to append the items to.
+		 */
+		void Query( const sf::FloatRect& rect, std::vector<std::size_t>& items ) const;
+
+	private:
+		struct Entry {
+			std::size_t item;
+			sf::FloatRect rect;
+		};
+
+		sf::Vector2i GetCell( const sf::Vector2f& position ) const;
+
+		std::unordered_map<std::uint64_t, std::vector<std::size_t>> m_cells;
+		std::vector<Entry> m_entries;
+		std::vector<std::size_t> m_oversized_entries;
+		float m_cell_size;
+};
+
+}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <SFGUI/Config.hpp>
+
+namespace sfg {
+namespace priv {
+
+/** GL objects a renderer keeps separately for every render target.
+ * Frame buffers and vertex array objects can't be shared between contexts
+ * and the cached frame has the size of the target it was drawn for.
+ */
+struct SFGUI_API RendererTargetObjects {
+	unsigned int frame_buffer = 0;
+	unsigned int frame_buffer_texture = 0;
+	unsigned int display_list = 0;
+	unsigned int fbo_vbo = 0;
+	unsigned int fbo_vao = 0;
+	unsigned int vao = 0;
+};
+
+}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <SFGUI/Config.hpp>
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+
+namespace sfg {
+namespace priv {
+
+/** Renderer state parked while another render target is drawn to.
+ */
+struct SFGUI_API RendererTargetState {
+	sf::Vector2i last_window_size;
+	sf::FloatRect pending_damage;
+	bool force_redraw = false;
+};
+
+}
+}
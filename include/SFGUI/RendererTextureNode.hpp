@@ -3,6 +3,7 @@
 #include <SFGUI/Config.hpp>
 
 #include <SFML/System/Vector2.hpp>
+#include <cstdint>
 
 namespace sfg {
 namespace priv {
@@ -10,6 +11,10 @@ namespace priv {
 struct SFGUI_API RendererTextureNode {
 	sf::Vector2i offset;
 	sf::Vector2i size;
+	std::uint64_t hash = 0;
+	std::uint64_t check_hash = 0;
+	std::size_t references = 0;
+	bool cached = false;
 };
 
 }
@@ -47,6 +47,11 @@ class RendererViewport {
 		 */
 		const sf::Vector2f& GetSize() const;
 
+		/** Get the unique ID of this viewport.
+		 * @return Unique ID of this viewport.
+		 */
+		std::size_t GetId() const;
+
 		/** Equality operator.
 		 * @param other RendererViewport to compare with.
 		 * @return true if both RendererViewports represent the same viewport area.
@@ -6,3 +6,4 @@
 #include <SFGUI/Renderers/NonLegacyRenderer.hpp>
 #include <SFGUI/Renderers/VertexBufferRenderer.hpp>
 #include <SFGUI/Renderers/VertexArrayRenderer.hpp>
+#include <SFGUI/Renderers/SoftwareRenderer.hpp>
@@ -1,9 +1,14 @@
 #pragma once
 
 #include <SFGUI/Renderer.hpp>
+#include <SFGUI/RendererBufferSlot.hpp>
+#include <SFGUI/RendererSpatialGrid.hpp>
+#include <SFGUI/RendererTargetObjects.hpp>
 
 #include <SFML/Graphics/Shader.hpp>
 #include <SFML/System/Vector2.hpp>
+#include <SFML/Config.hpp>
+#include <unordered_map>
 
 namespace sf {
 class Color;
@@ -13,6 +18,7 @@ namespace sfg {
 
 namespace priv {
 struct RendererBatch;
+struct RendererShaderVertex;
 }
 
 /** SFGUI Vertex Buffer renderer.
@@ -61,6 +67,26 @@ class SFGUI_API NonLegacyRenderer : public Renderer {
 		 */
 		void TuneUseFBO( bool enable );
 
+		/** Enable or disable drawing from a texture array atlas.
+		 * Every atlas page becomes a layer of a single texture array,
+		 * so primitives from different pages no longer break batches.
+		 * Falls back to binding the atlas pages one by one if unsupported.
+		 * Enabled by default if supported.
+		 * @param enable true to enable, false to disable.
+		 */
+		void TuneUseTextureArray( bool enable );
+
+		/** Enable or disable streaming buffer updates.
+		 * Instead of updating the buffers in place, which can stall until
+		 * the GPU is done drawing from them, changes are written through
+		 * unsynchronized mappings into one of three buffer regions in turn.
+		 * Fences keep regions that are still in use from being overwritten.
+		 * Without fence support the buffers are orphaned on every update instead.
+		 * Disabled by default.
+		 * @param enable true to enable, false to disable.
+		 */
+		void TuneUseStreamingBuffers( bool enable );
+
 		const std::string& GetName() const override;
 
 	protected:
@@ -70,27 +96,89 @@ class SFGUI_API NonLegacyRenderer : public Renderer {
 
 		void InvalidateImpl( unsigned char datasets ) override;
 
+		void InvalidateAtlasImpl( std::size_t page, const sf::IntRect& rect ) override;
+
+		void SelectTargetImpl( const void* previous_target, const void* target ) const override;
+
+		void ForgetTargetImpl( const void* target, bool current ) override;
+
 	private:
 		void DisplayImpl() const override;
 
 		void InvalidateVBO( unsigned char datasets );
 
 		void RefreshVBO();
+		void RefreshViewportOffsets();
+		void RefreshCulling();
+		priv::RendererSpatialGrid& GetCullGrid( const std::shared_ptr<RendererViewport>& viewport );
+		std::size_t WriteDrawnIndices();
+
+		std::size_t GetViewportOffsetIndex( const std::shared_ptr<RendererViewport>& viewport );
+		void UpdateViewportOffsets();
+		void ReleaseViewportOffsets();
+
+		bool AllocateVertexSlot( priv::RendererBufferSlot& slot, std::size_t vertex_count );
+		void FreeVertexSlot( priv::RendererBufferSlot& slot );
+		void RepackVertexSlots();
+
+		void AllocateTransform( priv::RendererBufferSlot& slot );
+		void FreeTransform( priv::RendererBufferSlot& slot );
+		void WriteTransform( priv::RendererBufferSlot& slot, const sf::Vector2f& position_transform );
+
+		void WriteVertexSlot( Primitive& primitive, priv::RendererBufferSlot& slot );
+		void UploadVertexData();
+		void UploadIndexData( std::size_t first_changed_index );
+		void UploadTransformData();
+		bool UploadAtlasArray();
+
+		void StreamBufferData( std::size_t first_changed_index );
+		void WaitForStreamSegment( std::size_t segment );
+		void InsertStreamFence() const;
+		void DeleteStreamFences();
 
 		void SetupFBO( int width, int height );
 
 		void DestroyFBO();
 
 		void SetupVAO();
+		void SetupVertexAttributes( std::size_t first_vertex ) const;
 		void SetupFBOVAO();
 
-		std::vector<sf::Vector2f> m_vertex_data;
-		std::vector<sf::Color> m_color_data;
-		std::vector<sf::Vector2f> m_texture_data;
+		std::vector<priv::RendererShaderVertex> m_vertex_data;
 		std::vector<unsigned int> m_index_data;
+		std::vector<sf::Uint16> m_short_index_data;
+		std::vector<sf::Vector2f> m_transform_data;
+		std::vector<sf::Vector2f> m_viewport_offsets;
 
 		std::vector<priv::RendererBatch> m_batches;
 
+		// Primitives that end up in the index buffer, in draw order.
+		std::vector<Primitive*> m_drawn_primitives;
+
+		// Culling state of the last full refresh. Candidates are the visible
+		// primitives in draw order, the grids index the ones scrolled by the
+		// shader per viewport. The others don't change when a viewport scrolls.
+		std::vector<Primitive*> m_cull_candidates;
+		std::vector<std::size_t> m_unscrolled_candidates;
+		std::vector<std::size_t> m_visible_candidates;
+		std::vector<std::pair<std::shared_ptr<RendererViewport>, priv::RendererSpatialGrid>> m_cull_grids;
+		std::unordered_map<std::size_t, std::size_t> m_cull_grid_indices;
+
+		std::unordered_map<const Primitive*, priv::RendererBufferSlot> m_vertex_slots;
+		std::map<std::size_t, std::size_t> m_free_vertex_ranges;
+		std::vector<std::pair<std::size_t, std::size_t>> m_dirty_vertex_ranges;
+		std::vector<std::pair<Primitive*, priv::RendererBufferSlot*>> m_pending_slot_writes;
+		std::vector<sf::Vector2u> m_atlas_page_sizes;
+		std::vector<std::pair<std::size_t, sf::IntRect>> m_dirty_atlas_rects;
+		std::vector<std::size_t> m_free_transforms;
+		std::vector<std::size_t> m_dirty_transforms;
+		std::vector<std::shared_ptr<RendererViewport>> m_offset_viewports;
+		std::vector<unsigned int> m_offset_viewport_sync_passes;
+		std::unordered_map<std::size_t, std::size_t> m_viewport_offset_indices;
+		std::vector<std::vector<std::pair<std::size_t, std::size_t>>> m_stream_dirty_ranges;
+		std::vector<std::size_t> m_stream_first_changed_indices;
+		mutable std::vector<void*> m_stream_fences;
+
 		unsigned int m_frame_buffer = 0;
 		unsigned int m_frame_buffer_texture = 0;
 
@@ -103,30 +191,55 @@ class SFGUI_API NonLegacyRenderer : public Renderer {
 		unsigned int m_fbo_texture_coordinate_location = 0;
 
 		unsigned int m_vertex_vbo = 0;
-		unsigned int m_color_vbo = 0;
-		unsigned int m_texture_vbo = 0;
 		unsigned int m_index_vbo = 0;
 
+		unsigned int m_transform_texture = 0;
+		unsigned int m_atlas_array_texture = 0;
+
 		unsigned int m_vao = 0;
 
+		mutable std::unordered_map<const void*, priv::RendererTargetObjects> m_target_objects;
+
 		unsigned int m_shader = 0;
 		int m_viewport_parameters_location = 0;
 		int m_texture_location = 0;
+		int m_transform_texture_location = 0;
+		int m_atlas_array_location = 0;
+		int m_use_texture_array_location = 0;
+		int m_viewport_offsets_location = 0;
 		unsigned int m_vertex_location = 0;
 		unsigned int m_color_location = 0;
 		unsigned int m_texture_coordinate_location = 0;
+		unsigned int m_transform_index_location = 0;
+		unsigned int m_texture_layer_location = 0;
+		unsigned int m_viewport_index_location = 0;
 
 		sf::Vector2i m_previous_window_size;
+		sf::Vector2u m_atlas_array_size;
+
+		std::size_t m_vertex_capacity;
+		std::size_t m_vertex_vbo_capacity;
+		std::size_t m_index_vbo_capacity;
+		std::size_t m_transform_count;
+		std::size_t m_transform_texture_rows;
+		std::size_t m_atlas_array_layers;
+		std::size_t m_stream_segment;
 
-		int m_last_vertex_count;
 		int m_last_index_count;
 
+		unsigned int m_sync_pass;
+
 		unsigned char m_vbo_sync_type;
 
 		mutable bool m_vbo_synced;
 
 		bool m_cull;
+		bool m_cull_grids_valid;
+		bool m_viewport_offsets_exhausted;
 		bool m_use_fbo;
+		bool m_use_texture_array;
+		bool m_use_streaming_buffers;
+		bool m_use_short_indices;
 };
 
 }
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <SFGUI/Renderer.hpp>
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Config.hpp>
+
+namespace sf {
+class Color;
+class RenderTarget;
+}
+
+namespace sfg {
+
+class PrimitiveVertex;
+
+/** SFGUI Software renderer.
+ * Rasterizes the GUI on the CPU into an RGBA image. The output doesn't
+ * depend on the graphics driver, which makes it suitable for machines
+ * without a GPU and for comparing frames pixel by pixel. The atlas is
+ * sampled from copies of its pages kept in memory.
+ * Custom draw primitives (GL canvases) are not rasterized.
+ */
+class SFGUI_API SoftwareRenderer : public Renderer {
+	public:
+		typedef std::shared_ptr<SoftwareRenderer> Ptr;
+		typedef std::shared_ptr<const SoftwareRenderer> PtrConst;
+
+		/** Create SoftwareRenderer.
+		 * @return SoftwareRenderer.
+		 */
+		static Ptr Create();
+
+		/** Dtor.
+		 */
+		~SoftwareRenderer();
+
+		/** Rasterize the GUI to an sf::Window.
+		 * sf::Window can't be drawn to without OpenGL, the GUI is only rasterized.
+		 * Use GetImage() or GetPixels() to retrieve the result.
+		 * @param target sf::Window whose size to rasterize at.
+		 */
+		void Display( sf::Window& target ) const override;
+
+		/** Draw the GUI to an sf::RenderWindow.
+		 * @param target sf::RenderWindow to draw to.
+		 */
+		void Display( sf::RenderWindow& target ) const override;
+
+		/** Draw the GUI to an sf::RenderTexture.
+		 * @param target sf::RenderTexture to draw to.
+		 */
+		void Display( sf::RenderTexture& target ) const override;
+
+		/** Rasterize the GUI without drawing it anywhere.
+		 * @param size Size of the image to rasterize into.
+		 */
+		void Rasterize( const sf::Vector2u& size ) const;
+
+		/** Get the image the GUI was last rasterized into.
+		 * @return Copy of the image, with premultiplied alpha.
+		 */
+		sf::Image GetImage() const;
+
+		/** Get the pixels the GUI was last rasterized into.
+		 * @return Rows of RGBA pixels with premultiplied alpha, top to bottom, GetWindowSize().x * GetWindowSize().y * 4 bytes in total.
+		 */
+		const sf::Uint8* GetPixels() const;
+
+		const std::string& GetName() const override;
+
+	protected:
+		/** Ctor.
+		 */
+		SoftwareRenderer();
+
+		void InvalidateImpl( unsigned char datasets ) override;
+
+		void SelectTargetImpl( const void* previous_target, const void* target ) const override;
+
+		void ForgetTargetImpl( const void* target, bool current ) override;
+
+	private:
+		void DisplayImpl() const override;
+
+		void Refresh();
+
+		void RasterizePrimitive( Primitive& primitive ) const;
+
+		bool RasterizeQuad( const PrimitiveVertex* const* vertices, const sf::Vector2f& offset, const sf::IntRect& clip_rect ) const;
+
+		void RasterizeTriangle( const PrimitiveVertex* const* vertices, const sf::Vector2f& offset, const sf::IntRect& clip_rect ) const;
+
+		void FillSpan( int x, int y, int length, const sf::Color& color ) const;
+
+		void BlendPixel( int x, int y, const sf::Color& color ) const;
+
+		sf::Color SampleAtlas( std::size_t page, float u, float v ) const;
+
+		void Present( sf::RenderTarget& target ) const;
+
+		mutable std::vector<sf::Uint32> m_pixels;
+
+		mutable std::unique_ptr<sf::Texture> m_texture;
+
+		// Pixels and texture of the render targets not drawn to at the moment.
+		mutable std::unordered_map<const void*, std::pair<std::vector<sf::Uint32>, std::unique_ptr<sf::Texture>>> m_target_images;
+
+		mutable bool m_dirty;
+};
+
+}
@@ -12,6 +12,7 @@ namespace sfg {
 
 namespace priv {
 struct RendererBatch;
+struct RendererPrimitiveRange;
 }
 
 /** SFGUI Vertex Array renderer.
@@ -60,17 +61,22 @@ class SFGUI_API VertexArrayRenderer : public Renderer {
 
 		void InvalidateImpl( unsigned char datasets ) override;
 
+		void SelectTargetImpl( const void* previous_target, const void* target ) const override;
+
 	private:
 		void DisplayImpl() const override;
 
 		void RefreshArray();
 
+		void FillPrimitive( const priv::RendererPrimitiveRange& range );
+
 		std::vector<sf::Vector2f> m_vertex_data;
 		std::vector<sf::Color> m_color_data;
 		std::vector<sf::Vector2f> m_texture_data;
 		std::vector<int> m_index_data;
 
 		std::vector<priv::RendererBatch> m_batches;
+		std::vector<priv::RendererPrimitiveRange> m_primitive_ranges;
 
 		int m_last_vertex_count;
 		int m_last_index_count;
@@ -1,8 +1,10 @@
 #pragma once
 
 #include <SFGUI/Renderer.hpp>
+#include <SFGUI/RendererTargetObjects.hpp>
 
 #include <SFML/System/Vector2.hpp>
+#include <SFML/Config.hpp>
 
 namespace sf {
 class Color;
@@ -12,6 +14,8 @@ namespace sfg {
 
 namespace priv {
 struct RendererBatch;
+struct RendererPrimitiveRange;
+struct RendererVertex;
 }
 
 /** SFGUI Vertex Buffer renderer.
@@ -74,32 +78,39 @@ class SFGUI_API VertexBufferRenderer : public Renderer {
 
 		void InvalidateImpl( unsigned char datasets ) override;
 
+		void SelectTargetImpl( const void* previous_target, const void* target ) const override;
+
+		void ForgetTargetImpl( const void* target, bool current ) override;
+
 	private:
 		void DisplayImpl() const override;
 
 		void InvalidateVBO( unsigned char datasets );
 
 		void RefreshVBO();
+		void RefreshColors();
+
+		void FillPrimitive( const priv::RendererPrimitiveRange& range );
 
 		void SetupFBO( int width, int height );
 
 		void DestroyFBO();
 
-		std::vector<sf::Vector2f> m_vertex_data;
-		std::vector<sf::Color> m_color_data;
-		std::vector<sf::Vector2f> m_texture_data;
+		std::vector<priv::RendererVertex> m_vertex_data;
 		std::vector<unsigned int> m_index_data;
+		std::vector<sf::Uint16> m_short_index_data;
 
 		std::vector<priv::RendererBatch> m_batches;
+		std::vector<priv::RendererPrimitiveRange> m_primitive_ranges;
 
 		unsigned int m_frame_buffer;
 		unsigned int m_frame_buffer_texture;
 
 		unsigned int m_display_list;
 
+		mutable std::unordered_map<const void*, priv::RendererTargetObjects> m_target_objects;
+
 		unsigned int m_vertex_vbo;
-		unsigned int m_color_vbo;
-		unsigned int m_texture_vbo;
 		unsigned int m_index_vbo;
 
 		int m_last_vertex_count;
@@ -113,6 +124,7 @@ class SFGUI_API VertexBufferRenderer : public Renderer {
 
 		bool m_cull;
 		bool m_use_fbo;
+		bool m_use_short_indices;
 
 		bool m_vbo_supported;
 		bool m_fbo_supported;
@@ -94,7 +94,10 @@ class SFGUI_API Widget : public Object, public std::enable_shared_from_this<Widg
 
 		/** Request a resize at the parent widget.
 		 * When a widget's requisition changes, it requests a resize at the parent
-		 * to actually get more space (if possible).
+		 * to actually get more space (if possible). The widget and its ancestors
+		 * are only marked for layout here, the new requisitions and allocations
+		 * are calculated by the next FlushLayout(), which Desktop::Update() and
+		 * Update() of root widgets call once per frame.
 		 */
 		void RequestResize();
 
@@ -104,6 +107,8 @@ class SFGUI_API Widget : public Object, public std::enable_shared_from_this<Widg
 		const sf::FloatRect& GetAllocation() const;
 
 		/** Get requisition (minimum size the widget is asking for).
+		 * If a resize was requested since the requisition was last calculated,
+		 * it is recalculated first.
 		 * @return Requisition.
 		 */
 		const sf::Vector2f& GetRequisition() const;
@@ -236,6 +241,13 @@ class SFGUI_API Widget : public Object, public std::enable_shared_from_this<Widg
 		 */
 		static void RefreshAll();
 
+		/** Lay out all widgets that requested a resize.
+		 * Every marked widget's requisition is calculated once, starting at the
+		 * root widgets, and root widgets are grown to fit their requisition.
+		 * Call this if you need allocations right after modifying widgets.
+		 */
+		static void FlushLayout();
+
 		/** Set hierarchy level of this widget.
 		 * @param level New hierarchy level of this widget.
 		 */
@@ -382,8 +394,8 @@ class SFGUI_API Widget : public Object, public std::enable_shared_from_this<Widg
 		virtual void HandleRequisitionChange();
 
 		/** Handle state changes.
-		 * The default behaviour is to accept any state change and invalidate the
-		 * widget.
+		 * The default behaviour is to accept any state change and update the
+		 * drawable in place if the engine allows it, invalidate the widget otherwise.
 		 * @param old_state Old state.
 		 */
 		virtual void HandleStateChange( State old_state );
@@ -464,6 +476,12 @@ class SFGUI_API Widget : public Object, public std::enable_shared_from_this<Widg
 
 		static const std::vector<Widget*>& GetRootWidgets();
 
+		/** Calculate the requisition of a widget marked for layout.
+		 * Children are calculated on demand when the widget asks for their
+		 * requisition. Root widgets are also allocated their requisition.
+		 */
+		void UpdateRequisition();
+
 		sf::FloatRect m_allocation;
 		sf::Vector2f m_requisition;
 		std::unique_ptr<sf::Vector2f> m_custom_requisition;
@@ -482,6 +500,9 @@ class SFGUI_API Widget : public Object, public std::enable_shared_from_this<Widg
 		mutable bool m_invalidated;
 		mutable bool m_parent_notified;
 
+		bool m_layout_pending;
+		bool m_layout_queued; // Only FlushLayout() dequeues widgets.
+
 		State m_state;
 		unsigned char m_mouse_button_down : 6; // 64 buttons, might not be enough for some people
 		bool m_mouse_in : 1;
@@ -10,6 +10,9 @@ namespace sfg {
 void Desktop::Update( float seconds ) {
 	Context::Activate( m_context );
 
+	// Resolve all resize requests made since the last update in one pass.
+	Widget::FlushLayout();
+
 	std::reverse_iterator<WidgetsList::iterator> iter( std::end( m_children ) );
 	std::reverse_iterator<WidgetsList::iterator> finish( std::begin( m_children ) );
 
@@ -232,8 +235,8 @@ void Desktop::RecalculateWidgetLevels() {
 	std::reverse_iterator<WidgetsList::iterator> finish( std::begin( m_children ) );
 
 	for( ; iter != finish; ++iter ) {
+		// Only reorders the primitives of the existing drawables.
 		(*iter)->SetHierarchyLevel( current_level );
-		(*iter)->Invalidate();
 		current_level += std::numeric_limits<int>::max() / static_cast<int>( children_size );
 	}
 }
@@ -1,4 +1,5 @@
 #include <SFGUI/Engines/BREW.hpp>
+#include <SFGUI/Context.hpp>
 #include <SFGUI/Renderer.hpp>
 #include <SFGUI/Button.hpp>
 #include <SFGUI/RenderQueue.hpp>
@@ -88,8 +89,80 @@ std::unique_ptr<RenderQueue> BREW::CreateButtonDrawable( std::shared_ptr<const B
 		queue->Add( Renderer::Get().CreateText( text ) );
 	}
 
+	// Hovering only changes colors. Pressing the button moves the label
+	// and flips the border shading, that needs a new drawable. So does
+	// a theme that assigns the states different geometry properties.
+	std::weak_ptr<const Button> weak_button( button );
+	auto drawn_state = button->GetState();
+	auto padding = GetProperty<float>( "Padding", button );
+
+	queue->SetStateUpdater( [weak_button, drawn_state, border_width, spacing, font_name, font_size, padding]( RenderQueue& drawable ) mutable {
+		auto locked_button = weak_button.lock();
+
+		if( !locked_button ) {
+			return false;
+		}
+
+		auto state = locked_button->GetState();
+
+		if( ( state == Button::State::ACTIVE ) || ( drawn_state == Button::State::ACTIVE ) ) {
+			return false;
+		}
+
+		// The drawable can outlive the engine that created it,
+		// ask the context for the engine in use now.
+		auto engine = dynamic_cast<const BREW*>( &Context::Get().GetEngine() );
+
+		if( !engine ) {
+			return false;
+		}
+
+		if(
+			( engine->GetProperty<float>( "BorderWidth", locked_button ) != border_width ) ||
+			( engine->GetProperty<float>( "Spacing", locked_button ) != spacing ) ||
+			( engine->GetProperty<std::string>( "FontName", locked_button ) != font_name ) ||
+			( engine->GetProperty<unsigned int>( "FontSize", locked_button ) != font_size ) ||
+			( engine->GetProperty<float>( "Padding", locked_button ) != padding )
+		) {
+			return false;
+		}
+
+		if( !engine->UpdateButtonDrawable( locked_button, drawable ) ) {
+			return false;
+		}
+
+		drawn_state = state;
+
+		return true;
+	} );
+
 	return queue;
 }
 
+bool BREW::UpdateButtonDrawable( std::shared_ptr<const Button> button, RenderQueue& queue ) const {
+	const auto& primitives = queue.GetPrimitives();
+	const auto has_label = ( button->GetLabel().getSize() > 0 );
+
+	// The pane, followed by the label if there is one.
+	if( primitives.size() != ( has_label ? 2u : 1u ) ) {
+		return false;
+	}
+
+	auto border_color = GetProperty<sf::Color>( "BorderColor", button );
+	auto border_color_shift = GetProperty<int>( "BorderColorShift", button );
+	auto background_color = GetProperty<sf::Color>( "BackgroundColor", button );
+	auto color = GetProperty<sf::Color>( "Color", button );
+
+	if( !Renderer::Get().RecolorPane( *primitives[0], background_color, border_color, border_color_shift ) ) {
+		return false;
+	}
+
+	if( has_label ) {
+		Renderer::Get().RecolorPrimitive( *primitives[1], color );
+	}
+
+	return true;
+}
+
 }
 }
@@ -3,7 +3,7 @@
 #include <SFGUI/Label.hpp>
 #include <SFGUI/RenderQueue.hpp>
 
-#include <SFML/Graphics/Text.hpp>
+#include <SFML/System/String.hpp>
 
 namespace sfg {
 namespace eng {
@@ -16,18 +16,20 @@ std::unique_ptr<RenderQueue> BREW::CreateLabelDrawable( std::shared_ptr<const La
 
 	std::unique_ptr<RenderQueue> queue( new RenderQueue );
 
-	sf::Text vis_label( label->GetWrappedText(), *font, font_size );
-	vis_label.setFillColor( font_color );
+	Renderer::TextStyle style;
+	style.font = font.get();
+	style.character_size = font_size;
+	style.color = font_color;
+
+	sf::Vector2f position;
 
 	if( !label->GetLineWrap() ) {
 		// Calculate alignment when word wrap is disabled.
 		sf::Vector2f avail_space( label->GetAllocation().width - label->GetRequisition().x, label->GetAllocation().height - label->GetRequisition().y );
-		sf::Vector2f position( avail_space.x * label->GetAlignment().x, avail_space.y * label->GetAlignment().y );
-
-		vis_label.setPosition( position.x, position.y );
+		position = sf::Vector2f( avail_space.x * label->GetAlignment().x, avail_space.y * label->GetAlignment().y );
 	}
 
-	queue->Add( Renderer::Get().CreateText( vis_label ) );
+	queue->Add( Renderer::Get().CreateText( label->GetWrappedText(), position, style ) );
 
 	return queue;
 }
@@ -40,7 +40,7 @@ std::unique_ptr<RenderQueue> BREW::CreateListBoxDrawable( std::shared_ptr<const
     for( ListBox::IndexType i = listbox->GetFirstDisplayedItemIndex();
         i < std::min(listbox->GetFirstDisplayedItemIndex() + listbox->GetMaxDisplayedItemsCount(), listbox->GetItemsCount());
         ++i ) {
-        auto& itemText = listbox->GetDisplayedItemText( i );
+        auto itemText = listbox->GetDisplayedItemText( i );
 
         auto metrics = GetTextStringMetrics( itemText, *font, font_size );
 		metrics.y = GetFontLineHeight( *font, font_size ); // Text only size
@@ -82,8 +82,11 @@ std::unique_ptr<RenderQueue> BREW::CreateListBoxDrawable( std::shared_ptr<const
             );
         }
 
-        if( listbox->GetImagesSize() != sf::Vector2f() && listbox->GetItemImage( i ).getSize() != sf::Vector2u() ) {
-            auto texture = Renderer::Get().LoadTexture( listbox->GetItemImage( i ) );
+        // GetItemImage() returns a copy, only ask for it once.
+        auto image = ( listbox->GetImagesSize() != sf::Vector2f() ) ? listbox->GetItemImage( i ) : sf::Image();
+
+        if( image.getSize() != sf::Vector2u() ) {
+            auto texture = Renderer::Get().LoadTexture( image );
             queue->Add(
         		Renderer::Get().CreateSprite(
         			sf::FloatRect(
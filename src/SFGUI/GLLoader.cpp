@@ -68,6 +68,10 @@ int sfgogl_ext_ARB_vertex_array_object = sfgogl_LOAD_FAILED;
 int sfgogl_ext_ARB_geometry_shader4 = sfgogl_LOAD_FAILED;
 int sfgogl_ext_ARB_explicit_attrib_location = sfgogl_LOAD_FAILED;
 int sfgogl_ext_ARB_explicit_uniform_location = sfgogl_LOAD_FAILED;
+int sfgogl_ext_ARB_texture_rg = sfgogl_LOAD_FAILED;
+int sfgogl_ext_EXT_texture_array = sfgogl_LOAD_FAILED;
+int sfgogl_ext_ARB_map_buffer_range = sfgogl_LOAD_FAILED;
+int sfgogl_ext_ARB_sync = sfgogl_LOAD_FAILED;
 
 void (CODEGEN_FUNCPTR *sfg_ptrc_glActiveTextureARB)(GLenum) = NULL;
 void (CODEGEN_FUNCPTR *sfg_ptrc_glClientActiveTextureARB)(GLenum) = NULL;
@@ -722,6 +726,57 @@ static int Load_ARB_geometry_shader4(void)
 	return numFailed;
 }
 
+void (CODEGEN_FUNCPTR *sfg_ptrc_glFramebufferTextureLayerEXT)(GLenum, GLenum, GLuint, GLint, GLint) = NULL;
+
+static int Load_EXT_texture_array(void)
+{
+	int numFailed = 0;
+	sfg_ptrc_glFramebufferTextureLayerEXT = (void (CODEGEN_FUNCPTR *)(GLenum, GLenum, GLuint, GLint, GLint))IntGetProcAddress("glFramebufferTextureLayerEXT");
+	if(!sfg_ptrc_glFramebufferTextureLayerEXT) numFailed++;
+	return numFailed;
+}
+
+void (CODEGEN_FUNCPTR *sfg_ptrc_glFlushMappedBufferRange)(GLenum, GLintptr, GLsizeiptr) = NULL;
+void * (CODEGEN_FUNCPTR *sfg_ptrc_glMapBufferRange)(GLenum, GLintptr, GLsizeiptr, GLbitfield) = NULL;
+
+static int Load_ARB_map_buffer_range(void)
+{
+	int numFailed = 0;
+	sfg_ptrc_glFlushMappedBufferRange = (void (CODEGEN_FUNCPTR *)(GLenum, GLintptr, GLsizeiptr))IntGetProcAddress("glFlushMappedBufferRange");
+	if(!sfg_ptrc_glFlushMappedBufferRange) numFailed++;
+	sfg_ptrc_glMapBufferRange = (void * (CODEGEN_FUNCPTR *)(GLenum, GLintptr, GLsizeiptr, GLbitfield))IntGetProcAddress("glMapBufferRange");
+	if(!sfg_ptrc_glMapBufferRange) numFailed++;
+	return numFailed;
+}
+
+GLenum (CODEGEN_FUNCPTR *sfg_ptrc_glClientWaitSync)(GLsync, GLbitfield, GLuint64) = NULL;
+void (CODEGEN_FUNCPTR *sfg_ptrc_glDeleteSync)(GLsync) = NULL;
+GLsync (CODEGEN_FUNCPTR *sfg_ptrc_glFenceSync)(GLenum, GLbitfield) = NULL;
+void (CODEGEN_FUNCPTR *sfg_ptrc_glGetInteger64v)(GLenum, GLint64 *) = NULL;
+void (CODEGEN_FUNCPTR *sfg_ptrc_glGetSynciv)(GLsync, GLenum, GLsizei, GLsizei *, GLint *) = NULL;
+GLboolean (CODEGEN_FUNCPTR *sfg_ptrc_glIsSync)(GLsync) = NULL;
+void (CODEGEN_FUNCPTR *sfg_ptrc_glWaitSync)(GLsync, GLbitfield, GLuint64) = NULL;
+
+static int Load_ARB_sync(void)
+{
+	int numFailed = 0;
+	sfg_ptrc_glClientWaitSync = (GLenum (CODEGEN_FUNCPTR *)(GLsync, GLbitfield, GLuint64))IntGetProcAddress("glClientWaitSync");
+	if(!sfg_ptrc_glClientWaitSync) numFailed++;
+	sfg_ptrc_glDeleteSync = (void (CODEGEN_FUNCPTR *)(GLsync))IntGetProcAddress("glDeleteSync");
+	if(!sfg_ptrc_glDeleteSync) numFailed++;
+	sfg_ptrc_glFenceSync = (GLsync (CODEGEN_FUNCPTR *)(GLenum, GLbitfield))IntGetProcAddress("glFenceSync");
+	if(!sfg_ptrc_glFenceSync) numFailed++;
+	sfg_ptrc_glGetInteger64v = (void (CODEGEN_FUNCPTR *)(GLenum, GLint64 *))IntGetProcAddress("glGetInteger64v");
+	if(!sfg_ptrc_glGetInteger64v) numFailed++;
+	sfg_ptrc_glGetSynciv = (void (CODEGEN_FUNCPTR *)(GLsync, GLenum, GLsizei, GLsizei *, GLint *))IntGetProcAddress("glGetSynciv");
+	if(!sfg_ptrc_glGetSynciv) numFailed++;
+	sfg_ptrc_glIsSync = (GLboolean (CODEGEN_FUNCPTR *)(GLsync))IntGetProcAddress("glIsSync");
+	if(!sfg_ptrc_glIsSync) numFailed++;
+	sfg_ptrc_glWaitSync = (void (CODEGEN_FUNCPTR *)(GLsync, GLbitfield, GLuint64))IntGetProcAddress("glWaitSync");
+	if(!sfg_ptrc_glWaitSync) numFailed++;
+	return numFailed;
+}
+
 void (CODEGEN_FUNCPTR *sfg_ptrc_glAccum)(GLenum, GLfloat) = NULL;
 void (CODEGEN_FUNCPTR *sfg_ptrc_glAlphaFunc)(GLenum, GLfloat) = NULL;
 void (CODEGEN_FUNCPTR *sfg_ptrc_glBegin)(GLenum) = NULL;
@@ -1765,7 +1820,7 @@ typedef struct sfgogl_StrToExtMap_s
 	PFN_LOADFUNCPOINTERS LoadExtension;
 } sfgogl_StrToExtMap;
 
-static sfgogl_StrToExtMap ExtensionMap[19] = {
+static sfgogl_StrToExtMap ExtensionMap[23] = {
 	{"GL_SGIS_texture_edge_clamp", &sfgogl_ext_SGIS_texture_edge_clamp, NULL},
 	{"GL_ARB_multitexture", &sfgogl_ext_ARB_multitexture, Load_ARB_multitexture},
 	{"GL_EXT_blend_minmax", &sfgogl_ext_EXT_blend_minmax, Load_EXT_blend_minmax},
@@ -1784,10 +1839,14 @@ static sfgogl_StrToExtMap ExtensionMap[19] = {
 	{"GL_ARB_vertex_array_object", &sfgogl_ext_ARB_vertex_array_object, Load_ARB_vertex_array_object},
 	{"GL_ARB_geometry_shader4", &sfgogl_ext_ARB_geometry_shader4, Load_ARB_geometry_shader4},
 	{"GL_ARB_explicit_attrib_location", &sfgogl_ext_ARB_explicit_attrib_location, NULL},
-	{"GL_ARB_explicit_uniform_location", &sfgogl_ext_ARB_explicit_uniform_location, NULL}
+	{"GL_ARB_explicit_uniform_location", &sfgogl_ext_ARB_explicit_uniform_location, NULL},
+	{"GL_ARB_texture_rg", &sfgogl_ext_ARB_texture_rg, NULL},
+	{"GL_EXT_texture_array", &sfgogl_ext_EXT_texture_array, Load_EXT_texture_array},
+	{"GL_ARB_map_buffer_range", &sfgogl_ext_ARB_map_buffer_range, Load_ARB_map_buffer_range},
+	{"GL_ARB_sync", &sfgogl_ext_ARB_sync, Load_ARB_sync}
 };
 
-static int g_extensionMapSize = 19;
+static int g_extensionMapSize = 23;
 
 static sfgogl_StrToExtMap *FindExtEntry(const char *extensionName)
 {
@@ -1823,6 +1882,10 @@ static void ClearExtensionVars(void)
 	sfgogl_ext_ARB_geometry_shader4 = sfgogl_LOAD_FAILED;
 	sfgogl_ext_ARB_explicit_attrib_location = sfgogl_LOAD_FAILED;
 	sfgogl_ext_ARB_explicit_uniform_location = sfgogl_LOAD_FAILED;
+	sfgogl_ext_ARB_texture_rg = sfgogl_LOAD_FAILED;
+	sfgogl_ext_EXT_texture_array = sfgogl_LOAD_FAILED;
+	sfgogl_ext_ARB_map_buffer_range = sfgogl_LOAD_FAILED;
+	sfgogl_ext_ARB_sync = sfgogl_LOAD_FAILED;
 }
 
 
@@ -173,6 +173,10 @@ extern int sfgogl_ext_ARB_vertex_array_object;
 extern int sfgogl_ext_ARB_geometry_shader4;
 extern int sfgogl_ext_ARB_explicit_attrib_location;
 extern int sfgogl_ext_ARB_explicit_uniform_location;
+extern int sfgogl_ext_ARB_texture_rg;
+extern int sfgogl_ext_EXT_texture_array;
+extern int sfgogl_ext_ARB_map_buffer_range;
+extern int sfgogl_ext_ARB_sync;
 
 #define GL_CLAMP_TO_EDGE_SGIS 0x812F
 
@@ -545,6 +549,62 @@ extern int sfgogl_ext_ARB_explicit_uniform_location;
 
 #define GL_MAX_UNIFORM_LOCATIONS 0x826E
 
+#define GL_R16 0x822A
+#define GL_R16F 0x822D
+#define GL_R16I 0x8233
+#define GL_R16UI 0x8234
+#define GL_R32F 0x822E
+#define GL_R32I 0x8235
+#define GL_R32UI 0x8236
+#define GL_R8 0x8229
+#define GL_R8I 0x8231
+#define GL_R8UI 0x8232
+#define GL_RG 0x8227
+#define GL_RG16 0x822C
+#define GL_RG16F 0x822F
+#define GL_RG16I 0x8239
+#define GL_RG16UI 0x823A
+#define GL_RG32F 0x8230
+#define GL_RG32I 0x823B
+#define GL_RG32UI 0x823C
+#define GL_RG8 0x822B
+#define GL_RG8I 0x8237
+#define GL_RG8UI 0x8238
+#define GL_RG_INTEGER 0x8228
+
+#define GL_COMPARE_REF_DEPTH_TO_TEXTURE_EXT 0x884E
+#define GL_FRAMEBUFFER_ATTACHMENT_TEXTURE_LAYER_EXT 0x8CD4
+#define GL_MAX_ARRAY_TEXTURE_LAYERS_EXT 0x88FF
+#define GL_PROXY_TEXTURE_1D_ARRAY_EXT 0x8C19
+#define GL_PROXY_TEXTURE_2D_ARRAY_EXT 0x8C1B
+#define GL_TEXTURE_1D_ARRAY_EXT 0x8C18
+#define GL_TEXTURE_2D_ARRAY_EXT 0x8C1A
+#define GL_TEXTURE_BINDING_1D_ARRAY_EXT 0x8C1C
+#define GL_TEXTURE_BINDING_2D_ARRAY_EXT 0x8C1D
+
+#define GL_MAP_FLUSH_EXPLICIT_BIT 0x0010
+#define GL_MAP_INVALIDATE_BUFFER_BIT 0x0008
+#define GL_MAP_INVALIDATE_RANGE_BIT 0x0004
+#define GL_MAP_READ_BIT 0x0001
+#define GL_MAP_UNSYNCHRONIZED_BIT 0x0020
+#define GL_MAP_WRITE_BIT 0x0002
+
+#define GL_ALREADY_SIGNALED 0x911A
+#define GL_CONDITION_SATISFIED 0x911C
+#define GL_MAX_SERVER_WAIT_TIMEOUT 0x9111
+#define GL_OBJECT_TYPE 0x9112
+#define GL_SIGNALED 0x9119
+#define GL_SYNC_CONDITION 0x9113
+#define GL_SYNC_FENCE 0x9116
+#define GL_SYNC_FLAGS 0x9115
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#define GL_SYNC_STATUS 0x9114
+#define GL_TIMEOUT_EXPIRED 0x911B
+#define GL_TIMEOUT_IGNORED 0xFFFFFFFFFFFFFFFF
+#define GL_UNSIGNALED 0x9118
+#define GL_WAIT_FAILED 0x911D
+
 #define GL_2D 0x0600
 #define GL_2_BYTES 0x1407
 #define GL_3D 0x0601
@@ -1561,6 +1621,39 @@ extern void (CODEGEN_FUNCPTR *sfg_ptrc_glProgramParameteriARB)(GLuint, GLenum, G
 #define glProgramParameteriARB sfg_ptrc_glProgramParameteriARB
 #endif /*GL_ARB_geometry_shader4*/
 
+
+#ifndef GL_EXT_texture_array
+#define GL_EXT_texture_array 1
+extern void (CODEGEN_FUNCPTR *sfg_ptrc_glFramebufferTextureLayerEXT)(GLenum, GLenum, GLuint, GLint, GLint);
+#define glFramebufferTextureLayerEXT sfg_ptrc_glFramebufferTextureLayerEXT
+#endif /*GL_EXT_texture_array*/
+
+#ifndef GL_ARB_map_buffer_range
+#define GL_ARB_map_buffer_range 1
+extern void (CODEGEN_FUNCPTR *sfg_ptrc_glFlushMappedBufferRange)(GLenum, GLintptr, GLsizeiptr);
+#define glFlushMappedBufferRange sfg_ptrc_glFlushMappedBufferRange
+extern void * (CODEGEN_FUNCPTR *sfg_ptrc_glMapBufferRange)(GLenum, GLintptr, GLsizeiptr, GLbitfield);
+#define glMapBufferRange sfg_ptrc_glMapBufferRange
+#endif /*GL_ARB_map_buffer_range*/
+
+#ifndef GL_ARB_sync
+#define GL_ARB_sync 1
+extern GLenum (CODEGEN_FUNCPTR *sfg_ptrc_glClientWaitSync)(GLsync, GLbitfield, GLuint64);
+#define glClientWaitSync sfg_ptrc_glClientWaitSync
+extern void (CODEGEN_FUNCPTR *sfg_ptrc_glDeleteSync)(GLsync);
+#define glDeleteSync sfg_ptrc_glDeleteSync
+extern GLsync (CODEGEN_FUNCPTR *sfg_ptrc_glFenceSync)(GLenum, GLbitfield);
+#define glFenceSync sfg_ptrc_glFenceSync
+extern void (CODEGEN_FUNCPTR *sfg_ptrc_glGetInteger64v)(GLenum, GLint64 *);
+#define glGetInteger64v sfg_ptrc_glGetInteger64v
+extern void (CODEGEN_FUNCPTR *sfg_ptrc_glGetSynciv)(GLsync, GLenum, GLsizei, GLsizei *, GLint *);
+#define glGetSynciv sfg_ptrc_glGetSynciv
+extern GLboolean (CODEGEN_FUNCPTR *sfg_ptrc_glIsSync)(GLsync);
+#define glIsSync sfg_ptrc_glIsSync
+extern void (CODEGEN_FUNCPTR *sfg_ptrc_glWaitSync)(GLsync, GLbitfield, GLuint64);
+#define glWaitSync sfg_ptrc_glWaitSync
+#endif /*GL_ARB_sync*/
+
 extern void (CODEGEN_FUNCPTR *sfg_ptrc_glAccum)(GLenum, GLfloat);
 #define glAccum sfg_ptrc_glAccum
 extern void (CODEGEN_FUNCPTR *sfg_ptrc_glAlphaFunc)(GLenum, GLfloat);
@@ -25,10 +25,14 @@ void Image::SetImage( const sf::Image& image ) {
 		return;
 	}
 
-	if( m_image.getSize() == image.getSize() ) {
+	auto texture = m_texture.lock();
+
+	// Identical images share their atlas texture. Only update it in place
+	// if no other handle refers to it, or they would change too.
+	if( texture && ( m_image.getSize() == image.getSize() ) && !Renderer::Get().IsImageShared( texture->offset ) ) {
 		m_image = image;
 
-		sfg::Renderer::Get().UpdateImage( m_texture_offset, image );
+		texture->Update( image );
 	}
 	else {
 		m_image = image;
@@ -45,7 +49,7 @@ const sf::Image& Image::GetImage() const {
 std::unique_ptr<RenderQueue> Image::InvalidateImpl() const {
 	std::unique_ptr<RenderQueue> queue = Context::Get().GetEngine().CreateImageDrawable( std::dynamic_pointer_cast<const Image>( shared_from_this() ) );
 
-	m_texture_offset = queue->GetPrimitives()[0]->GetTextures()[0]->offset;
+	m_texture = queue->GetPrimitives()[0]->GetTextures()[0];
 
 	return queue;
 }
@@ -25,6 +25,15 @@ ListBox::Ptr ListBox::Create(  ) {
 ListBox::ListBox() :
 	Container(),
 	m_items(),
+	m_item_widths(),
+	m_item_width_counts(),
+	m_unmeasured_items_count(0),
+	m_measured_font(),
+	m_measured_font_size(0),
+	m_item_fetcher(),
+	m_model_items_count(0),
+	m_fetched_items(),
+	m_fetched_items_first(0),
 	m_selection_mode(SelectionMode::DEFAULT),
 	m_selected_items(),
 	m_highlighted_item(NONE),
@@ -52,10 +61,19 @@ sf::Vector2f ListBox::CalculateRequisition() {
 	auto font_size = Context::Get().GetEngine().GetProperty<unsigned int>( "FontSize", shared_from_this() );
 	auto dots_width = Context::Get().GetEngine().GetTextStringMetrics("...", *font, font_size).x;
 
-	// Calculate the max width of items
 	float items_max_width = 0.f;
-	for( const Item& item : m_items ) {
-		items_max_width = std::max(items_max_width, Context::Get().GetEngine().GetTextStringMetrics(item.text, *font, font_size).x);
+
+	if( m_item_fetcher ) {
+		// Only the fetched items of a model are known.
+		for( const auto& item : m_fetched_items ) {
+			items_max_width = std::max( items_max_width, Context::Get().GetEngine().GetTextStringMetrics( item.text, *font, font_size ).x );
+		}
+	}
+	else {
+		// Only items added or changed since the last time need to be measured.
+		MeasureItems( font, font_size );
+
+		items_max_width = m_item_width_counts.empty() ? 0.f : m_item_width_counts.rbegin()->first;
 	}
 
 	return sf::Vector2f(
@@ -73,7 +91,13 @@ const std::string& ListBox::GetName() const {
 }
 
 void ListBox::AppendItem( const sf::String& str, const sf::Image& image ) {
+	if( !CanModifyItems() ) {
+		return;
+	}
+
     m_items.push_back( Item{ str, image } );
+	m_item_widths.push_back( -1.f );
+	++m_unmeasured_items_count;
 
 	UpdateDisplayedItems();
     RequestResize();
@@ -82,7 +106,13 @@ void ListBox::AppendItem( const sf::String& str, const sf::Image& image ) {
 }
 
 void ListBox::InsertItem( IndexType index, const sf::String& str, const sf::Image& image ) {
+	if( !CanModifyItems() ) {
+		return;
+	}
+
 	m_items.insert( m_items.begin() + index, Item{ str, image } );
+	m_item_widths.insert( m_item_widths.begin() + index, -1.f );
+	++m_unmeasured_items_count;
 
 	// Update next selected indexes (decrement them).
 	std::set<IndexType> new_selected_items;
@@ -106,7 +136,13 @@ void ListBox::InsertItem( IndexType index, const sf::String& str, const sf::Imag
 }
 
 void ListBox::PrependItem( const sf::String& str, const sf::Image& image ) {
+	if( !CanModifyItems() ) {
+		return;
+	}
+
     m_items.insert( m_items.begin(), Item{ str, image } );
+	m_item_widths.insert( m_item_widths.begin(), -1.f );
+	++m_unmeasured_items_count;
 
 	// Update selected items indexes.
 	std::set<IndexType> new_selected_items;
@@ -127,18 +163,20 @@ void ListBox::PrependItem( const sf::String& str, const sf::Image& image ) {
 }
 
 void ListBox::ChangeItemText( IndexType index, const sf::String& str ) {
-	if( index >= static_cast<IndexType>( m_items.size() ) || index < 0 ) {
+	if( !CanModifyItems() || index >= static_cast<IndexType>( m_items.size() ) || index < 0 ) {
 		return;
 	}
 
 	m_items[ static_cast<std::size_t>( index ) ].text = str;
+	ForgetItemWidth( static_cast<std::size_t>( index ) );
 
 	UpdateDisplayedItems();
+	RequestResize();
 	Invalidate();
 }
 
 void ListBox::ChangeItemImage( IndexType index, const sf::Image& image ) {
-	if( index >= static_cast<IndexType>( m_items.size() ) || index < 0 ) {
+	if( !CanModifyItems() || index >= static_cast<IndexType>( m_items.size() ) || index < 0 ) {
 		return;
 	}
 
@@ -148,11 +186,15 @@ void ListBox::ChangeItemImage( IndexType index, const sf::Image& image ) {
 }
 
 void ListBox::RemoveItem( IndexType index ) {
-	if( index >= static_cast<IndexType>( m_items.size() ) || index < 0 ) {
+	if( !CanModifyItems() || index >= static_cast<IndexType>( m_items.size() ) || index < 0 ) {
 		return;
 	}
 
+	ForgetItemWidth( static_cast<std::size_t>( index ) );
+	--m_unmeasured_items_count;
+
     m_items.erase( m_items.begin() + index );
+	m_item_widths.erase( m_item_widths.begin() + index );
 
 	// Remove it from the selected indexes.
 	m_selected_items.erase( index );
@@ -180,6 +222,12 @@ void ListBox::RemoveItem( IndexType index ) {
 
 void ListBox::Clear() {
     m_items.clear();
+	m_item_widths.clear();
+	m_item_width_counts.clear();
+	m_unmeasured_items_count = 0;
+	m_item_fetcher = nullptr;
+	m_model_items_count = 0;
+	m_fetched_items.clear();
 	m_selected_items.clear();
 
 	UpdateDisplayedItems();
@@ -188,36 +236,83 @@ void ListBox::Clear() {
 	Invalidate();
 }
 
+void ListBox::SetItemModel( IndexType items_count, ItemFetcher fetcher ) {
+	m_items.clear();
+	m_item_widths.clear();
+	m_item_width_counts.clear();
+	m_unmeasured_items_count = 0;
+
+	m_item_fetcher = std::move( fetcher );
+	m_model_items_count = m_item_fetcher ? std::max( items_count, static_cast<IndexType>( 0 ) ) : 0;
+
+	// The model's items might have changed, fetch them again.
+	m_fetched_items.clear();
+
+	// Keep the selection of items that still exist.
+	m_selected_items.erase( m_selected_items.lower_bound( m_model_items_count ), m_selected_items.end() );
+
+	if( m_highlighted_item >= m_model_items_count ) {
+		m_highlighted_item = NONE;
+	}
+
+	UpdateDisplayedItems();
+	RequestResize();
+	HandleSizeChange();
+	Invalidate();
+}
+
+bool ListBox::HasItemModel() const {
+	return static_cast<bool>( m_item_fetcher );
+}
+
 ListBox::IndexType ListBox::GetItemsCount() const {
+	if( m_item_fetcher ) {
+		return m_model_items_count;
+	}
+
 	return static_cast<IndexType>( m_items.size() );
 }
 
-const sf::String& ListBox::GetItemText( IndexType index ) const {
-	if( index >= static_cast<IndexType>( m_items.size() ) || index < 0 ) {
+sf::String ListBox::GetItemText( IndexType index ) const {
+	if( index >= GetItemsCount() || index < 0 ) {
 		return EMPTY;
 	}
 
-	return m_items[ static_cast<std::size_t>( index )].text;
+	// Only items of a model that aren't displayed have to be fetched.
+	auto item = GetStoredItem( index );
+
+	return item ? item->text : m_item_fetcher( index ).text;
 }
 
-const sf::String& ListBox::GetDisplayedItemText( IndexType index ) const {
-	if( index >= static_cast<IndexType>( m_items.size() ) || index < 0 ) {
+sf::String ListBox::GetDisplayedItemText( IndexType index ) const {
+	if( index >= GetItemsCount() || index < 0 ) {
 		return EMPTY;
 	}
 
 	if(m_item_text_policy == ItemTextPolicy::RESIZE_LISTBOX) {
 		return GetItemText( index );
-	} else {
-		return m_displayed_items_texts[ static_cast<std::size_t>( index ) ];
 	}
+
+	// Texts of a model are only shrunk for the fetched items.
+	if( m_item_fetcher ) {
+		if( index < m_fetched_items_first || index - m_fetched_items_first >= static_cast<IndexType>( m_displayed_items_texts.size() ) ) {
+			return GetItemText( index );
+		}
+
+		return m_displayed_items_texts[ static_cast<std::size_t>( index - m_fetched_items_first ) ];
+	}
+
+	return m_displayed_items_texts[ static_cast<std::size_t>( index ) ];
 }
 
-const sf::Image& ListBox::GetItemImage( IndexType index ) const {
-	if( index >= static_cast<IndexType>( m_items.size() ) || index < 0 ) {
+sf::Image ListBox::GetItemImage( IndexType index ) const {
+	if( index >= GetItemsCount() || index < 0 ) {
 		return EMPTY_IMAGE;
 	}
 
-	return m_items[ static_cast<std::size_t>( index )].image;
+	auto item = GetStoredItem( index );
+
+	return item ? item->image : m_item_fetcher( index ).image;
 }
 
 ListBox::IndexType ListBox::GetHighlightedItem() const {
@@ -295,8 +390,8 @@ ListBox::IndexType ListBox::GetSelectedItemIndex( IndexType index ) const {
 	return *it;
 }
 
-const sf::String& ListBox::GetSelectedItemText( IndexType index ) const {
-	return m_items[ static_cast<std::size_t>( GetSelectedItemIndex( index ) ) ].text;
+sf::String ListBox::GetSelectedItemText( IndexType index ) const {
+	return GetItemText( GetSelectedItemIndex( index ) );
 }
 
 ListBox::IndexType ListBox::GetFirstDisplayedItemIndex() const {
@@ -304,7 +399,7 @@ ListBox::IndexType ListBox::GetFirstDisplayedItemIndex() const {
 }
 
 ListBox::IndexType ListBox::GetDisplayedItemsCount() const {
-	return std::min(m_max_displayed_items_count, static_cast<IndexType>( m_items.size() ) - m_first_displayed_item);
+	return std::min(m_max_displayed_items_count, GetItemsCount() - m_first_displayed_item);
 }
 
 ListBox::IndexType ListBox::GetMaxDisplayedItemsCount() const {
@@ -531,8 +626,12 @@ void ListBox::UpdateDisplayedItems() {
 	// If there aren't enough items from m_first_displayed_item to
 	// m_first_displayed_item + m_max_displayed_items_count, decrement
 	// m_first_displayed_item.
-	if(m_first_displayed_item + m_max_displayed_items_count > static_cast<IndexType>( m_items.size() ) ) {
-		m_first_displayed_item = std::max( static_cast<IndexType>( m_items.size() ) - m_max_displayed_items_count, static_cast<IndexType>( 0 ) );
+	if(m_first_displayed_item + m_max_displayed_items_count > GetItemsCount() ) {
+		m_first_displayed_item = std::max( GetItemsCount() - m_max_displayed_items_count, static_cast<IndexType>( 0 ) );
+	}
+
+	if( m_item_fetcher ) {
+		FetchDisplayedItems();
 	}
 }
 
@@ -540,7 +639,7 @@ void ListBox::UpdateScrollbarAdjustment() {
 	m_vertical_scrollbar->GetAdjustment()->Configure(
 		static_cast<float>( m_first_displayed_item ),
 		0.f,
-		static_cast<float>( m_items.size() ),
+		static_cast<float>( GetItemsCount() ),
 		1.f,
 		static_cast<float>( m_max_displayed_items_count ),
 		static_cast<float>( m_max_displayed_items_count )
@@ -577,8 +676,17 @@ void ListBox::UpdateDisplayedItemsText() {
 
 	float max_width = GetAllocation().width - border_width * 2 - text_padding * 2 - ( IsScrollbarVisible() ? m_vertical_scrollbar->GetAllocation().width : 0 );
 
-	for(auto& item : m_items) {
-		if( Context::Get().GetEngine().GetTextStringMetrics( item.text, *font, font_size ).x < max_width - ( GetImagesSize() != sf::Vector2f() ? m_images_size.x + text_padding : 0.f ) ) {
+	// Reuse the widths measured for the requisition if they are still valid.
+	auto widths_valid = ( font == m_measured_font ) && ( font_size == m_measured_font_size );
+
+	// Of a model, only the fetched items are shrunk.
+	auto items_count = m_item_fetcher ? m_fetched_items.size() : m_items.size();
+
+	for( std::size_t index = 0; index < items_count; ++index ) {
+		const auto& item = m_item_fetcher ? m_fetched_items[index] : m_items[index];
+		auto width = ( !m_item_fetcher && widths_valid && ( m_item_widths[index] >= 0.f ) ) ? m_item_widths[index] : Context::Get().GetEngine().GetTextStringMetrics( item.text, *font, font_size ).x;
+
+		if( width < max_width - ( GetImagesSize() != sf::Vector2f() ? m_images_size.x + text_padding : 0.f ) ) {
 			// The item's text is fully displayable in the listbox's width.
 			m_displayed_items_texts.push_back( item.text );
 		} else {
@@ -602,6 +710,112 @@ void ListBox::UpdateDisplayedItemsText() {
 	Invalidate();
 }
 
+void ListBox::FetchDisplayedItems() {
+	auto first = m_first_displayed_item;
+	auto last = std::min( first + m_max_displayed_items_count, m_model_items_count );
+	auto fetched_last = m_fetched_items_first + static_cast<IndexType>( m_fetched_items.size() );
+
+	// Keep the items that are still displayed, drop the others.
+	if( ( first >= fetched_last ) || ( last <= m_fetched_items_first ) ) {
+		m_fetched_items.clear();
+		m_fetched_items_first = first;
+		fetched_last = first;
+	}
+	else {
+		for( ; m_fetched_items_first < first; ++m_fetched_items_first ) {
+			m_fetched_items.pop_front();
+		}
+
+		for( ; fetched_last > last; --fetched_last ) {
+			m_fetched_items.pop_back();
+		}
+	}
+
+	// Only fetch the items that just scrolled into view.
+	auto changed = false;
+
+	for( ; m_fetched_items_first > first; changed = true ) {
+		m_fetched_items.push_front( m_item_fetcher( --m_fetched_items_first ) );
+	}
+
+	for( ; fetched_last < last; changed = true ) {
+		m_fetched_items.push_back( m_item_fetcher( fetched_last++ ) );
+	}
+
+	if( changed && ( m_item_text_policy == ItemTextPolicy::SHRINK ) ) {
+		UpdateDisplayedItemsText();
+	}
+}
+
+const ListBox::Item* ListBox::GetStoredItem( IndexType index ) const {
+	if( !m_item_fetcher ) {
+		return &m_items[ static_cast<std::size_t>( index ) ];
+	}
+
+	if( ( index >= m_fetched_items_first ) && ( index - m_fetched_items_first < static_cast<IndexType>( m_fetched_items.size() ) ) ) {
+		return &m_fetched_items[ static_cast<std::size_t>( index - m_fetched_items_first ) ];
+	}
+
+	// Items outside of the displayed ones aren't kept around.
+	return nullptr;
+}
+
+bool ListBox::CanModifyItems() const {
+	if( !m_item_fetcher ) {
+		return true;
+	}
+
+#if defined( SFGUI_DEBUG )
+	std::cerr << "SFGUI warning: Items of a ListBox with an item model can't be modified.\n";
+#endif
+
+	return false;
+}
+
+void ListBox::MeasureItems( const std::shared_ptr<const sf::Font>& font, unsigned int font_size ) {
+	// All widths are invalid once the font changes.
+	if( ( font != m_measured_font ) || ( font_size != m_measured_font_size ) ) {
+		m_measured_font = font;
+		m_measured_font_size = font_size;
+
+		std::fill( m_item_widths.begin(), m_item_widths.end(), -1.f );
+		m_item_width_counts.clear();
+		m_unmeasured_items_count = static_cast<IndexType>( m_items.size() );
+	}
+
+	if( !m_unmeasured_items_count ) {
+		return;
+	}
+
+	for( std::size_t index = 0; index < m_items.size(); ++index ) {
+		auto& width = m_item_widths[index];
+
+		if( width < 0.f ) {
+			width = Context::Get().GetEngine().GetTextStringMetrics( m_items[index].text, *font, font_size ).x;
+			++m_item_width_counts[width];
+		}
+	}
+
+	m_unmeasured_items_count = 0;
+}
+
+void ListBox::ForgetItemWidth( std::size_t index ) {
+	auto& width = m_item_widths[index];
+
+	if( width < 0.f ) {
+		return;
+	}
+
+	auto iter = m_item_width_counts.find( width );
+
+	if( !--iter->second ) {
+		m_item_width_counts.erase( iter );
+	}
+
+	width = -1.f;
+	++m_unmeasured_items_count;
+}
+
 void ListBox::OnScrollbarChanged() {
 	m_first_displayed_item = static_cast<IndexType>( m_vertical_scrollbar->GetAdjustment()->GetValue() );
 	UpdateDisplayedItems();
@@ -0,0 +1,139 @@
+#include <SFGUI/ParallelFor.hpp>
+
+#include <algorithm>
+#include <system_error>
+
+namespace sfg {
+namespace priv {
+
+WorkerPool::WorkerPool() :
+	m_function( nullptr ),
+	m_count( 0 ),
+	m_range_size( 0 ),
+	m_next_begin( 0 ),
+	m_unfinished_ranges( 0 ),
+	m_stop( false )
+{
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard<std::mutex> lock( m_mutex );
+		m_stop = true;
+	}
+
+	m_work_available.notify_all();
+
+	for( auto& thread : m_threads ) {
+		thread.join();
+	}
+}
+
+void WorkerPool::StartThreads( std::size_t thread_count ) {
+	if( !m_threads.empty() ) {
+		return;
+	}
+
+	m_threads.reserve( thread_count );
+
+	for( std::size_t index = 0; index < thread_count; ++index ) {
+		// Make do with the threads we got if the system runs out of them.
+		try {
+			m_threads.emplace_back( &WorkerPool::Work, this );
+		}
+		catch( const std::system_error& ) {
+			break;
+		}
+	}
+}
+
+void WorkerPool::ParallelFor( std::size_t count, std::size_t minimum_range_size, const std::function<void( std::size_t, std::size_t )>& function ) {
+	// hardware_concurrency() may return 0 if it can't tell.
+	const auto hardware_threads = std::max( static_cast<std::size_t>( std::thread::hardware_concurrency() ), std::size_t( 1 ) );
+	auto thread_count = std::min( hardware_threads, count / std::max( minimum_range_size, std::size_t( 1 ) ) );
+
+	if( thread_count > 1 ) {
+		StartThreads( hardware_threads - 1 );
+
+		thread_count = std::min( thread_count, m_threads.size() + 1 );
+	}
+
+	if( thread_count <= 1 ) {
+		if( count ) {
+			function( 0, count );
+		}
+
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock( m_mutex );
+
+	m_function = &function;
+	m_count = count;
+	m_range_size = ( count + thread_count - 1 ) / thread_count;
+	m_next_begin = 0;
+	m_unfinished_ranges = ( count + m_range_size - 1 ) / m_range_size;
+
+	m_work_available.notify_all();
+
+	ProcessRanges( lock );
+
+	m_work_done.wait( lock, [this]() { return !m_unfinished_ranges; } );
+
+	m_function = nullptr;
+
+	if( m_exception ) {
+		auto exception = m_exception;
+		m_exception = nullptr;
+
+		std::rethrow_exception( exception );
+	}
+}
+
+void WorkerPool::ProcessRanges( std::unique_lock<std::mutex>& lock ) {
+	while( m_function && ( m_next_begin < m_count ) ) {
+		const auto& function = *m_function;
+		const auto begin = m_next_begin;
+		const auto end = std::min( begin + m_range_size, m_count );
+
+		m_next_begin = end;
+
+		lock.unlock();
+
+		std::exception_ptr exception;
+
+		try {
+			function( begin, end );
+		}
+		catch( ... ) {
+			exception = std::current_exception();
+		}
+
+		lock.lock();
+
+		if( exception && !m_exception ) {
+			m_exception = exception;
+		}
+
+		if( !--m_unfinished_ranges ) {
+			m_work_done.notify_all();
+		}
+	}
+}
+
+void WorkerPool::Work() {
+	std::unique_lock<std::mutex> lock( m_mutex );
+
+	while( true ) {
+		m_work_available.wait( lock, [this]() { return m_stop || ( m_function && ( m_next_begin < m_count ) ); } );
+
+		if( m_stop ) {
+			return;
+		}
+
+		ProcessRanges( lock );
+	}
+}
+
+}
+}
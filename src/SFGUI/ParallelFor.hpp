@@ -0,0 +1,64 @@
+#pragma once
+
+#include <SFGUI/Config.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sfg {
+namespace priv {
+
+/** Worker threads that process ranges of items in parallel.
+ * The threads are started the first time they are needed and
+ * wait for more work in between, until the pool is destroyed.
+ */
+class WorkerPool {
+	public:
+		/** Ctor.
+		 */
+		WorkerPool();
+
+		/** Dtor.
+		 * Stops and joins the worker threads.
+		 */
+		~WorkerPool();
+
+		WorkerPool( const WorkerPool& ) = delete;
+		WorkerPool& operator=( const WorkerPool& ) = delete;
+
+		/** Process a range of items on all available cores.
+		 * [0, count) is split into contiguous ranges, one per worker thread.
+		 * The calling thread processes ranges as well and returns once all
+		 * ranges are done. Small workloads aren't split at all. If function
+		 * throws, the first exception is rethrown after all ranges are done.
+		 * @param count Number of items to process.
+		 * @param minimum_range_size Number of items a worker has to be given at least.
+		 * @param function Function processing the items in [begin, end).
+		 */
+		void ParallelFor( std::size_t count, std::size_t minimum_range_size, const std::function<void( std::size_t, std::size_t )>& function );
+
+	private:
+		void StartThreads( std::size_t thread_count );
+		void Work();
+		void ProcessRanges( std::unique_lock<std::mutex>& lock );
+
+		std::vector<std::thread> m_threads;
+		std::mutex m_mutex;
+		std::condition_variable m_work_available;
+		std::condition_variable m_work_done;
+		std::exception_ptr m_exception;
+		const std::function<void( std::size_t, std::size_t )>* m_function;
+		std::size_t m_count;
+		std::size_t m_range_size;
+		std::size_t m_next_begin;
+		std::size_t m_unfinished_ranges;
+		bool m_stop;
+};
+
+}
+}
@@ -5,11 +5,14 @@
 #include <SFGUI/Renderer.hpp>
 #include <SFGUI/Signal.hpp>
 
+#include <algorithm>
+
 namespace sfg {
 
 Primitive::Primitive( std::size_t vertex_reserve ) :
 	m_layer( 0 ),
 	m_level( 0 ),
+	m_handle( 0 ),
 	m_synced( false ),
 	m_visible( true )
 {
@@ -21,8 +24,13 @@ Primitive::Primitive( std::size_t vertex_reserve ) :
 }
 
 void Primitive::Add( Primitive& primitive ) {
+	m_synced = false;
+	Damage();
+
 	auto current_index = m_vertices.size();
 
+	Reserve( primitive.GetVertices().size(), primitive.GetIndices().size() );
+
 	for( const auto& vertex : primitive.GetVertices() ) {
 		m_vertices.push_back( vertex );
 	}
@@ -30,15 +38,23 @@ void Primitive::Add( Primitive& primitive ) {
 	for( const auto& index : primitive.GetIndices() ) {
 		m_indices.push_back( static_cast<unsigned int>( current_index + index ) );
 	}
+
+	ExtendBounds( current_index );
 }
 
-void Primitive::AddVertex( const PrimitiveVertex& vertex ) {
+void Primitive::Reserve( std::size_t vertex_count, std::size_t index_count ) {
+	m_vertices.reserve( m_vertices.size() + vertex_count );
+	m_indices.reserve( m_indices.size() + index_count );
+}
+
+void Primitive::AddVertex( const PrimitiveVertex& vertex, bool deduplicate ) {
 	m_synced = false;
+	Damage();
 
 	auto vertice_count = m_vertices.size();
 
 	// Skip the duplicate search if this vertex is part of the first triangle.
-	if( vertice_count >= 3 ) {
+	if( deduplicate && ( vertice_count >= 3 ) ) {
 		for( std::size_t index = 0; index < vertice_count; ++index ) {
 			if( m_vertices[index] == vertex ) {
 				// Vertex already part of this primitive. Index it.
@@ -51,6 +67,49 @@ void Primitive::AddVertex( const PrimitiveVertex& vertex ) {
 
 	m_indices.push_back( static_cast<unsigned int>( vertice_count ) );
 	m_vertices.push_back( vertex );
+
+	ExtendBounds( vertice_count );
+}
+
+unsigned int Primitive::AddUnindexedVertex( const PrimitiveVertex& vertex ) {
+	m_synced = false;
+	Damage();
+
+	m_vertices.push_back( vertex );
+
+	ExtendBounds( m_vertices.size() - 1 );
+
+	return static_cast<unsigned int>( m_vertices.size() - 1 );
+}
+
+void Primitive::AddTriangleIndexed( unsigned int index0, unsigned int index1, unsigned int index2 ) {
+	m_synced = false;
+	Damage();
+
+	m_indices.push_back( index0 );
+	m_indices.push_back( index1 );
+	m_indices.push_back( index2 );
+}
+
+void Primitive::AddQuad( const PrimitiveVertex& top_left, const PrimitiveVertex& bottom_left, const PrimitiveVertex& bottom_right, const PrimitiveVertex& top_right ) {
+	m_synced = false;
+	Damage();
+
+	auto base_index = static_cast<unsigned int>( m_vertices.size() );
+
+	m_vertices.push_back( top_left );
+	m_vertices.push_back( bottom_left );
+	m_vertices.push_back( bottom_right );
+	m_vertices.push_back( top_right );
+
+	ExtendBounds( base_index );
+
+	m_indices.push_back( base_index + 0 );
+	m_indices.push_back( base_index + 1 );
+	m_indices.push_back( base_index + 3 );
+	m_indices.push_back( base_index + 3 );
+	m_indices.push_back( base_index + 1 );
+	m_indices.push_back( base_index + 2 );
 }
 
 void Primitive::AddTexture( PrimitiveTexture::Ptr texture ) {
@@ -58,9 +117,12 @@ void Primitive::AddTexture( PrimitiveTexture::Ptr texture ) {
 }
 
 void Primitive::SetPosition( const sf::Vector2f& position ) {
-	m_position = position;
+	if( position == m_position ) {
+		return;
+	}
 
-	m_synced = false;
+	m_position = position;
+	Damage();
 }
 
 const sf::Vector2f& Primitive::GetPosition() const {
@@ -68,9 +130,12 @@ const sf::Vector2f& Primitive::GetPosition() const {
 }
 
 void Primitive::SetViewport( RendererViewport::Ptr viewport ) {
-	m_viewport = viewport;
+	if( viewport == m_viewport ) {
+		return;
+	}
 
-	m_synced = false;
+	m_viewport = viewport;
+	Damage();
 }
 
 RendererViewport::Ptr Primitive::GetViewport() const {
@@ -78,9 +143,15 @@ RendererViewport::Ptr Primitive::GetViewport() const {
 }
 
 void Primitive::SetLayer( int layer ) {
+	if( layer == m_layer ) {
+		return;
+	}
+
 	m_layer = layer;
 
-	m_synced = false;
+	if( Renderer::Exists() ) {
+		Renderer::Get().ReorderPrimitive( *this );
+	}
 }
 
 int Primitive::GetLayer() const {
@@ -88,9 +159,15 @@ int Primitive::GetLayer() const {
 }
 
 void Primitive::SetLevel( int level ) {
+	if( level == m_level ) {
+		return;
+	}
+
 	m_level = level;
 
-	m_synced = false;
+	if( Renderer::Exists() ) {
+		Renderer::Get().ReorderPrimitive( *this );
+	}
 }
 
 int Primitive::GetLevel() const {
@@ -109,7 +186,42 @@ const std::vector<unsigned int>& Primitive::GetIndices() const {
 	return m_indices;
 }
 
+const sf::FloatRect& Primitive::GetBounds() const {
+	return m_bounds;
+}
+
+void Primitive::ExtendBounds( std::size_t first_vertex ) {
+	if( first_vertex >= m_vertices.size() ) {
+		return;
+	}
+
+	auto minimum = m_vertices[first_vertex].position;
+	auto maximum = minimum;
+
+	// Grow the existing box unless these are the first vertices.
+	if( first_vertex ) {
+		minimum = sf::Vector2f( m_bounds.left, m_bounds.top );
+		maximum = sf::Vector2f( m_bounds.left + m_bounds.width, m_bounds.top + m_bounds.height );
+	}
+
+	for( auto index = first_vertex; index < m_vertices.size(); ++index ) {
+		const auto& position = m_vertices[index].position;
+
+		minimum.x = std::min( minimum.x, position.x );
+		minimum.y = std::min( minimum.y, position.y );
+		maximum.x = std::max( maximum.x, position.x );
+		maximum.y = std::max( maximum.y, position.y );
+	}
+
+	m_bounds = sf::FloatRect( minimum, maximum - minimum );
+}
+
 void Primitive::SetSynced( bool synced ) {
+	// Somebody changed the vertices through GetVertices().
+	if( m_synced && !synced ) {
+		Damage();
+	}
+
 	m_synced = synced;
 }
 
@@ -118,9 +230,12 @@ bool Primitive::IsSynced() const {
 }
 
 void Primitive::SetVisible( bool visible ) {
-	m_visible = visible;
+	if( visible == m_visible ) {
+		return;
+	}
 
-	m_synced = false;
+	m_visible = visible;
+	Damage();
 }
 
 bool Primitive::IsVisible() const {
@@ -129,17 +244,34 @@ bool Primitive::IsVisible() const {
 
 void Primitive::SetCustomDrawCallback( std::shared_ptr<Signal> callback ) {
 	m_custom_draw_callback = callback;
+	Damage();
 }
 
 std::shared_ptr<Signal> Primitive::GetCustomDrawCallback() const {
 	return m_custom_draw_callback;
 }
 
+void Primitive::SetHandle( std::uint64_t handle ) {
+	m_handle = handle;
+}
+
+std::uint64_t Primitive::GetHandle() const {
+	return m_handle;
+}
+
+void Primitive::Damage() {
+	// Primitives are usually built before they are added to the renderer.
+	if( m_handle && Renderer::Exists() ) {
+		Renderer::Get().DamagePrimitive( *this );
+	}
+}
+
 void Primitive::Clear() {
 	m_vertices.clear();
 	m_textures.clear();
 	m_indices.clear();
 
+	m_bounds = sf::FloatRect();
 	m_position = sf::Vector2f( 0.f, 0.f );
 	m_layer = 0;
 	m_level = 0;
@@ -148,6 +280,8 @@ void Primitive::Clear() {
 
 	m_viewport = Renderer::Get().GetDefaultViewport();
 	m_custom_draw_callback.reset();
+
+	Renderer::Get().ReorderPrimitive( *this );
 }
 
 }
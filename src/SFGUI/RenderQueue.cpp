@@ -20,12 +20,8 @@ RenderQueue::RenderQueue() :
 }
 
 RenderQueue::~RenderQueue() {
-	while( !m_primitives.empty() ) {
-		if( sfg::Renderer::Exists() ) {
-			Renderer::Get().RemovePrimitive( m_primitives.back() );
-		}
-
-		m_primitives.pop_back();
+	if( sfg::Renderer::Exists() ) {
+		Renderer::Get().RemovePrimitives( m_primitives );
 	}
 }
 
@@ -92,6 +88,10 @@ void RenderQueue::Show( bool show ) {
 }
 
 void RenderQueue::SetLevel( int level ) {
+	if( level == m_level ) {
+		return;
+	}
+
 	m_level = level;
 
 	for( const auto& primitive : m_primitives ) {
@@ -115,4 +115,16 @@ RendererViewport::Ptr RenderQueue::GetViewport() const {
 	return m_viewport;
 }
 
+void RenderQueue::SetStateUpdater( std::function<bool( RenderQueue& )> updater ) {
+	m_state_updater = std::move( updater );
+}
+
+bool RenderQueue::UpdateState() {
+	if( !m_state_updater ) {
+		return false;
+	}
+
+	return m_state_updater( *this );
+}
+
 }
@@ -1,43 +1,316 @@
+// Needs to be included before GLLoader for NOMINMAX
+#include <SFGUI/Config.hpp>
+
+// Needs to be included before OpenGL (so anything else)
+#include <SFGUI/GLLoader.hpp>
+
+// X headers define None which is used by SFML's window style.
+#undef None
+
 #include <SFGUI/Renderer.hpp>
 #include <SFGUI/Renderers.hpp>
 #include <SFGUI/Context.hpp>
 #include <SFGUI/Engine.hpp>
 #include <SFGUI/RendererBatch.hpp>
+#include <SFGUI/RendererPrimitiveRange.hpp>
 #include <SFGUI/RendererTextureNode.hpp>
 #include <SFGUI/RendererViewport.hpp>
 #include <SFGUI/Primitive.hpp>
 #include <SFGUI/PrimitiveTexture.hpp>
 #include <SFGUI/PrimitiveVertex.hpp>
+#include <SFGUI/GLCheck.hpp>
+#include <SFGUI/ParallelFor.hpp>
 
 #include <SFML/Graphics/Text.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Graphics/RenderTexture.hpp>
 #include <SFML/Window/Context.hpp>
+#include <algorithm>
 #include <cmath>
+#include <cstdlib>
 #include <cstring>
 #include <cassert>
+#include <functional>
+#include <limits>
+#include <utility>
+
+#define GLEXT_framebuffer_object sfgogl_ext_EXT_framebuffer_object
+
+#define GLEXT_GL_FRAMEBUFFER GL_FRAMEBUFFER_EXT
+#define GLEXT_GL_FRAMEBUFFER_BINDING GL_FRAMEBUFFER_BINDING_EXT
+#define GLEXT_GL_COLOR_ATTACHMENT0 GL_COLOR_ATTACHMENT0_EXT
+
+#define GLEXT_glGenFramebuffers glGenFramebuffersEXT
+#define GLEXT_glDeleteFramebuffers glDeleteFramebuffersEXT
+#define GLEXT_glBindFramebuffer glBindFramebufferEXT
+#define GLEXT_glFramebufferTexture2D glFramebufferTexture2DEXT
 
 namespace {
 
 std::shared_ptr<sfg::Renderer> instance;
 int max_texture_size = 0;
+bool framebuffer_supported = false;
+
+// Texture coordinates are stored as 16-bit fractions of the page size.
+// On larger pages their rounding error approaches half a texel.
+const int max_atlas_page_size = 16384;
+
+// Unused primitives kept around for reuse, along with their storage.
+const std::size_t max_pooled_primitives = 16384;
+
+// Grow area to also cover rect.
+void UniteRects( sf::FloatRect& area, const sf::FloatRect& rect ) {
+	if( ( area.width <= 0.f ) || ( area.height <= 0.f ) ) {
+		area = rect;
+		return;
+	}
+
+	auto left = std::min( area.left, rect.left );
+	auto top = std::min( area.top, rect.top );
+	auto right = std::max( area.left + area.width, rect.left + rect.width );
+	auto bottom = std::max( area.top + area.height, rect.top + rect.height );
+
+	area = sf::FloatRect( left, top, right - left, bottom - top );
+}
+
+// Glyphs below this codepoint are looked up directly by codepoint.
+// This covers Latin, Greek and Cyrillic.
+const std::size_t direct_glyph_count = 0x0530;
+
+// FreeType is asked for kerning every single time, remember the pairs we've seen.
+float GetKerning( sfg::priv::RendererGlyphTable& table, const sf::Font& font, sf::Uint32 first, sf::Uint32 second, unsigned int size ) {
+	auto key = ( static_cast<std::uint64_t>( first ) << 32 ) | second;
+	auto iter = table.kerning.find( key );
+
+	if( iter != table.kerning.end() ) {
+		return iter->second;
+	}
+
+	auto kerning = font.getKerning( first, second, size );
+
+	table.kerning.emplace( key, kerning );
+
+	return kerning;
+}
+
+// Get the font face that Laurent tries to hide from us.
+void* GetFontFace( const sf::Font& font ) {
+	struct FontStruct {
+		void* library;
+		void* font_face; // Authentic SFML comment: implementation details
+		void* unused1;
+		void* unused2;
+		int* unused3;
+		std::string family;
+
+		// Since maps allocate everything non-contiguously on the heap we can use void* instead of Page here.
+		mutable std::map<unsigned int, void*> unused4;
+		mutable std::vector<sf::Uint8> unused5;
+	};
+
+	// All your font face are belong to us too.
+	return reinterpret_cast<const FontStruct&>( font ).font_face;
+}
+
+// Packs layer and level into a single key that orders by layer first.
+// Flipping the sign bits maps the signed ranges onto unsigned ones.
+std::uint64_t GetDepthKey( const sfg::Primitive& primitive ) {
+	auto layer = static_cast<std::uint32_t>( primitive.GetLayer() ) ^ 0x80000000u;
+	auto level = static_cast<std::uint32_t>( primitive.GetLevel() ) ^ 0x80000000u;
+
+	return ( static_cast<std::uint64_t>( layer ) << 32 ) | level;
+}
+
+// We insert padding between atlas elements to prevent
+// texture filtering from screwing up our images.
+// If 1 pixel isn't enough, increase.
+const int atlas_padding = 1;
+
+std::uint64_t GetTextureKey( const sf::Vector2i& offset ) {
+	return ( static_cast<std::uint64_t>( static_cast<std::uint32_t>( offset.x ) ) << 32 ) | static_cast<std::uint32_t>( offset.y );
+}
+
+sf::Vector2i GetTextureOffset( const sf::Vector2f& offset ) {
+	return sf::Vector2i( static_cast<int>( std::floor( offset.x + .5f ) ), static_cast<int>( std::floor( offset.y + .5f ) ) );
+}
+
+// FNV-1a over the image dimensions and pixels. Used to find images
+// that were already loaded into the atlas. A second, unrelated hash
+// (a polynomial one) tells images apart whose FNV-1a hashes collide.
+std::pair<std::uint64_t, std::uint64_t> GetImageHash( const sf::Image& image ) {
+	auto hash = static_cast<std::uint64_t>( 14695981039346656037ull );
+	auto check_hash = static_cast<std::uint64_t>( 0 );
+
+	auto add_bytes = [&hash, &check_hash]( const sf::Uint8* bytes, std::size_t count ) {
+		for( std::size_t index = 0; index < count; ++index ) {
+			hash ^= bytes[index];
+			hash *= 1099511628211ull;
+
+			check_hash = ( check_hash + bytes[index] + 1 ) * 0x9e3779b97f4a7c15ull;
+		}
+	};
+
+	const auto size = image.getSize();
+
+	add_bytes( reinterpret_cast<const sf::Uint8*>( &size ), sizeof( size ) );
+
+	if( size.x && size.y ) {
+		add_bytes( image.getPixelsPtr(), static_cast<std::size_t>( size.x ) * size.y * 4 );
+	}
+
+	return std::make_pair( hash, check_hash );
+}
+
+unsigned int GetNextPowerOfTwo( unsigned int value ) {
+	auto power = 1u;
+
+	while( power < value ) {
+		power <<= 1;
+	}
+
+	return power;
+}
+
+// Guillotine packer. Out of all free rects the image fits in, pick the one
+// that grows the used extent of the page the least so pages stay compact.
+// Ties, e.g. holes within the extent, go to the tightest fit.
+bool AllocateAtlasRect( sfg::priv::RendererAtlasPage& page, const sf::Vector2i& size, sf::Vector2i& position ) {
+	auto best_rect = page.free_rects.end();
+	auto best_extent_area = std::numeric_limits<std::int64_t>::max();
+	auto best_fit_area = std::numeric_limits<std::int64_t>::max();
+
+	for( auto iter = page.free_rects.begin(); iter != page.free_rects.end(); ++iter ) {
+		if( ( iter->width < size.x ) || ( iter->height < size.y ) ) {
+			continue;
+		}
+
+		auto extent_area = static_cast<std::int64_t>( std::max( page.extent.x, iter->left + size.x ) ) * std::max( page.extent.y, iter->top + size.y );
+		auto fit_area = static_cast<std::int64_t>( iter->width ) * iter->height;
+
+		if( ( extent_area < best_extent_area ) || ( ( extent_area == best_extent_area ) && ( fit_area < best_fit_area ) ) ) {
+			best_rect = iter;
+			best_extent_area = extent_area;
+			best_fit_area = fit_area;
+		}
+	}
+
+	if( best_rect == page.free_rects.end() ) {
+		return false;
+	}
+
+	auto free_rect = *best_rect;
+
+	*best_rect = page.free_rects.back();
+	page.free_rects.pop_back();
+
+	position = sf::Vector2i( free_rect.left, free_rect.top );
+
+	// Split the remaining space along the shorter leftover axis,
+	// this keeps the larger of the two new free rects as big as possible.
+	auto leftover_x = free_rect.width - size.x;
+	auto leftover_y = free_rect.height - size.y;
+
+	sf::IntRect right;
+	sf::IntRect bottom;
+
+	if( leftover_x < leftover_y ) {
+		right = sf::IntRect( free_rect.left + size.x, free_rect.top, leftover_x, size.y );
+		bottom = sf::IntRect( free_rect.left, free_rect.top + size.y, free_rect.width, leftover_y );
+	}
+	else {
+		right = sf::IntRect( free_rect.left + size.x, free_rect.top, leftover_x, free_rect.height );
+		bottom = sf::IntRect( free_rect.left, free_rect.top + size.y, size.x, leftover_y );
+	}
+
+	if( right.width && right.height ) {
+		page.free_rects.push_back( right );
+	}
+
+	if( bottom.width && bottom.height ) {
+		page.free_rects.push_back( bottom );
+	}
+
+	page.extent.x = std::max( page.extent.x, position.x + size.x );
+	page.extent.y = std::max( page.extent.y, position.y + size.y );
+	page.allocated_area += static_cast<std::size_t>( size.x * size.y );
+
+	return true;
+}
+
+void FreeAtlasRect( sfg::priv::RendererAtlasPage& page, sf::IntRect rect ) {
+	page.allocated_area -= static_cast<std::size_t>( rect.width * rect.height );
+
+	// Coalesce with free neighbours that share a complete edge. The merged
+	// rect might complete an edge with yet another one, so keep going.
+	auto merged = true;
+
+	while( merged ) {
+		merged = false;
+
+		for( auto iter = page.free_rects.begin(); iter != page.free_rects.end(); ++iter ) {
+			const auto& other = *iter;
+
+			if( ( other.left == rect.left ) && ( other.width == rect.width ) ) {
+				if( other.top + other.height == rect.top ) {
+					rect.top = other.top;
+					rect.height += other.height;
+					merged = true;
+				}
+				else if( rect.top + rect.height == other.top ) {
+					rect.height += other.height;
+					merged = true;
+				}
+			}
+			else if( ( other.top == rect.top ) && ( other.height == rect.height ) ) {
+				if( other.left + other.width == rect.left ) {
+					rect.left = other.left;
+					rect.width += other.width;
+					merged = true;
+				}
+				else if( rect.left + rect.width == other.left ) {
+					rect.width += other.width;
+					merged = true;
+				}
+			}
+
+			if( merged ) {
+				*iter = page.free_rects.back();
+				page.free_rects.pop_back();
+				break;
+			}
+		}
+	}
+
+	page.free_rects.push_back( rect );
+}
 
 }
 
 namespace sfg {
 
-Renderer::Renderer() :
+Renderer::Renderer( bool keep_atlas_images ) :
+	m_worker_pool( new priv::WorkerPool ),
 	m_vertex_count( 0 ),
 	m_index_count( 0 ),
 	m_force_redraw( false ),
-	m_primitives_sorted( false ) {
+	m_keep_atlas_images( keep_atlas_images ),
+	m_primitive_sequence( 0 ),
+	m_current_target( nullptr ),
+	m_primitives_sorted( false ),
+	m_frame_statistics_history_position( 0 ),
+	m_frame_statistics_history_size( 120 ) {
 	static auto checked_max_texture_size = false;
 
 	if( !checked_max_texture_size ) {
 		// Needed to determine maximum texture size.
 		sf::Context context;
 
-		max_texture_size = static_cast<int>( sf::Texture::getMaximumSize() );
+		max_texture_size = std::min( static_cast<int>( sf::Texture::getMaximumSize() ), max_atlas_page_size );
+
+		// Needed to copy glyphs into the atlas without reading them back.
+		sfgogl_LoadFunctions();
+
+		framebuffer_supported = ( GLEXT_framebuffer_object != 0 );
 
 		checked_max_texture_size = true;
 	}
@@ -55,7 +328,14 @@ Renderer::~Renderer() {
 
 Renderer& Renderer::Create() {
 	if( !instance ) {
-		if( NonLegacyRenderer::IsAvailable() ) {
+		// Machines without a GPU, e.g. CI nodes, can force
+		// the software renderer by setting SFGUI_RENDERER=software.
+		const auto requested_renderer = std::getenv( "SFGUI_RENDERER" );
+
+		if( requested_renderer && ( std::string( requested_renderer ) == "software" ) ) {
+			instance = SoftwareRenderer::Create();
+		}
+		else if( NonLegacyRenderer::IsAvailable() ) {
 			instance = NonLegacyRenderer::Create();
 		}
 		else if( VertexBufferRenderer::IsAvailable() ) {
@@ -103,90 +383,87 @@ RendererViewport::Ptr Renderer::CreateViewport() {
 }
 
 Primitive::Ptr Renderer::CreateText( const sf::Text& text ) {
-	const auto& font = *text.getFont();
-	auto character_size = text.getCharacterSize();
-	auto color = text.getFillColor();
+	TextStyle style;
+	style.font = text.getFont();
+	style.character_size = text.getCharacterSize();
+	style.color = text.getFillColor();
 
-	auto atlas_offset = LoadFont( font, character_size );
-
-	const auto& str = text.getString();
+	return CreateText( text.getString(), text.getPosition(), style );
+}
 
-	auto horizontal_spacing = static_cast<float>( font.getGlyph( L' ', character_size, false ).advance );
-	auto vertical_spacing = static_cast<float>( Context::Get().GetEngine().GetFontLineHeight( font, character_size ) );
-	sf::Vector2f start_position( std::floor( text.getPosition().x + .5f ), std::floor( text.getPosition().y + static_cast<float>( character_size ) + .5f ) );
+Primitive::Ptr Renderer::CreateText( const sf::String& string, const sf::Vector2f& position, const TextStyle& style ) {
+	const auto& font = *style.font;
+	auto character_size = style.character_size;
+	auto& table = GetGlyphTable( font, character_size );
 
-	sf::Vector2f position( start_position );
+	sf::Vector2f start_position( std::floor( position.x + .5f ), std::floor( position.y + static_cast<float>( character_size ) + .5f ) );
+	sf::Vector2f pen_position( start_position );
 
 	const static auto tab_spaces = 2.f;
 
 	sf::Uint32 previous_character = 0;
 
-	auto primitive = std::make_shared<Primitive>( str.getSize() * 4 );
+	auto primitive = CreatePrimitive();
+	primitive->Reserve( string.getSize() * 4, string.getSize() * 6 );
+
+	PrimitiveVertex vertex0;
+	PrimitiveVertex vertex1;
+	PrimitiveVertex vertex2;
+	PrimitiveVertex vertex3;
 
-	Primitive character_primitive( 4 );
+	vertex0.color = style.color;
+	vertex1.color = style.color;
+	vertex2.color = style.color;
+	vertex3.color = style.color;
 
-	for( const auto& current_character : str ) {
-		position.x += static_cast<float>( font.getKerning( previous_character, current_character, character_size ) );
+	for( const auto& current_character : string ) {
+		if( previous_character ) {
+			pen_position.x += GetKerning( table, font, previous_character, current_character, character_size );
+		}
 
 		switch( current_character ) {
 			case L' ':
-				position.x += horizontal_spacing;
+				pen_position.x += table.space_advance;
 				continue;
 			case L'\t':
-				position.x += horizontal_spacing * tab_spaces;
+				pen_position.x += table.space_advance * tab_spaces;
 				continue;
 			case L'\n':
-				position.y += vertical_spacing;
-				position.x = start_position.x;
+				pen_position.y += table.line_height;
+				pen_position.x = start_position.x;
 				continue;
 			case L'\v':
-				position.y += vertical_spacing * tab_spaces;
+				pen_position.y += table.line_height * tab_spaces;
 				continue;
 			default:
 				break;
 		}
 
-		const auto& glyph = font.getGlyph( current_character, character_size, false );
-
-		PrimitiveVertex vertex0;
-		PrimitiveVertex vertex1;
-		PrimitiveVertex vertex2;
-		PrimitiveVertex vertex3;
-
-		vertex0.position = position + sf::Vector2f( static_cast<float>( glyph.bounds.left ), static_cast<float>( glyph.bounds.top ) );
-		vertex1.position = position + sf::Vector2f( static_cast<float>( glyph.bounds.left ), static_cast<float>( glyph.bounds.top + glyph.bounds.height ) );
-		vertex2.position = position + sf::Vector2f( static_cast<float>( glyph.bounds.left + glyph.bounds.width ), static_cast<float>( glyph.bounds.top ) );
-		vertex3.position = position + sf::Vector2f( static_cast<float>( glyph.bounds.left + glyph.bounds.width ), static_cast<float>( glyph.bounds.top + glyph.bounds.height ) );
-
-		vertex0.color = color;
-		vertex1.color = color;
-		vertex2.color = color;
-		vertex3.color = color;
-
-		// Let SFML cast the Rect for us.
-		sf::FloatRect texture_rect( glyph.textureRect );
+		const auto& glyph = table.glyphs[GetGlyphIndex( table, font, current_character, character_size )];
 
-		vertex0.texture_coordinate = atlas_offset + sf::Vector2f( texture_rect.left, texture_rect.top );
-		vertex1.texture_coordinate = atlas_offset + sf::Vector2f( texture_rect.left, texture_rect.top + texture_rect.height );
-		vertex2.texture_coordinate = atlas_offset + sf::Vector2f( texture_rect.left + texture_rect.width, texture_rect.top );
-		vertex3.texture_coordinate = atlas_offset + sf::Vector2f( texture_rect.left + texture_rect.width, texture_rect.top + texture_rect.height );
+		if( glyph.bounds.width && glyph.bounds.height ) {
+			auto top_left = pen_position + sf::Vector2f( glyph.bounds.left, glyph.bounds.top );
 
-		character_primitive.Clear();
+			vertex0.position = top_left;
+			vertex1.position = top_left + sf::Vector2f( 0.f, glyph.bounds.height );
+			vertex2.position = top_left + sf::Vector2f( glyph.bounds.width, glyph.bounds.height );
+			vertex3.position = top_left + sf::Vector2f( glyph.bounds.width, 0.f );
 
-		character_primitive.AddVertex( vertex0 );
-		character_primitive.AddVertex( vertex1 );
-		character_primitive.AddVertex( vertex2 );
-		character_primitive.AddVertex( vertex2 );
-		character_primitive.AddVertex( vertex1 );
-		character_primitive.AddVertex( vertex3 );
+			vertex0.texture_coordinate = glyph.texture_offset;
+			vertex1.texture_coordinate = glyph.texture_offset + sf::Vector2f( 0.f, glyph.texture_size.y );
+			vertex2.texture_coordinate = glyph.texture_offset + glyph.texture_size;
+			vertex3.texture_coordinate = glyph.texture_offset + sf::Vector2f( glyph.texture_size.x, 0.f );
 
-		primitive->Add( character_primitive );
+			primitive->AddQuad( vertex0, vertex1, vertex2, vertex3 );
+		}
 
-		position.x += static_cast<float>( glyph.advance );
+		pen_position.x += glyph.advance;
 
 		previous_character = current_character;
 	}
 
+	FlushGlyphCopies();
+
 	AddPrimitive( primitive );
 
 	return primitive;
@@ -195,7 +472,8 @@ Primitive::Ptr Renderer::CreateText( const sf::Text& text ) {
 Primitive::Ptr Renderer::CreateQuad( const sf::Vector2f& top_left, const sf::Vector2f& bottom_left,
                                      const sf::Vector2f& bottom_right, const sf::Vector2f& top_right,
                                      const sf::Color& color ) {
-	auto primitive = std::make_shared<Primitive>( 4 );
+	auto primitive = CreatePrimitive();
+	primitive->Reserve( 4, 6 );
 
 	PrimitiveVertex vertex0;
 	PrimitiveVertex vertex1;
@@ -217,12 +495,7 @@ Primitive::Ptr Renderer::CreateQuad( const sf::Vector2f& top_left, const sf::Vec
 	vertex2.texture_coordinate = sf::Vector2f( 1.f, 0.f );
 	vertex3.texture_coordinate = sf::Vector2f( 1.f, 1.f );
 
-	primitive->AddVertex( vertex0 );
-	primitive->AddVertex( vertex1 );
-	primitive->AddVertex( vertex2 );
-	primitive->AddVertex( vertex2 );
-	primitive->AddVertex( vertex1 );
-	primitive->AddVertex( vertex3 );
+	primitive->AddQuad( vertex0, vertex1, vertex3, vertex2 );
 
 	AddPrimitive( primitive );
 
@@ -235,7 +508,9 @@ Primitive::Ptr Renderer::CreatePane( const sf::Vector2f& position, const sf::Vec
 		return CreateRect( position, position + size, color );
 	}
 
-	auto primitive = std::make_shared<Primitive>( 20 );
+	// 1 fill quad and 4 border quads.
+	auto primitive = CreatePrimitive();
+	primitive->Reserve( 20, 30 );
 
 	sf::Color dark_border( border_color );
 	sf::Color light_border( border_color );
@@ -270,12 +545,7 @@ Primitive::Ptr Renderer::CreatePane( const sf::Vector2f& position, const sf::Vec
 		vertex2.texture_coordinate = sf::Vector2f( 1.f, 0.f );
 		vertex3.texture_coordinate = sf::Vector2f( 1.f, 1.f );
 
-		primitive->AddVertex( vertex0 );
-		primitive->AddVertex( vertex1 );
-		primitive->AddVertex( vertex2 );
-		primitive->AddVertex( vertex2 );
-		primitive->AddVertex( vertex1 );
-		primitive->AddVertex( vertex3 );
+		primitive->AddQuad( vertex0, vertex1, vertex3, vertex2 );
 	};
 
 	auto add_line = [&add_quad]( const sf::Vector2f& begin, const sf::Vector2f& end, const sf::Color& line_color, float thickness ) {
@@ -357,7 +627,8 @@ Primitive::Ptr Renderer::CreateRect( const sf::FloatRect& rect, const sf::Color&
 }
 
 Primitive::Ptr Renderer::CreateTriangle( const sf::Vector2f& point0, const sf::Vector2f& point1, const sf::Vector2f& point2, const sf::Color& color ) {
-	auto primitive = std::make_shared<Primitive>( 3 );
+	auto primitive = CreatePrimitive();
+	primitive->Reserve( 3, 3 );
 
 	PrimitiveVertex vertex0;
 	PrimitiveVertex vertex1;
@@ -375,9 +646,11 @@ Primitive::Ptr Renderer::CreateTriangle( const sf::Vector2f& point0, const sf::V
 	vertex1.texture_coordinate = sf::Vector2f( 0.f, 1.f );
 	vertex2.texture_coordinate = sf::Vector2f( 1.f, 0.f );
 
-	primitive->AddVertex( vertex0 );
-	primitive->AddVertex( vertex1 );
-	primitive->AddVertex( vertex2 );
+	auto index0 = primitive->AddUnindexedVertex( vertex0 );
+	auto index1 = primitive->AddUnindexedVertex( vertex1 );
+	auto index2 = primitive->AddUnindexedVertex( vertex2 );
+
+	primitive->AddTriangleIndexed( index0, index1, index2 );
 
 	AddPrimitive( primitive );
 
@@ -387,7 +660,8 @@ Primitive::Ptr Renderer::CreateTriangle( const sf::Vector2f& point0, const sf::V
 Primitive::Ptr Renderer::CreateSprite( const sf::FloatRect& rect, PrimitiveTexture::Ptr texture, const sf::FloatRect& subrect, int rotation_turns ) {
 	auto offset = texture->offset;
 
-	auto primitive = std::make_shared<Primitive>( 4 );
+	auto primitive = CreatePrimitive();
+	primitive->Reserve( 4, 6 );
 
 	PrimitiveVertex vertex0;
 	PrimitiveVertex vertex1;
@@ -436,12 +710,7 @@ Primitive::Ptr Renderer::CreateSprite( const sf::FloatRect& rect, PrimitiveTextu
 	vertex2.texture_coordinate = coords[1];
 	vertex3.texture_coordinate = coords[2];
 
-	primitive->AddVertex( vertex0 );
-	primitive->AddVertex( vertex1 );
-	primitive->AddVertex( vertex2 );
-	primitive->AddVertex( vertex2 );
-	primitive->AddVertex( vertex1 );
-	primitive->AddVertex( vertex3 );
+	primitive->AddQuad( vertex0, vertex1, vertex3, vertex2 );
 
 	primitive->AddTexture( texture );
 
@@ -459,7 +728,7 @@ Primitive::Ptr Renderer::CreateLine( const sf::Vector2f& begin, const sf::Vector
 	auto length = std::sqrt( normal.x * normal.x + normal.y * normal.y );
 
 	if( !( length > 0.f ) ) {
-		return std::make_shared<Primitive>();
+		return CreatePrimitive();
 	}
 
 	normal.x /= -length;
@@ -476,12 +745,59 @@ Primitive::Ptr Renderer::CreateLine( const sf::Vector2f& begin, const sf::Vector
 }
 
 Primitive::Ptr Renderer::CreateGLCanvas( std::shared_ptr<Signal> callback ) {
-	auto primitive = std::make_shared<Primitive>();
+	auto primitive = CreatePrimitive();
 	primitive->SetCustomDrawCallback( callback );
 	AddPrimitive( primitive );
 	return primitive;
 }
 
+bool Renderer::RecolorPane( Primitive& primitive, const sf::Color& color, const sf::Color& border_color, int border_color_shift ) {
+	auto& vertices = primitive.GetVertices();
+
+	// Without a border only the fill quad is left.
+	if( vertices.size() == 4 ) {
+		RecolorPrimitive( primitive, color );
+
+		return true;
+	}
+
+	// CreatePane skips border quads of zero length,
+	// only a complete border can be told apart.
+	if( vertices.size() != 20 ) {
+		return false;
+	}
+
+	sf::Color dark_border( border_color );
+	sf::Color light_border( border_color );
+
+	Context::Get().GetEngine().ShiftBorderColors( light_border, dark_border, border_color_shift );
+
+	// Fill quad, then top, right, bottom and left border quads.
+	const sf::Color quad_colors[] = { color, light_border, dark_border, dark_border, light_border };
+
+	for( std::size_t index = 0; index < vertices.size(); ++index ) {
+		vertices[index].color = quad_colors[index / 4];
+	}
+
+	primitive.SetSynced( false );
+	DamagePrimitive( primitive );
+
+	Invalidate( INVALIDATE_COLOR );
+
+	return true;
+}
+
+void Renderer::RecolorPrimitive( Primitive& primitive, const sf::Color& color ) {
+	for( auto& vertex : primitive.GetVertices() ) {
+		vertex.color = color;
+	}
+
+	primitive.SetSynced( false );
+	DamagePrimitive( primitive );
+
+	Invalidate( INVALIDATE_COLOR );
+}
+
 void Renderer::WipeStateCache( sf::RenderTarget& target ) const {
 	// Make SFML disable it's **************** vertex cache without us
 	// having to call ResetGLStates() and disturbing OpenGL needlessly.
@@ -524,53 +840,13 @@ void Renderer::WipeStateCache( sf::RenderTarget& target ) const {
 
 /// @cond
 
-sf::Vector2f Renderer::LoadFont( const sf::Font& font, unsigned int size ) {
-	// Get the font face that Laurent tries to hide from us.
-	struct FontStruct {
-		void* library;
-		void* font_face; // Authentic SFML comment: implementation details
-		void* unused1;
-		void* unused2;
-		int* unused3;
-		std::string family;
-
-		// Since maps allocate everything non-contiguously on the heap we can use void* instead of Page here.
-		mutable std::map<unsigned int, void*> unused4;
-		mutable std::vector<sf::Uint8> unused5;
-	};
-
-	// All your font face are belong to us too.
-	void* face = reinterpret_cast<const FontStruct&>( font ).font_face;
-
-	FontID id( face, size );
-
-	std::map<FontID, PrimitiveTexture::Ptr >::iterator iter( m_fonts.find( id ) );
-
-	if( iter != m_fonts.end() ) {
-		return iter->second->offset;
-	}
-
-	// If the user does not specify their own character sets, make sure all the glyphs we need are loaded.
-	if( m_character_sets.empty() ) {
-		for( sf::Uint32 codepoint = 0; codepoint < 0x0370; ++codepoint ) {
-			font.getGlyph( codepoint, size, false );
-		}
-	}
-
-	// Make a local copy to avoid unnecessary dereferencing.
-	for( const auto character_set : m_character_sets ) {
-		for( auto codepoint = character_set.first; codepoint < character_set.second; ++codepoint ) {
-			font.getGlyph( codepoint, size, false );
-		}
-	}
-
-	const auto image = font.getTexture( size ).copyToImage();
+sf::Vector2f Renderer::LoadGlyph( const sf::Font& font, sf::Uint32 codepoint, unsigned int size ) {
+	auto& table = GetGlyphTable( font, size );
+	const auto& texture_offset = table.glyphs[GetGlyphIndex( table, font, codepoint, size )].texture_offset;
 
-	const auto handle = LoadTexture( image );
+	FlushGlyphCopies();
 
-	m_fonts[id] = handle;
-
-	return handle->offset;
+	return texture_offset;
 }
 
 PrimitiveTexture::Ptr Renderer::LoadTexture( const sf::Texture& texture ) {
@@ -578,231 +854,1014 @@ PrimitiveTexture::Ptr Renderer::LoadTexture( const sf::Texture& texture ) {
 }
 
 PrimitiveTexture::Ptr Renderer::LoadTexture( const sf::Image& image ) {
-	// We insert padding between atlas elements to prevent
-	// texture filtering from screwing up our images.
-	// If 1 pixel isn't enough, increase.
-	const static auto padding = 1;
-
-	auto required_vertical_size = static_cast<int>( image.getSize().y ) + padding;
-	auto required_horizontal_size = static_cast<int>( image.getSize().x );
+	const auto required_size = static_cast<sf::Vector2i>( image.getSize() ) + sf::Vector2i( atlas_padding, atlas_padding );
 
-	if( ( required_horizontal_size > max_texture_size ) || ( required_vertical_size > static_cast<int>( max_texture_size ) ) ) {
+	if( ( required_size.x > max_texture_size ) || ( required_size.y > max_texture_size ) ) {
 #if defined( SFGUI_DEBUG )
-		std::cerr << "SFGUI warning: The image you are using is larger than the maximum size supported by your GPU (" << max_texture_size << "x" << max_texture_size << ").\n";
+		std::cerr << "SFGUI warning: The image you are using is larger than the maximum atlas page size supported by your GPU (" << max_texture_size << "x" << max_texture_size << ").\n";
 #endif
 		return std::make_shared<PrimitiveTexture>();
 	}
 
-	// Look for a nice insertion point for our new texture.
-	// We use first fit and according to theory it is never
-	// worse than double the optimum size.
-	auto texture_iter = m_textures.begin();
+	// Widgets like ListBox and Image reload the same images every time
+	// they are invalidated, hand out the texture that is already there.
+	const auto hashes = GetImageHash( image );
+	auto cache_iter = m_texture_cache.find( hashes.first );
 
-	auto atlas_last_occupied_location = 0;
+	if( cache_iter != m_texture_cache.end() ) {
+		auto& cached_node = m_textures[cache_iter->second];
 
-	for( ; texture_iter != m_textures.end(); ++texture_iter ) {
-		auto space_available = texture_iter->offset.y - atlas_last_occupied_location;
+		// Different images can end up with the same hash. Without keeping
+		// their pixels around, the second hash and the size tell them apart.
+		if( ( cached_node.check_hash == hashes.second ) && ( cached_node.size == required_size ) ) {
+			++cached_node.references;
 
-		if( space_available >= required_vertical_size ) {
-			// We found a nice spot.
-			break;
-		}
+			auto handle = std::make_shared<PrimitiveTexture>();
 
-		atlas_last_occupied_location = texture_iter->offset.y + texture_iter->size.y;
-	}
+			handle->offset = static_cast<sf::Vector2f>( cached_node.offset );
+			handle->size = image.getSize();
 
-	auto current_page_index = atlas_last_occupied_location / max_texture_size;
-	auto current_page_last_occupied_location = atlas_last_occupied_location % max_texture_size;
+			return handle;
+		}
+	}
 
-	// Cache the "temporary" sf::Image so its internal std::vector
-	// does not have to constantly be allocated anew.
-	static sf::Image new_image;
+	auto page_index = std::size_t( 0 );
+	auto position = AllocateAtlasSpace( required_size, page_index );
 
-	if( m_texture_atlas.empty() || ( current_page_last_occupied_location + required_vertical_size > max_texture_size ) ) {
-		// We need a new atlas page.
+	UpdateAtlas( page_index, image, position );
 
-		auto new_texture = std::unique_ptr<sf::Texture>( new sf::Texture );
+	InvalidateAtlasImpl( page_index, sf::IntRect( position, static_cast<sf::Vector2i>( image.getSize() ) ) );
 
-		// Protection against possible broken cards that don't like huge textures.
-		// Disable if having issues.
-		static auto create_maximal = true;
+	auto offset = sf::Vector2i( position.x, static_cast<int>( page_index ) * max_texture_size + position.y );
 
-		if( create_maximal ) {
-			if( !new_texture->create( 1u, static_cast<unsigned int>( max_texture_size ) ) ) {
-				create_maximal = false;
-			}
-		}
+	Invalidate( INVALIDATE_TEXTURE );
 
-		if( !create_maximal && !m_texture_atlas.empty() ) {
-			// Make sure the current page vertical size is maximal
-			// so we can compute the right page from y texture coordinate.
-			auto current_page = m_texture_atlas[static_cast<std::size_t>( current_page_index )].get();
-			auto old_image = current_page->copyToImage();
+	auto handle = std::make_shared<PrimitiveTexture>();
 
-			new_image.create( old_image.getSize().x, static_cast<unsigned int>( max_texture_size ), sf::Color::White );
-			new_image.copy( old_image, 0u, 0u );
-			new_image.copy( image, 0u, static_cast<unsigned int>( current_page_last_occupied_location ) );
+	handle->offset = static_cast<sf::Vector2f>( offset );
+	handle->size = image.getSize();
 
-			current_page->loadFromImage( new_image );
-		}
+	priv::RendererTextureNode texture_node;
+	texture_node.offset = offset;
+	texture_node.size = required_size;
+	texture_node.references = 1;
 
-		// Insert the new page.
-		m_texture_atlas.push_back( std::move( new_texture ) );
+	// On a hash collision the image that was cached first keeps its entry.
+	if( cache_iter == m_texture_cache.end() ) {
+		texture_node.hash = hashes.first;
+		texture_node.check_hash = hashes.second;
+		texture_node.cached = true;
 
-		current_page_index = static_cast<int>( m_texture_atlas.size() ) - 1;
-		current_page_last_occupied_location = 0;
+		m_texture_cache[hashes.first] = GetTextureKey( offset );
 	}
 
-	auto current_page = m_texture_atlas[static_cast<std::size_t>( current_page_index )].get();
-	auto current_page_size_x = static_cast<int>( current_page->getSize().x );
-	auto current_page_size_y = static_cast<int>( current_page->getSize().y );
+	m_textures[GetTextureKey( offset )] = texture_node;
+
+	return handle;
+}
 
-	if( ( required_horizontal_size > current_page_size_x ) || ( current_page_last_occupied_location + required_vertical_size > current_page_size_y ) ) {
-		// Image is loaded into atlas after expanding texture atlas.
-		auto old_image = current_page->copyToImage();
+priv::RendererGlyphTable& Renderer::GetGlyphTable( const sf::Font& font, unsigned int size ) {
+	FontID id( GetFontFace( font ), size );
 
-		new_image.create( static_cast<unsigned int>( std::max( current_page_size_x, required_horizontal_size ) ), static_cast<unsigned int>( std::max( current_page_size_y, current_page_last_occupied_location + required_vertical_size ) ), sf::Color::White );
-		new_image.copy( old_image, 0u, 0u );
-		new_image.copy( image, 0u, static_cast<unsigned int>( current_page_last_occupied_location ) );
+	auto iter = m_fonts.find( id );
 
-		current_page->loadFromImage( new_image );
-	}
-	else {
-		// Image is loaded into atlas.
-		current_page->update( image, 0u, static_cast<unsigned int>( current_page_last_occupied_location ) );
+	if( iter != m_fonts.end() ) {
+		return iter->second;
 	}
 
-	auto offset = sf::Vector2i( 0, current_page_index * max_texture_size + current_page_last_occupied_location );
+	auto& table = m_fonts[id];
 
-	Invalidate( INVALIDATE_TEXTURE );
+	table.direct_index.resize( direct_glyph_count, 0 );
+	table.line_height = static_cast<float>( Context::Get().GetEngine().GetFontLineHeight( font, size ) );
+	table.space_advance = font.getGlyph( L' ', size, false ).advance;
 
-	auto handle = std::make_shared<PrimitiveTexture>();
+	// Glyphs of character sets the user asked for are loaded up front,
+	// everything else as soon as text makes use of it.
+	for( const auto& character_set : m_character_sets ) {
+		for( auto character = character_set.first; character < character_set.second; ++character ) {
+			GetGlyphIndex( table, font, character, size );
+		}
+	}
 
-	handle->offset = static_cast<sf::Vector2f>( offset );
-	handle->size = image.getSize();
+	return table;
+}
 
-	priv::RendererTextureNode texture_node;
-	texture_node.offset = offset;
-	texture_node.size = static_cast<sf::Vector2i>( image.getSize() ) + sf::Vector2i( 0, padding );
+std::size_t Renderer::GetGlyphIndex( priv::RendererGlyphTable& table, const sf::Font& font, sf::Uint32 codepoint, unsigned int size ) {
+	auto& index = ( codepoint < table.direct_index.size() ) ? table.direct_index[codepoint] : table.indirect_index[codepoint];
 
-	m_textures.insert( texture_iter, texture_node );
+	if( index ) {
+		return index - 1;
+	}
 
-	return handle;
-}
+	// Rasterizes the glyph into SFML's font page if it isn't there yet.
+	const auto& font_glyph = font.getGlyph( codepoint, size, false );
+	const auto glyph_size = sf::Vector2i( font_glyph.textureRect.width, font_glyph.textureRect.height );
+	const auto required_size = glyph_size + sf::Vector2i( atlas_padding, atlas_padding );
 
-void Renderer::UnloadImage( const sf::Vector2f& offset ) {
-	sf::Vector2i int_offset( static_cast<int>( std::floor( offset.x + .5f ) ), static_cast<int>( std::floor( offset.y + .5f ) ) );
-	for( auto iter = m_textures.begin(); iter != m_textures.end(); ++iter ) {
-		if( iter->offset == int_offset ) {
-			m_textures.erase( iter );
-			return;
-		}
+	priv::RendererGlyph glyph;
+	glyph.bounds = font_glyph.bounds;
+	glyph.advance = font_glyph.advance;
+
+	// Whitespace has nothing to draw and oversized glyphs
+	// don't fit into the atlas, the pseudo-texture will do.
+	if( !glyph_size.x || !glyph_size.y || ( required_size.x > max_texture_size ) || ( required_size.y > max_texture_size ) ) {
+		glyph.texture_offset = m_pseudo_texture->offset;
 	}
+	else {
+		auto page_index = std::size_t( 0 );
+		auto position = AllocateAtlasSpace( required_size, page_index );
 
-// Only enable during development.
-//#if defined( SFGUI_DEBUG )
-//	std::cerr << "Tried to unload non-existant image at (" << offset.x << "," << offset.y << ").\n";
-//#endif
-}
+		CopyGlyph( font.getTexture( size ), font_glyph.textureRect, page_index, position );
 
-void Renderer::UpdateImage( const sf::Vector2f& offset, const sf::Image& data ) {
-	// We insert padding between atlas elements to prevent
-	// texture filtering from screwing up our images.
-	// If 1 pixel isn't enough, increase.
-	const static auto padding = 1;
+		InvalidateAtlasImpl( page_index, sf::IntRect( position, glyph_size ) );
 
-	sf::Vector2i int_offset( static_cast<int>( std::floor( offset.x + .5f ) ), static_cast<int>( std::floor( offset.y + .5f ) ) );
-	sf::Vector2i int_size( static_cast<sf::Vector2i>( data.getSize() ) + sf::Vector2i( 0, padding ) );
+		auto offset = sf::Vector2i( position.x, static_cast<int>( page_index ) * max_texture_size + position.y );
 
-	for( const auto& texture : m_textures ) {
-		if( texture.offset == int_offset ) {
-			if( texture.size != int_size ) {
-#if defined( SFGUI_DEBUG )
-				std::cerr << "Tried to update texture with mismatching image size.\n";
-#endif
-				return;
-			}
+		Invalidate( INVALIDATE_TEXTURE );
 
-			auto page = static_cast<std::size_t>( int_offset.y / max_texture_size );
+		// Glyphs stay in the atlas for as long as the renderer lives.
+		priv::RendererTextureNode texture_node;
+		texture_node.offset = offset;
+		texture_node.size = required_size;
 
-			m_texture_atlas[page]->update( data, 0u, static_cast<unsigned int>( int_offset.y % max_texture_size ) );
+		m_textures[GetTextureKey( offset )] = texture_node;
 
-			return;
-		}
+		glyph.texture_offset = static_cast<sf::Vector2f>( offset );
+		glyph.texture_size = static_cast<sf::Vector2f>( glyph_size );
 	}
 
-// Only enable during development.
-//#if defined( SFGUI_DEBUG )
-//	std::cerr << "Tried to update non-existant image at (" << offset.x << "," << offset.y << ").\n";
-//#endif
+	table.glyphs.push_back( glyph );
+	index = static_cast<std::uint32_t>( table.glyphs.size() );
+
+	return table.glyphs.size() - 1;
 }
 
-/// @endcond
+sf::Vector2i Renderer::AllocateAtlasSpace( const sf::Vector2i& size, std::size_t& page_index ) {
+	// Try to fit the image into one of the existing pages
+	// and only open up a new page if none of them has room.
+	page_index = 0;
+	sf::Vector2i position;
 
-void Renderer::SortPrimitives() {
-	if( m_primitives_sorted ) {
-		return;
+	for( ; page_index < m_atlas_pages.size(); ++page_index ) {
+		if( AllocateAtlasRect( m_atlas_pages[page_index], size, position ) ) {
+			break;
+		}
 	}
 
-	std::size_t current_position = 1;
-	std::size_t sort_index;
-
-	auto primitives_size = m_primitives.size();
+	if( page_index == m_atlas_pages.size() ) {
+		priv::RendererAtlasPage page;
+		page.free_rects.emplace_back( 0, 0, max_texture_size, max_texture_size );
 
-	// Classic insertion sort.
-	while( current_position < primitives_size ) {
-		sort_index = current_position++;
+		m_atlas_pages.push_back( page );
+		m_texture_atlas.push_back( std::unique_ptr<sf::Texture>( new sf::Texture ) );
 
-		while( ( sort_index > 0 ) && ( m_primitives[sort_index - 1]->GetLayer() * 1048576 + m_primitives[sort_index - 1]->GetLevel() > m_primitives[sort_index]->GetLayer() * 1048576 + m_primitives[sort_index]->GetLevel() ) ) {
-			m_primitives[sort_index].swap( m_primitives[sort_index - 1] );
-			--sort_index;
+		if( m_keep_atlas_images ) {
+			m_atlas_images.emplace_back();
 		}
-	}
 
-	m_primitives_sorted = true;
-}
+		auto allocated = AllocateAtlasRect( m_atlas_pages.back(), size, position );
 
-void Renderer::AddPrimitive( Primitive::Ptr primitive ) {
-	m_primitives.push_back( primitive );
+		assert( allocated );
+		static_cast<void>( allocated );
+	}
 
-	// Check for alpha values in primitive.
-	// Disable depth test if any found.
-	const std::vector<PrimitiveVertex>& vertices( primitive->GetVertices() );
-	const std::vector<unsigned int>& indices( primitive->GetIndices() );
+	const auto& page = m_atlas_pages[page_index];
+	auto texture_size = m_texture_atlas[page_index]->getSize();
 
-	m_vertex_count += static_cast<int>( vertices.size() );
-	m_index_count += static_cast<int>( indices.size() );
+	if( ( static_cast<unsigned int>( page.extent.x ) > texture_size.x ) || ( static_cast<unsigned int>( page.extent.y ) > texture_size.y ) ) {
+		// Grow the page to cover the used extent. Rounding up to powers of two
+		// means we only rarely have to pay for copying the old contents over.
+		texture_size.x = std::max( texture_size.x, std::min( GetNextPowerOfTwo( static_cast<unsigned int>( page.extent.x ) ), static_cast<unsigned int>( max_texture_size ) ) );
+		texture_size.y = std::max( texture_size.y, std::min( GetNextPowerOfTwo( static_cast<unsigned int>( page.extent.y ) ), static_cast<unsigned int>( max_texture_size ) ) );
 
-	m_primitives_sorted = false;
+		ResizeAtlasPage( page_index, texture_size );
+	}
 
-	Invalidate( INVALIDATE_ALL );
+	return position;
 }
 
-void Renderer::RemovePrimitive( Primitive::Ptr primitive ) {
-	std::vector<Primitive::Ptr>::iterator iter( std::find( m_primitives.begin(), m_primitives.end(), primitive ) );
+void Renderer::CopyGlyph( const sf::Texture& source, const sf::IntRect& source_rect, std::size_t page, const sf::Vector2i& position ) {
+	// Copies of the atlas pages need the glyph's pixels anyway.
+	if( framebuffer_supported && !m_keep_atlas_images ) {
+		// Copy the glyph straight from SFML's font page into the atlas page.
+		// Framebuffers aren't shared between contexts, so don't keep it around.
+		GLuint frame_buffer = 0;
+
+		auto old_frame_buffer = 0u;
+		auto old_texture_id = 0u;
 
-	if( iter != m_primitives.end() ) {
-		const std::vector<PrimitiveVertex>& vertices( (*iter)->GetVertices() );
-		const std::vector<unsigned int>& indices( (*iter)->GetIndices() );
+		CheckGLError( glGetIntegerv( GLEXT_GL_FRAMEBUFFER_BINDING, reinterpret_cast<GLint*>( &old_frame_buffer ) ) );
+		CheckGLError( glGetIntegerv( GL_TEXTURE_BINDING_2D, reinterpret_cast<GLint*>( &old_texture_id ) ) );
 
-		assert( m_vertex_count >= static_cast<int>( vertices.size() ) );
-		assert( m_index_count >= static_cast<int>( indices.size() ) );
+		CheckGLError( GLEXT_glGenFramebuffers( 1, &frame_buffer ) );
+		CheckGLError( GLEXT_glBindFramebuffer( GLEXT_GL_FRAMEBUFFER, frame_buffer ) );
+		CheckGLError( GLEXT_glFramebufferTexture2D( GLEXT_GL_FRAMEBUFFER, GLEXT_GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, source.getNativeHandle(), 0 ) );
 
-		m_vertex_count -= static_cast<int>( vertices.size() );
-		m_index_count -= static_cast<int>( indices.size() );
+		CheckGLError( glBindTexture( GL_TEXTURE_2D, m_texture_atlas[page]->getNativeHandle() ) );
+		CheckGLError( glCopyTexSubImage2D( GL_TEXTURE_2D, 0, position.x, position.y, source_rect.left, source_rect.top, source_rect.width, source_rect.height ) );
 
-		m_primitives.erase( iter );
+		CheckGLError( glBindTexture( GL_TEXTURE_2D, old_texture_id ) );
+		CheckGLError( GLEXT_glBindFramebuffer( GLEXT_GL_FRAMEBUFFER, old_frame_buffer ) );
+		CheckGLError( GLEXT_glDeleteFramebuffers( 1, &frame_buffer ) );
+
+		return;
 	}
 
-	Invalidate( INVALIDATE_ALL );
-}
+	// Otherwise the font page has to be read back,
+	// do that once for all the glyphs a text needs.
+	priv::RendererGlyphCopy copy;
+	copy.source = &source;
+	copy.source_rect = source_rect;
+	copy.page = page;
+	copy.position = position;
 
-void Renderer::Invalidate( unsigned char datasets ) {
-	InvalidateImpl( datasets );
+	m_pending_glyph_copies.push_back( copy );
+}
+
+void Renderer::FlushGlyphCopies() {
+	if( m_pending_glyph_copies.empty() ) {
+		return;
+	}
+
+	// Cache the "temporary" sf::Images so their internal std::vectors
+	// do not have to constantly be allocated anew.
+	static sf::Image source_image;
+	static sf::Image glyph_image;
+
+	// Group the glyphs by font page, each page is read back once.
+	std::sort( m_pending_glyph_copies.begin(), m_pending_glyph_copies.end(), []( const priv::RendererGlyphCopy& left, const priv::RendererGlyphCopy& right ) {
+		return std::less<const sf::Texture*>()( left.source, right.source );
+	} );
+
+	const sf::Texture* source = nullptr;
+
+	for( const auto& copy : m_pending_glyph_copies ) {
+		if( copy.source != source ) {
+			source = copy.source;
+			source_image = source->copyToImage();
+		}
+
+		glyph_image.create( static_cast<unsigned int>( copy.source_rect.width ), static_cast<unsigned int>( copy.source_rect.height ) );
+		glyph_image.copy( source_image, 0u, 0u, copy.source_rect );
+
+		UpdateAtlas( copy.page, glyph_image, copy.position );
+	}
+
+	m_pending_glyph_copies.clear();
+}
+
+void Renderer::UpdateAtlas( std::size_t page, const sf::Image& image, const sf::Vector2i& position ) {
+	m_texture_atlas[page]->update( image, static_cast<unsigned int>( position.x ), static_cast<unsigned int>( position.y ) );
+
+	if( m_keep_atlas_images ) {
+		m_atlas_images[page].copy( image, static_cast<unsigned int>( position.x ), static_cast<unsigned int>( position.y ) );
+	}
+}
+
+void Renderer::ResizeAtlasPage( std::size_t page, const sf::Vector2u& size ) {
+	// Cache the "temporary" sf::Image so its internal std::vector
+	// does not have to constantly be allocated anew.
+	static sf::Image new_image;
+
+	auto texture = m_texture_atlas[page].get();
+
+	new_image.create( size.x, size.y, sf::Color::White );
+
+	if( m_keep_atlas_images ) {
+		// The copy has the old contents, no need to read them back.
+		new_image.copy( m_atlas_images[page], 0u, 0u );
+		m_atlas_images[page] = new_image;
+	}
+	else if( texture->getSize().x && texture->getSize().y ) {
+		new_image.copy( texture->copyToImage(), 0u, 0u );
+	}
+
+	texture->loadFromImage( new_image );
+
+	InvalidateAtlasImpl( page, sf::IntRect( 0, 0, static_cast<int>( size.x ), static_cast<int>( size.y ) ) );
+}
+
+void Renderer::UnloadImage( const sf::Vector2f& offset ) {
+	auto int_offset = GetTextureOffset( offset );
+	auto iter = m_textures.find( GetTextureKey( int_offset ) );
+
+	if( iter == m_textures.end() ) {
+// Only enable during development.
+//#if defined( SFGUI_DEBUG )
+//	std::cerr << "Tried to unload non-existant image at (" << offset.x << "," << offset.y << ").\n";
+//#endif
+		return;
+	}
+
+	// Other handles still share the atlas space.
+	if( iter->second.references > 1 ) {
+		--iter->second.references;
+		return;
+	}
+
+	auto page = static_cast<std::size_t>( int_offset.y / max_texture_size );
+
+	FreeAtlasRect( m_atlas_pages[page], sf::IntRect( int_offset.x, int_offset.y % max_texture_size, iter->second.size.x, iter->second.size.y ) );
+
+	if( iter->second.cached ) {
+		m_texture_cache.erase( iter->second.hash );
+	}
+
+	m_textures.erase( iter );
+}
+
+void Renderer::UpdateImage( const sf::Vector2f& offset, const sf::Image& data ) {
+	auto int_offset = GetTextureOffset( offset );
+	auto int_size = static_cast<sf::Vector2i>( data.getSize() ) + sf::Vector2i( atlas_padding, atlas_padding );
+
+	auto iter = m_textures.find( GetTextureKey( int_offset ) );
+
+	if( iter == m_textures.end() ) {
+// Only enable during development.
+//#if defined( SFGUI_DEBUG )
+//	std::cerr << "Tried to update non-existant image at (" << offset.x << "," << offset.y << ").\n";
+//#endif
+		return;
+	}
+
+	if( iter->second.size != int_size ) {
+#if defined( SFGUI_DEBUG )
+		std::cerr << "Tried to update texture with mismatching image size.\n";
+#endif
+		return;
+	}
+
+	// The contents no longer match the hash they were cached under.
+	if( iter->second.cached ) {
+		m_texture_cache.erase( iter->second.hash );
+		iter->second.cached = false;
+	}
+
+	auto page = static_cast<std::size_t>( int_offset.y / max_texture_size );
+
+	UpdateAtlas( page, data, sf::Vector2i( int_offset.x, int_offset.y % max_texture_size ) );
+
+	InvalidateAtlasImpl( page, sf::IntRect( sf::Vector2i( int_offset.x, int_offset.y % max_texture_size ), static_cast<sf::Vector2i>( data.getSize() ) ) );
+
+	// There is no telling which primitives show the image.
+	Redraw();
+}
+
+bool Renderer::IsImageShared( const sf::Vector2f& offset ) const {
+	auto iter = m_textures.find( GetTextureKey( GetTextureOffset( offset ) ) );
+
+	return ( iter != m_textures.end() ) && ( iter->second.references > 1 );
+}
+
+/// @endcond
+
+std::vector<Renderer::AtlasPageStatistics> Renderer::GetAtlasStatistics() const {
+	std::vector<AtlasPageStatistics> statistics( m_atlas_pages.size() );
+
+	for( const auto& texture : m_textures ) {
+		++statistics[static_cast<std::size_t>( texture.second.offset.y / max_texture_size )].allocation_count;
+	}
+
+	for( std::size_t page_index = 0; page_index < m_atlas_pages.size(); ++page_index ) {
+		const auto& page = m_atlas_pages[page_index];
+		auto& page_statistics = statistics[page_index];
+
+		page_statistics.size = m_texture_atlas[page_index]->getSize();
+		page_statistics.allocated_area = page.allocated_area;
+		page_statistics.free_rect_count = 0;
+		page_statistics.largest_free_area = 0;
+
+		// Free rects span the whole virtual page, only
+		// the part that is backed by the texture counts.
+		sf::IntRect texture_rect( 0, 0, static_cast<int>( page_statistics.size.x ), static_cast<int>( page_statistics.size.y ) );
+		std::size_t free_area = 0;
+
+		for( const auto& free_rect : page.free_rects ) {
+			sf::IntRect intersection;
+
+			if( !texture_rect.intersects( free_rect, intersection ) ) {
+				continue;
+			}
+
+			auto area = static_cast<std::size_t>( intersection.width * intersection.height );
+
+			free_area += area;
+			page_statistics.largest_free_area = std::max( page_statistics.largest_free_area, area );
+			++page_statistics.free_rect_count;
+		}
+
+		auto texture_area = static_cast<std::size_t>( texture_rect.width * texture_rect.height );
+
+		page_statistics.occupancy = texture_area ? static_cast<float>( page.allocated_area ) / static_cast<float>( texture_area ) : 0.f;
+		page_statistics.fragmentation = free_area ? 1.f - static_cast<float>( page_statistics.largest_free_area ) / static_cast<float>( free_area ) : 0.f;
+	}
+
+	return statistics;
+}
+
+void Renderer::SortPrimitives() {
+	if( m_primitives_sorted ) {
+		return;
+	}
+
+	// The ordered index is always up to date, we only
+	// have to flatten it for the renderers to iterate over.
+	m_primitives.clear();
+	m_primitives.reserve( m_primitive_order.size() );
+
+	for( const auto& entry : m_primitive_order ) {
+		m_primitives.push_back( m_primitive_slots[entry.second].primitive );
+	}
+
+	m_primitives_sorted = true;
+
+	// The previous list might have been the last one to
+	// reference unregistered primitives besides the pool.
+	RecyclePrimitives();
+}
+
+Primitive::Ptr Renderer::CreatePrimitive() {
+	if( !m_primitive_pool.empty() ) {
+		auto primitive = std::move( m_primitive_pool.back() );
+		m_primitive_pool.pop_back();
+
+		++m_frame_statistics.recycled_primitive_count;
+
+		return primitive;
+	}
+
+	++m_frame_statistics.created_primitive_count;
+
+	return std::make_shared<Primitive>();
+}
+
+void Renderer::RecyclePrimitives() {
+	for( auto& primitive : m_released_primitives ) {
+		// Primitives somebody else still holds on to aren't ours to reuse,
+		// e.g. ones that are about to be added again.
+		if( primitive.use_count() != 1 ) {
+			continue;
+		}
+
+		if( m_primitive_pool.size() >= max_pooled_primitives ) {
+			break;
+		}
+
+		// Clearing keeps the storage of the vertices and indices around but
+		// releases the textures, their atlas space can be reused right away.
+		primitive->Clear();
+
+		m_primitive_pool.push_back( std::move( primitive ) );
+	}
+
+	m_released_primitives.clear();
+}
+
+priv::RendererPrimitiveSlot* Renderer::GetPrimitiveSlot( const Primitive& primitive ) {
+	// Handles are ( generation << 32 ) | index. A stale handle, e.g. one
+	// that was handed out by a previous renderer, fails the generation check.
+	auto handle = primitive.GetHandle();
+	auto index = static_cast<std::size_t>( handle & 0xffffffffu );
+	auto generation = static_cast<std::uint32_t>( handle >> 32 );
+
+	if( ( index >= m_primitive_slots.size() ) || ( m_primitive_slots[index].generation != generation ) || ( m_primitive_slots[index].primitive.get() != &primitive ) ) {
+		return nullptr;
+	}
+
+	return &m_primitive_slots[index];
+}
+
+void Renderer::AddPrimitive( Primitive::Ptr primitive ) {
+	if( GetPrimitiveSlot( *primitive ) ) {
+		return;
+	}
+
+	std::uint32_t index;
+
+	if( !m_free_primitive_slots.empty() ) {
+		index = m_free_primitive_slots.back();
+		m_free_primitive_slots.pop_back();
+	}
+	else {
+		index = static_cast<std::uint32_t>( m_primitive_slots.size() );
+		m_primitive_slots.emplace_back();
+	}
+
+	auto& slot = m_primitive_slots[index];
+
+	// The sequence number keeps primitives with equal layer
+	// and level in the order they were added in.
+	slot.primitive = primitive;
+	slot.key = PrimitiveKey( GetDepthKey( *primitive ), m_primitive_sequence++ );
+	slot.drawn_viewport.reset();
+	slot.drawn_bounds = sf::FloatRect();
+
+	if( !slot.damaged ) {
+		slot.damaged = true;
+		m_damaged_primitive_slots.push_back( index );
+	}
+
+	m_primitive_order.emplace( slot.key, index );
+
+	primitive->SetHandle( ( static_cast<std::uint64_t>( slot.generation ) << 32 ) | index );
+
+	// Check for alpha values in primitive.
+	// Disable depth test if any found.
+	const std::vector<PrimitiveVertex>& vertices( primitive->GetVertices() );
+	const std::vector<unsigned int>& indices( primitive->GetIndices() );
+
+	m_vertex_count += static_cast<int>( vertices.size() );
+	m_index_count += static_cast<int>( indices.size() );
+
+	m_primitives_sorted = false;
+
+	Invalidate( INVALIDATE_ALL );
+}
+
+bool Renderer::UnregisterPrimitive( Primitive& primitive ) {
+	auto slot = GetPrimitiveSlot( primitive );
+
+	if( !slot ) {
+		return false;
+	}
+
+	const std::vector<PrimitiveVertex>& vertices( primitive.GetVertices() );
+	const std::vector<unsigned int>& indices( primitive.GetIndices() );
+
+	assert( m_vertex_count >= static_cast<int>( vertices.size() ) );
+	assert( m_index_count >= static_cast<int>( indices.size() ) );
+
+	m_vertex_count -= static_cast<int>( vertices.size() );
+	m_index_count -= static_cast<int>( indices.size() );
+
+	m_primitive_order.erase( slot->key );
+
+	AddDamage( GetWindowArea( slot->drawn_bounds, slot->drawn_viewport.get() ) );
+
+	slot->drawn_viewport.reset();
+	slot->damaged = false;
+
+	// Its owners usually let go of it soon, after that it can be reused.
+	m_released_primitives.push_back( slot->primitive );
+
+	// Bump the generation so outstanding handles to this slot become invalid.
+	if( !++slot->generation ) {
+		slot->generation = 1;
+	}
+
+	m_free_primitive_slots.push_back( static_cast<std::uint32_t>( slot - m_primitive_slots.data() ) );
+
+	primitive.SetHandle( 0 );
+
+	// Release the slot's reference last, it might be the final one.
+	slot->primitive.reset();
+
+	m_primitives_sorted = false;
+
+	return true;
+}
+
+void Renderer::RemovePrimitive( Primitive::Ptr primitive ) {
+	UnregisterPrimitive( *primitive );
+
+	Invalidate( INVALIDATE_ALL );
+}
+
+void Renderer::RemovePrimitives( const std::vector<Primitive::Ptr>& primitives ) {
+	auto removed = false;
+
+	for( const auto& primitive : primitives ) {
+		removed = UnregisterPrimitive( *primitive ) || removed;
+	}
+
+	if( removed ) {
+		Invalidate( INVALIDATE_ALL );
+	}
+}
+
+void Renderer::ReorderPrimitive( const Primitive& primitive ) {
+	auto slot = GetPrimitiveSlot( primitive );
+
+	if( !slot ) {
+		return;
+	}
+
+	auto depth_key = GetDepthKey( primitive );
+
+	if( slot->key.first == depth_key ) {
+		return;
+	}
+
+	auto order_iter = m_primitive_order.find( slot->key );
+
+	assert( order_iter != m_primitive_order.end() );
+
+	auto index = order_iter->second;
+	m_primitive_order.erase( order_iter );
+
+	// Whatever overlaps the primitive might now be drawn in a different order.
+	AddDamage( GetWindowArea( slot->drawn_bounds, slot->drawn_viewport.get() ) );
+
+	slot->key.first = depth_key;
+	m_primitive_order.emplace( slot->key, index );
+
+	m_primitives_sorted = false;
+}
+
+void Renderer::DamagePrimitive( const Primitive& primitive ) {
+	auto slot = GetPrimitiveSlot( primitive );
+
+	if( !slot || slot->damaged ) {
+		return;
+	}
+
+	slot->damaged = true;
+	m_damaged_primitive_slots.push_back( static_cast<std::uint32_t>( slot - m_primitive_slots.data() ) );
+}
+
+void Renderer::DamageViewport( const RendererViewport& viewport ) {
+	// Primitives in a viewport that equals the default
+	// one are drawn unclipped, anywhere in the window.
+	if( viewport == *m_default_viewport ) {
+		Redraw();
+		return;
+	}
+
+	AddDamage( sf::FloatRect( viewport.GetDestinationOrigin(), viewport.GetSize() ) );
+}
+
+void Renderer::Invalidate( unsigned char datasets ) {
+	InvalidateImpl( datasets );
 }
 
 void Renderer::Redraw() {
 	m_force_redraw = true;
+
+	for( auto& state : m_target_states ) {
+		state.second.force_redraw = true;
+	}
+}
+
+const Renderer::FrameStatistics& Renderer::GetFrameStatistics() const {
+	return m_last_frame_statistics;
+}
+
+std::vector<Renderer::FrameStatistics> Renderer::GetFrameStatisticsHistory() const {
+	// Once the history is full the oldest entry is the one overwritten next.
+	std::vector<FrameStatistics> history( m_frame_statistics_history.begin() + static_cast<std::ptrdiff_t>( m_frame_statistics_history_position ), m_frame_statistics_history.end() );
+	history.insert( history.end(), m_frame_statistics_history.begin(), m_frame_statistics_history.begin() + static_cast<std::ptrdiff_t>( m_frame_statistics_history_position ) );
+
+	return history;
+}
+
+void Renderer::SetFrameStatisticsHistorySize( std::size_t size ) {
+	auto history = GetFrameStatisticsHistory();
+
+	m_frame_statistics_history_size = std::max( size, std::size_t( 1 ) );
+
+	if( history.size() > m_frame_statistics_history_size ) {
+		history.erase( history.begin(), history.end() - static_cast<std::ptrdiff_t>( m_frame_statistics_history_size ) );
+	}
+
+	m_frame_statistics_history.swap( history );
+	m_frame_statistics_history_position = m_frame_statistics_history.size() % m_frame_statistics_history_size;
+}
+
+void Renderer::BeginFrameStatistics() const {
+	m_frame_statistics.draw_call_count = 0;
+	m_frame_statistics.rebuilt_vertex_count = 0;
+	m_frame_statistics.rebuilt_index_count = 0;
+	m_frame_statistics.uploaded_vertex_bytes = 0;
+	m_frame_statistics.uploaded_index_bytes = 0;
+	m_frame_statistics.uploaded_texture_bytes = 0;
+	m_frame_statistics.refresh_time = sf::Time::Zero;
+	m_frame_statistics.cache_hit = false;
+}
+
+void Renderer::EndFrameStatistics() const {
+	m_frame_statistics.primitive_count = m_primitive_order.size();
+	m_frame_statistics.atlas_page_count = m_atlas_pages.size();
+
+	// Only sums up the areas the atlas already keeps track of,
+	// GetAtlasStatistics() is too expensive to call every frame.
+	std::size_t allocated_area = 0;
+	std::size_t total_area = 0;
+
+	for( std::size_t page = 0; page < m_atlas_pages.size(); ++page ) {
+		const auto size = m_texture_atlas[page]->getSize();
+
+		allocated_area += m_atlas_pages[page].allocated_area;
+		total_area += static_cast<std::size_t>( size.x ) * size.y;
+	}
+
+	m_frame_statistics.atlas_occupancy = total_area ? static_cast<float>( allocated_area ) / static_cast<float>( total_area ) : 0.f;
+
+	m_last_frame_statistics = m_frame_statistics;
+
+	if( m_frame_statistics_history.size() < m_frame_statistics_history_size ) {
+		m_frame_statistics_history.push_back( m_frame_statistics );
+	}
+	else {
+		m_frame_statistics_history[m_frame_statistics_history_position] = m_frame_statistics;
+	}
+
+	m_frame_statistics_history_position = ( m_frame_statistics_history_position + 1 ) % m_frame_statistics_history_size;
+
+	// Primitives are created in between frames, count them until the next one ends.
+	m_frame_statistics.created_primitive_count = 0;
+	m_frame_statistics.recycled_primitive_count = 0;
+}
+
+const sf::IntRect& Renderer::GetDamagedArea() const {
+	return m_damaged_area;
+}
+
+sf::FloatRect Renderer::GetSourceBounds( const Primitive& primitive ) const {
+	if( !primitive.IsVisible() ) {
+		return sf::FloatRect();
+	}
+
+	// Custom draws can touch anything within their viewport.
+	if( primitive.GetCustomDrawCallback() ) {
+		auto viewport = primitive.GetViewport();
+
+		if( !viewport || ( ( *viewport ) == ( *m_default_viewport ) ) ) {
+			return sf::FloatRect( 0.f, 0.f, static_cast<float>( m_window_size.x ), static_cast<float>( m_window_size.y ) );
+		}
+
+		return sf::FloatRect( viewport->GetSourceOrigin(), viewport->GetSize() );
+	}
+
+	const auto& local_bounds = primitive.GetBounds();
+
+	return sf::FloatRect( local_bounds.left + primitive.GetPosition().x, local_bounds.top + primitive.GetPosition().y, local_bounds.width, local_bounds.height );
+}
+
+sf::FloatRect Renderer::GetWindowArea( const sf::FloatRect& bounds, const RendererViewport* viewport ) const {
+	if( !viewport || ( ( *viewport ) == ( *m_default_viewport ) ) ) {
+		return bounds;
+	}
+
+	// The viewport may have scrolled since the bounds were drawn. In that
+	// case it damaged its whole area, which covers them wherever they were.
+	sf::FloatRect viewport_rect( viewport->GetDestinationOrigin(), viewport->GetSize() );
+
+	auto offset = viewport->GetDestinationOrigin() - viewport->GetSourceOrigin();
+
+	sf::FloatRect area;
+
+	viewport_rect.intersects( sf::FloatRect( bounds.left + offset.x, bounds.top + offset.y, bounds.width, bounds.height ), area );
+
+	return area;
+}
+
+void Renderer::AddDamage( const sf::FloatRect& rect ) const {
+	if( ( rect.width <= 0.f ) || ( rect.height <= 0.f ) ) {
+		return;
+	}
+
+	// Every target has to redraw the area the next time it is drawn to.
+	UniteRects( m_pending_damage, rect );
+
+	for( auto& state : m_target_states ) {
+		UniteRects( state.second.pending_damage, rect );
+	}
+}
+
+void Renderer::CollectDamage() {
+	// Scrolling and moving viewports damage their area on their own,
+	// only the primitives that changed themselves have to be looked at.
+	for( auto index : m_damaged_primitive_slots ) {
+		auto& slot = m_primitive_slots[index];
+
+		// Removed in the meantime, its area was damaged then.
+		if( !slot.damaged ) {
+			continue;
+		}
+
+		slot.damaged = false;
+
+		AddDamage( GetWindowArea( slot.drawn_bounds, slot.drawn_viewport.get() ) );
+
+		slot.drawn_viewport = slot.primitive->GetViewport();
+		slot.drawn_bounds = GetSourceBounds( *slot.primitive );
+
+		AddDamage( GetWindowArea( slot.drawn_bounds, slot.drawn_viewport.get() ) );
+	}
+
+	m_damaged_primitive_slots.clear();
+}
+
+void Renderer::SelectTarget( const void* target ) const {
+	if( target == m_current_target ) {
+		return;
+	}
+
+	const auto previous_target = m_current_target;
+
+	if( previous_target ) {
+		auto& state = m_target_states[previous_target];
+		state.last_window_size = m_last_window_size;
+		state.pending_damage = m_pending_damage;
+		state.force_redraw = m_force_redraw;
+	}
+
+	auto iter = m_target_states.find( target );
+
+	if( iter != m_target_states.end() ) {
+		m_last_window_size = iter->second.last_window_size;
+		m_pending_damage = iter->second.pending_damage;
+		m_force_redraw = iter->second.force_redraw;
+
+		m_target_states.erase( iter );
+	}
+	else if( previous_target ) {
+		// Never drawn to, the size mismatch makes sure it is drawn completely.
+		m_last_window_size = sf::Vector2i( 0, 0 );
+		m_pending_damage = sf::FloatRect();
+		m_force_redraw = true;
+	}
+
+	// Otherwise this is the first target, it simply takes
+	// over the state the renderer started out with.
+
+	m_current_target = target;
+
+	SelectTargetImpl( previous_target, target );
+}
+
+void Renderer::UpdateDamagedArea( bool full_redraw ) const {
+	const sf::IntRect window_rect( 0, 0, m_window_size.x, m_window_size.y );
+
+	if( full_redraw ) {
+		m_damaged_area = window_rect;
+	}
+	else {
+		// Round outwards, partially covered pixels changed as well.
+		auto left = static_cast<int>( std::floor( m_pending_damage.left ) );
+		auto top = static_cast<int>( std::floor( m_pending_damage.top ) );
+		auto right = static_cast<int>( std::ceil( m_pending_damage.left + m_pending_damage.width ) );
+		auto bottom = static_cast<int>( std::ceil( m_pending_damage.top + m_pending_damage.height ) );
+
+		m_damaged_area = sf::IntRect();
+
+		if( ( m_pending_damage.width > 0.f ) && ( m_pending_damage.height > 0.f ) ) {
+			window_rect.intersects( sf::IntRect( left, top, right - left, bottom - top ), m_damaged_area );
+		}
+	}
+
+	m_pending_damage = sf::FloatRect();
+}
+
+void Renderer::LayoutPrimitives( bool cull, std::vector<priv::RendererPrimitiveRange>& ranges, std::vector<priv::RendererBatch>& batches, int& vertex_count, int& index_count ) {
+	ranges.clear();
+	batches.clear();
+
+	vertex_count = 0;
+	index_count = 0;
+
+	const sf::FloatRect window_viewport( 0.f, 0.f, static_cast<float>( m_window_size.x ), static_cast<float>( m_window_size.y ) );
+
+	// Gather the visible primitives and where they end up on screen.
+	ranges.reserve( m_primitives.size() );
+
+	for( const auto& primitive_ptr : m_primitives ) {
+		auto primitive = primitive_ptr.get();
+
+		primitive->SetSynced();
+
+		if( !primitive->IsVisible() ) {
+			continue;
+		}
+
+		priv::RendererPrimitiveRange range;
+		range.primitive = primitive;
+		range.position_transform = primitive->GetPosition();
+
+		auto viewport = primitive->GetViewport();
+
+		auto viewport_rect = window_viewport;
+
+		// Check if primitive needs to be rendered in a custom viewport.
+		if( viewport && ( ( *viewport ) != ( *m_default_viewport ) ) ) {
+			auto destination_origin = viewport->GetDestinationOrigin();
+			auto size = viewport->GetSize();
+
+			range.position_transform += ( destination_origin - viewport->GetSourceOrigin() );
+
+			viewport_rect.left = destination_origin.x;
+			viewport_rect.top = destination_origin.y;
+			viewport_rect.width = size.x;
+			viewport_rect.height = size.y;
+		}
+
+		range.atlas_page = GetAtlasPage( *primitive );
+
+		// Primitives keep their bounding box up to date,
+		// culling doesn't have to look at the vertices.
+		if( cull && !primitive->GetCustomDrawCallback() ) {
+			const auto& bounds = primitive->GetBounds();
+
+			range.culled = !viewport_rect.intersects( sf::FloatRect( bounds.left + range.position_transform.x, bounds.top + range.position_transform.y, bounds.width, bounds.height ) );
+		}
+
+		ranges.push_back( range );
+	}
+
+	// Prefix sum over the vertex and index counts of everything that gets
+	// drawn. Batches are split wherever the viewport or atlas page changes.
+	priv::RendererBatch current_batch;
+	current_batch.viewport = m_default_viewport;
+	current_batch.atlas_page = 0;
+	current_batch.start_index = 0;
+	current_batch.index_count = 0;
+	current_batch.min_index = 0;
+	current_batch.max_index = m_vertex_count - 1;
+	current_batch.custom_draw = false;
+
+	m_frame_statistics.visible_primitive_count = 0;
+	m_frame_statistics.culled_primitive_count = 0;
+
+	std::size_t range_count = 0;
+
+	for( const auto& range : ranges ) {
+		const auto primitive = range.primitive;
+		const auto& custom_draw_callback = primitive->GetCustomDrawCallback();
+
+		if( custom_draw_callback ) {
+			++m_frame_statistics.visible_primitive_count;
+
+			// Start a new batch.
+			current_batch.max_index = vertex_count ? ( vertex_count - 1 ) : 0;
+			batches.push_back( current_batch );
+
+			// Mark current_batch custom draw batch.
+			current_batch.viewport = primitive->GetViewport();
+			current_batch.start_index = 0;
+			current_batch.index_count = 0;
+			current_batch.min_index = 0;
+			current_batch.max_index = 0;
+			current_batch.custom_draw = true;
+			current_batch.custom_draw_callback = custom_draw_callback;
+
+			// Start a new batch.
+			batches.push_back( current_batch );
+
+			// Reset current_batch to defaults.
+			current_batch.viewport = m_default_viewport;
+			current_batch.start_index = index_count;
+			current_batch.index_count = 0;
+			current_batch.min_index = vertex_count ? ( vertex_count - 1 ) : 0;
+			current_batch.custom_draw = false;
+			current_batch.custom_draw_callback.reset();
+
+			continue;
+		}
+
+		if( range.culled ) {
+			++m_frame_statistics.culled_primitive_count;
+
+			continue;
+		}
+
+		++m_frame_statistics.visible_primitive_count;
+
+		const auto& viewport = primitive->GetViewport();
+
+		// Check if we need to start a new batch.
+		if( ( ( *viewport ) != ( *current_batch.viewport ) ) || ( range.atlas_page != current_batch.atlas_page ) ) {
+			current_batch.max_index = vertex_count ? ( vertex_count - 1 ) : 0;
+			batches.push_back( current_batch );
+
+			// Reset current_batch to defaults.
+			current_batch.viewport = viewport;
+			current_batch.atlas_page = range.atlas_page;
+			current_batch.start_index = index_count;
+			current_batch.index_count = 0;
+			current_batch.min_index = vertex_count ? ( vertex_count - 1 ) : 0;
+			current_batch.custom_draw = false;
+		}
+
+		const auto primitive_index_count = static_cast<int>( primitive->GetIndices().size() );
+
+		current_batch.index_count += primitive_index_count;
+
+		// Only keep the ranges that have to be filled in.
+		auto& kept_range = ranges[range_count++];
+		kept_range = range;
+		kept_range.vertex_offset = static_cast<std::size_t>( vertex_count );
+		kept_range.index_offset = static_cast<std::size_t>( index_count );
+
+		vertex_count += static_cast<int>( primitive->GetVertices().size() );
+		index_count += primitive_index_count;
+	}
+
+	ranges.resize( range_count );
+
+	current_batch.max_index = vertex_count ? ( vertex_count - 1 ) : 0;
+	batches.push_back( current_batch );
+
+	m_frame_statistics.batch_count = batches.size();
 }
 
 const sf::Vector2i& Renderer::GetWindowSize() const {
@@ -820,8 +1879,63 @@ void Renderer::AddCharacterSet( sf::Uint32 low_bound, sf::Uint32 high_bound ) {
 void Renderer::InvalidateImpl( unsigned char /*datasets*/ ) {
 }
 
+void Renderer::InvalidateAtlasImpl( std::size_t /*page*/, const sf::IntRect& /*rect*/ ) {
+}
+
+void Renderer::SelectTargetImpl( const void* /*previous_target*/, const void* /*target*/ ) const {
+}
+
+void Renderer::ForgetTarget( sf::Window& target ) {
+	target.setActive( true );
+
+	ForgetTargetState( &target );
+}
+
+void Renderer::ForgetTarget( sf::RenderWindow& target ) {
+	target.setActive( true );
+
+	ForgetTargetState( &target );
+}
+
+void Renderer::ForgetTarget( sf::RenderTexture& target ) {
+	target.setActive( true );
+
+	ForgetTargetState( &target );
+}
+
+void Renderer::ForgetTargetState( const void* target ) {
+	const auto current = ( target == m_current_target );
+
+	ForgetTargetImpl( target, current );
+
+	if( !current ) {
+		m_target_states.erase( target );
+
+		return;
+	}
+
+	// The next target drawn to takes over the renderer's state, start it from scratch.
+	m_current_target = nullptr;
+	m_last_window_size = sf::Vector2i( 0, 0 );
+	m_pending_damage = sf::FloatRect();
+	m_force_redraw = true;
+}
+
+void Renderer::ForgetTargetImpl( const void* /*target*/, bool /*current*/ ) {
+}
+
 int Renderer::GetMaxTextureSize() const {
 	return max_texture_size;
 }
 
+int Renderer::GetAtlasPage( Primitive& primitive ) const {
+	const auto& vertices = primitive.GetVertices();
+
+	if( vertices.empty() ) {
+		return 0;
+	}
+
+	return static_cast<int>( vertices[( vertices.size() - 1 ) / 3 * 3].texture_coordinate.y ) / max_texture_size;
+}
+
 }
@@ -0,0 +1,89 @@
+#include <SFGUI/RendererSpatialGrid.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Items covering more cells than this are cheaper to test directly.
+const int max_cells_per_item = 64;
+
+std::uint64_t GetCellKey( int x, int y ) {
+	return ( static_cast<std::uint64_t>( static_cast<std::uint32_t>( x ) ) << 32 ) | static_cast<std::uint32_t>( y );
+}
+
+}
+
+namespace sfg {
+namespace priv {
+
+RendererSpatialGrid::RendererSpatialGrid( float cell_size ) :
+	m_cell_size( cell_size )
+{
+}
+
+void RendererSpatialGrid::Clear() {
+	m_cells.clear();
+	m_entries.clear();
+	m_oversized_entries.clear();
+}
+
+sf::Vector2i RendererSpatialGrid::GetCell( const sf::Vector2f& position ) const {
+	return sf::Vector2i( static_cast<int>( std::floor( position.x / m_cell_size ) ), static_cast<int>( std::floor( position.y / m_cell_size ) ) );
+}
+
+void RendererSpatialGrid::Insert( std::size_t item, const sf::FloatRect& rect ) {
+	const auto entry_index = m_entries.size();
+
+	m_entries.push_back( Entry{ item, rect } );
+
+	const auto first_cell = GetCell( sf::Vector2f( rect.left, rect.top ) );
+	const auto last_cell = GetCell( sf::Vector2f( rect.left + rect.width, rect.top + rect.height ) );
+
+	if( ( last_cell.x - first_cell.x + 1 ) * ( last_cell.y - first_cell.y + 1 ) > max_cells_per_item ) {
+		m_oversized_entries.push_back( entry_index );
+		return;
+	}
+
+	for( auto y = first_cell.y; y <= last_cell.y; ++y ) {
+		for( auto x = first_cell.x; x <= last_cell.x; ++x ) {
+			m_cells[GetCellKey( x, y )].push_back( entry_index );
+		}
+	}
+}
+
+void RendererSpatialGrid::Query( const sf::FloatRect& rect, std::vector<std::size_t>& items ) const {
+	const auto first_item = items.size();
+
+	const auto first_cell = GetCell( sf::Vector2f( rect.left, rect.top ) );
+	const auto last_cell = GetCell( sf::Vector2f( rect.left + rect.width, rect.top + rect.height ) );
+
+	for( auto y = first_cell.y; y <= last_cell.y; ++y ) {
+		for( auto x = first_cell.x; x <= last_cell.x; ++x ) {
+			auto iter = m_cells.find( GetCellKey( x, y ) );
+
+			if( iter == m_cells.end() ) {
+				continue;
+			}
+
+			for( auto entry_index : iter->second ) {
+				if( rect.intersects( m_entries[entry_index].rect ) ) {
+					items.push_back( m_entries[entry_index].item );
+				}
+			}
+		}
+	}
+
+	for( auto entry_index : m_oversized_entries ) {
+		if( rect.intersects( m_entries[entry_index].rect ) ) {
+			items.push_back( m_entries[entry_index].item );
+		}
+	}
+
+	// Items spanning several cells were found more than once.
+	std::sort( items.begin() + static_cast<std::ptrdiff_t>( first_item ), items.end() );
+	items.erase( std::unique( items.begin() + static_cast<std::ptrdiff_t>( first_item ), items.end() ), items.end() );
+}
+
+}
+}
@@ -0,0 +1,16 @@
+#include <SFGUI/RendererVertex.hpp>
+
+#include <algorithm>
+
+namespace sfg {
+namespace priv {
+
+const float texture_coordinate_scale = 32767.f;
+
+void RendererVertex::SetTextureCoordinate( const sf::Vector2f& coordinate ) {
+	texture_coordinate[0] = static_cast<sf::Int16>( std::min( std::max( coordinate.x, 0.f ), 1.f ) * texture_coordinate_scale + .5f );
+	texture_coordinate[1] = static_cast<sf::Int16>( std::min( std::max( coordinate.y, 0.f ), 1.f ) * texture_coordinate_scale + .5f );
+}
+
+}
+}
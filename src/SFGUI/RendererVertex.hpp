@@ -0,0 +1,40 @@
+#pragma once
+
+#include <SFGUI/Config.hpp>
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <SFML/Config.hpp>
+
+namespace sfg {
+namespace priv {
+
+/** Interleaved vertex uploaded by the buffer based renderers.
+ */
+struct RendererVertex {
+	/** Set the texture coordinate.
+	 * @param coordinate Normalized texture coordinate, clamped to [0, 1].
+	 */
+	void SetTextureCoordinate( const sf::Vector2f& coordinate );
+
+	sf::Vector2f position;
+	sf::Color color;
+	sf::Int16 texture_coordinate[2]; // Normalized to [0, texture_coordinate_scale].
+};
+
+/** RendererVertex along with the per vertex data NonLegacyRenderer's shader needs.
+ */
+struct RendererShaderVertex {
+	RendererVertex vertex;
+	float transform_index;
+	sf::Uint16 texture_layer;
+	sf::Uint16 viewport_index;
+};
+
+/** Value a texture coordinate of 1 is stored as. Signed, since the fixed
+ * function pipeline can't source unsigned 16-bit texture coordinates.
+ */
+extern const float texture_coordinate_scale;
+
+}
+}
@@ -15,9 +15,20 @@ RendererViewport::RendererViewport()
 }
 
 void RendererViewport::SetSourceOrigin( const sf::Vector2f& origin ) {
+	if( origin == m_source_origin ) {
+		return;
+	}
+
+	Renderer::Get().DamageViewport( *this );
+
 	m_source_origin = origin;
 
-	Renderer::Get().Invalidate( sfg::Renderer::INVALIDATE_ALL );
+	Renderer::Get().DamageViewport( *this );
+
+	// Scrolling doesn't change any geometry, renderers
+	// that can apply the offset on their own only have
+	// to update it.
+	Renderer::Get().Invalidate( sfg::Renderer::INVALIDATE_VIEWPORT );
 }
 
 const sf::Vector2f& RendererViewport::GetSourceOrigin() const {
@@ -25,8 +36,12 @@ const sf::Vector2f& RendererViewport::GetSourceOrigin() const {
 }
 
 void RendererViewport::SetDestinationOrigin( const sf::Vector2f& origin ) {
+	Renderer::Get().DamageViewport( *this );
+
 	m_destination_origin = origin;
 
+	Renderer::Get().DamageViewport( *this );
+
 	Renderer::Get().Invalidate( sfg::Renderer::INVALIDATE_ALL );
 }
 
@@ -35,8 +50,12 @@ const sf::Vector2f& RendererViewport::GetDestinationOrigin() const {
 }
 
 void RendererViewport::SetSize( const sf::Vector2f& size ) {
+	Renderer::Get().DamageViewport( *this );
+
 	m_size = size;
 
+	Renderer::Get().DamageViewport( *this );
+
 	Renderer::Get().Invalidate( sfg::Renderer::INVALIDATE_ALL );
 }
 
@@ -44,6 +63,10 @@ const sf::Vector2f& RendererViewport::GetSize() const {
 	return m_size;
 }
 
+std::size_t RendererViewport::GetId() const {
+	return m_id;
+}
+
 bool RendererViewport::operator==( const RendererViewport& other ) const {
 	return ( m_source_origin == other.m_source_origin ) && ( m_destination_origin == other.m_destination_origin ) && ( m_size == other.m_size );
 }
@@ -9,18 +9,26 @@
 
 #include <SFGUI/Renderers/NonLegacyRenderer.hpp>
 #include <SFGUI/RendererBatch.hpp>
+#include <SFGUI/RendererSpatialGrid.hpp>
 #include <SFGUI/RendererViewport.hpp>
+#include <SFGUI/RendererVertex.hpp>
 #include <SFGUI/Signal.hpp>
 #include <SFGUI/Primitive.hpp>
 #include <SFGUI/PrimitiveVertex.hpp>
 #include <SFGUI/GLCheck.hpp>
+#include <SFGUI/ParallelFor.hpp>
 
 #include <SFML/Graphics/RenderTexture.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Window/Context.hpp>
 #include <SFML/System/Vector3.hpp>
+#include <SFML/System/Clock.hpp>
+#include <algorithm>
+#include <iterator>
+#include <limits>
 #include <sstream>
 #include <cstddef>
+#include <cstring>
 #include <cassert>
 
 // ARB_vertex_buffer_object
@@ -30,12 +38,14 @@
 #define GLEXT_GL_ELEMENT_ARRAY_BUFFER GL_ELEMENT_ARRAY_BUFFER_ARB
 #define GLEXT_GL_DYNAMIC_DRAW GL_DYNAMIC_DRAW_ARB
 #define GLEXT_GL_STATIC_DRAW GL_STATIC_DRAW_ARB
+#define GLEXT_GL_STREAM_DRAW GL_STREAM_DRAW_ARB
 
 #define GLEXT_glBindBuffer glBindBufferARB
 #define GLEXT_glDeleteBuffers glDeleteBuffersARB
 #define GLEXT_glGenBuffers glGenBuffersARB
 #define GLEXT_glBufferData glBufferDataARB
 #define GLEXT_glBufferSubData glBufferSubDataARB
+#define GLEXT_glUnmapBuffer glUnmapBufferARB
 
 // ARB_multitexture
 #define GLEXT_GL_TEXTURE0 GL_TEXTURE0_ARB
@@ -82,6 +92,7 @@
 #define GLEXT_glGetUniformLocation glGetUniformLocationARB
 #define GLEXT_glUniform1i glUniform1iARB
 #define GLEXT_glUniform2f glUniform2fARB
+#define GLEXT_glUniform2fv glUniform2fvARB
 
 // ARB_vertex_array_object
 #define GLEXT_vertex_array_object sfgogl_ext_ARB_vertex_array_object
@@ -104,6 +115,41 @@
 #define GLEXT_glFramebufferTexture2D glFramebufferTexture2DEXT
 #define GLEXT_glCheckFramebufferStatus glCheckFramebufferStatusEXT
 
+// ARB_texture_rg (core since GL 3.0, ensured by GLSL 1.30 support)
+#define GLEXT_GL_RG GL_RG
+#define GLEXT_GL_RG32F GL_RG32F
+
+// EXT_texture_array (core since GL 3.0, ensured by GLSL 1.30 support)
+#define GLEXT_GL_TEXTURE_2D_ARRAY GL_TEXTURE_2D_ARRAY_EXT
+#define GLEXT_GL_TEXTURE_BINDING_2D_ARRAY GL_TEXTURE_BINDING_2D_ARRAY_EXT
+
+// ARB_map_buffer_range
+#define GLEXT_map_buffer_range sfgogl_ext_ARB_map_buffer_range
+
+#define GLEXT_GL_MAP_WRITE_BIT GL_MAP_WRITE_BIT
+#define GLEXT_GL_MAP_INVALIDATE_RANGE_BIT GL_MAP_INVALIDATE_RANGE_BIT
+#define GLEXT_GL_MAP_FLUSH_EXPLICIT_BIT GL_MAP_FLUSH_EXPLICIT_BIT
+#define GLEXT_GL_MAP_UNSYNCHRONIZED_BIT GL_MAP_UNSYNCHRONIZED_BIT
+
+#define GLEXT_glMapBufferRange glMapBufferRange
+#define GLEXT_glFlushMappedBufferRange glFlushMappedBufferRange
+
+// ARB_sync
+#define GLEXT_sync sfgogl_ext_ARB_sync
+
+#define GLEXT_GL_SYNC_GPU_COMMANDS_COMPLETE GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GLEXT_GL_SYNC_FLUSH_COMMANDS_BIT GL_SYNC_FLUSH_COMMANDS_BIT
+#define GLEXT_GL_ALREADY_SIGNALED GL_ALREADY_SIGNALED
+#define GLEXT_GL_CONDITION_SATISFIED GL_CONDITION_SATISFIED
+#define GLEXT_GL_TIMEOUT_EXPIRED GL_TIMEOUT_EXPIRED
+#define GLEXT_GL_WAIT_FAILED GL_WAIT_FAILED
+
+#define GLEXT_GLsync GLsync
+
+#define GLEXT_glFenceSync glFenceSync
+#define GLEXT_glClientWaitSync glClientWaitSync
+#define GLEXT_glDeleteSync glDeleteSync
+
 #if defined( __APPLE__ )
 
     #define CastToGlHandle( x ) reinterpret_cast<GLEXT_GLhandle>( static_cast<std::ptrdiff_t>( x ) )
@@ -120,11 +166,145 @@ namespace {
 
 bool gl_initialized = false;
 
+// Window area a batch drawn in the given viewport may touch,
+// restricted to the area that is being redrawn.
+sf::IntRect GetBatchArea( const sfg::RendererViewport::Ptr& viewport, const sfg::RendererViewport& default_viewport, const sf::IntRect& redraw_area ) {
+	if( !viewport || ( ( *viewport ) == default_viewport ) ) {
+		return redraw_area;
+	}
+
+	const auto& destination_origin = viewport->GetDestinationOrigin();
+	const auto& size = viewport->GetSize();
+
+	sf::IntRect area;
+
+	redraw_area.intersects( sf::IntRect( static_cast<int>( destination_origin.x ), static_cast<int>( destination_origin.y ), static_cast<int>( size.x ), static_cast<int>( size.y ) ), area );
+
+	return area;
+}
+
+// Number of per-primitive translations stored in each row of the
+// transform texture. Has to match the value used in the vertex shader.
+const std::size_t transform_texture_width = 1024;
+
+// Number of viewports whose scroll offset can be applied by the
+// vertex shader, including the unused entry 0. Has to match the
+// size of the uniform array in the vertex shader.
+const std::size_t max_viewport_offsets = 64;
+
+// Rewriting fewer slots than this per thread isn't worth starting the thread.
+const std::size_t write_slots_per_thread = 256;
+
+// Number of buffer regions streaming cycles through. The GPU may
+// still be drawing from the previous two while the next is written.
+const std::size_t stream_segment_count = 3;
+
+// Nanoseconds to wait on a fence before checking again.
+const GLuint64 stream_fence_timeout = 1000000;
+
 bool vbo_supported = false;
 bool vao_supported = false;
 bool vap_supported = false;
 bool shader_supported = false;
 bool fbo_supported = false;
+bool streaming_ring_supported = false;
+
+// Sorts ( first, count ) ranges and merges neighbouring ones. Small gaps
+// are merged along with their neighbours since an extra call costs more
+// than a few bytes.
+void MergeRanges( std::vector<std::pair<std::size_t, std::size_t>>& ranges ) {
+	const static std::size_t merge_gap = 64;
+
+	if( ranges.empty() ) {
+		return;
+	}
+
+	std::sort( ranges.begin(), ranges.end() );
+
+	auto merged_end = ranges.begin();
+
+	for( auto iter = ranges.begin() + 1; iter != ranges.end(); ++iter ) {
+		if( iter->first <= merged_end->first + merged_end->second + merge_gap ) {
+			merged_end->second = std::max( merged_end->second, iter->first + iter->second - merged_end->first );
+		}
+		else {
+			*( ++merged_end ) = *iter;
+		}
+	}
+
+	ranges.erase( merged_end + 1, ranges.end() );
+}
+
+// Writes the given sorted element ranges of data into the buffer bound to
+// target, offset by first_element. The mapping is unsynchronized, the caller
+// has to make sure the GPU is done reading from that part of the buffer.
+template<typename T>
+void StreamRanges( GLenum target, std::size_t first_element, const T* data, const std::vector<std::pair<std::size_t, std::size_t>>& ranges ) {
+	if( ranges.empty() ) {
+		return;
+	}
+
+	const auto span_first = ranges.front().first;
+	const auto span_size = ranges.back().first + ranges.back().second - span_first;
+
+	if( !span_size ) {
+		return;
+	}
+
+	GLbitfield access = GLEXT_GL_MAP_WRITE_BIT | GLEXT_GL_MAP_UNSYNCHRONIZED_BIT | GLEXT_GL_MAP_FLUSH_EXPLICIT_BIT;
+
+	// Nothing in the span has to be preserved if it is overwritten entirely.
+	if( ranges.size() == 1 ) {
+		access |= GLEXT_GL_MAP_INVALIDATE_RANGE_BIT;
+	}
+
+	auto mapping = CheckGLError( GLEXT_glMapBufferRange(
+		target,
+		static_cast<GLintptr>( ( first_element + span_first ) * sizeof( T ) ),
+		static_cast<GLsizeiptr>( span_size * sizeof( T ) ),
+		access
+	) );
+
+	if( !mapping ) {
+		return;
+	}
+
+	auto destination = static_cast<T*>( mapping );
+
+	for( const auto& range : ranges ) {
+		std::copy( data + range.first, data + range.first + range.second, destination + ( range.first - span_first ) );
+
+		CheckGLError( GLEXT_glFlushMappedBufferRange(
+			target,
+			static_cast<GLintptr>( ( range.first - span_first ) * sizeof( T ) ),
+			static_cast<GLsizeiptr>( range.second * sizeof( T ) )
+		) );
+	}
+
+	CheckGLError( GLEXT_glUnmapBuffer( target ) );
+}
+
+// Writes the indices of a primitive starting at index_position and
+// tracks the first index that differs from what was there before.
+template<typename T>
+void WriteIndices( std::vector<T>& index_data, std::size_t index_position, std::size_t vertex_offset, const std::vector<unsigned int>& indices, std::size_t& first_changed_index ) {
+	for( const auto& index : indices ) {
+		const auto value = static_cast<T>( vertex_offset + index );
+
+		if( index_position < index_data.size() ) {
+			if( index_data[index_position] != value ) {
+				index_data[index_position] = value;
+				first_changed_index = std::min( first_changed_index, index_position );
+			}
+		}
+		else {
+			index_data.push_back( value );
+			first_changed_index = std::min( first_changed_index, index_position );
+		}
+
+		++index_position;
+	}
+}
 
 unsigned int GetAttributeLocation( unsigned int shader, std::string name ) {
 	auto location = CheckGLError( GLEXT_glGetAttribLocation( CastToGlHandle( shader ), name.c_str() ) );
@@ -221,23 +401,51 @@ namespace sfg {
 
 NonLegacyRenderer::NonLegacyRenderer() :
 	m_previous_window_size( -1, -1 ),
-	m_last_vertex_count( 0 ),
+	m_vertex_capacity( 0 ),
+	m_vertex_vbo_capacity( 0 ),
+	m_index_vbo_capacity( 0 ),
+	m_transform_count( 0 ),
+	m_transform_texture_rows( 0 ),
+	m_atlas_array_layers( 0 ),
+	m_stream_segment( 0 ),
 	m_last_index_count( 0 ),
+	m_sync_pass( 0 ),
 	m_vbo_sync_type( INVALIDATE_ALL ),
 	m_vbo_synced( false ),
 	m_cull( false ),
-	m_use_fbo( false ) {
+	m_cull_grids_valid( false ),
+	m_viewport_offsets_exhausted( false ),
+	m_use_fbo( false ),
+	m_use_texture_array( false ),
+	m_use_streaming_buffers( false ),
+	m_use_short_indices( false ) {
+	m_stream_dirty_ranges.resize( stream_segment_count );
+	m_stream_first_changed_indices.resize( stream_segment_count, std::numeric_limits<std::size_t>::max() );
+	m_stream_fences.resize( stream_segment_count, nullptr );
+
+	// Viewport offset 0 stays zero, it is used by primitives that
+	// aren't in a viewport or whose offset is part of their transform.
+	m_viewport_offsets.resize( 1 );
+	m_offset_viewports.resize( 1 );
+	m_offset_viewport_sync_passes.resize( 1, 0 );
+
 	if( IsAvailable() ) {
 		sf::Context context;
 
 		m_shader = CreateShader(
 			"#version 130\n"
 			"uniform vec2 viewport_parameters;\n"
+			"uniform sampler2D transform_texture;\n"
+			"uniform vec2 viewport_offsets[64];\n"
 			"in vec2 vertex;\n"
 			"in vec4 color;\n"
 			"in vec2 texture_coordinate;\n"
+			"in float transform_index;\n"
+			"in float texture_layer;\n"
+			"in float viewport_index;\n"
 			"out vec4 vertex_color;\n"
 			"out vec2 vertex_texture_coordinate;\n"
+			"flat out float vertex_texture_layer;\n"
 			"void main() {\n"
 			"\tmat4 mvp_matrix = mat4(1.f);\n"
 			"\tmvp_matrix[3][0] = -1.f;\n"
@@ -245,17 +453,27 @@ NonLegacyRenderer::NonLegacyRenderer() :
 			"\tmvp_matrix[0][0] = viewport_parameters.x;\n"
 			"\tmvp_matrix[1][1] = viewport_parameters.y;\n"
 			"\tmvp_matrix[2][2] = -1.f;\n"
-			"\tgl_Position = mvp_matrix * vec4(vertex.xy, 1.f, 1.f);\n"
+			"\tint index = int(transform_index);\n"
+			"\tvec2 translation = texelFetch(transform_texture, ivec2(index % 1024, index / 1024), 0).xy;\n"
+			"\ttranslation += viewport_offsets[int(viewport_index)];\n"
+			"\tgl_Position = mvp_matrix * vec4(vertex.xy + translation, 1.f, 1.f);\n"
 			"\tvertex_color = color;\n"
 			"\tvertex_texture_coordinate = texture_coordinate;\n"
+			"\tvertex_texture_layer = texture_layer;\n"
 			"}\n",
 			"#version 130\n"
 			"uniform sampler2D texture0;\n"
+			"uniform sampler2DArray atlas_array;\n"
+			"uniform bool use_texture_array;\n"
 			"in vec4 vertex_color;\n"
 			"in vec2 vertex_texture_coordinate;\n"
+			"flat in float vertex_texture_layer;\n"
 			"out vec4 fragment_color;\n"
 			"void main() {\n"
-			"\tfragment_color = vertex_color * texture(texture0, vertex_texture_coordinate);\n"
+			"\tif(use_texture_array)\n"
+			"\t\tfragment_color = vertex_color * texture(atlas_array, vec3(vertex_texture_coordinate, vertex_texture_layer));\n"
+			"\telse\n"
+			"\t\tfragment_color = vertex_color * texture(texture0, vertex_texture_coordinate);\n"
 			"}\n"
 		);
 
@@ -282,10 +500,17 @@ NonLegacyRenderer::NonLegacyRenderer() :
 
 		CheckGLError( m_viewport_parameters_location = GLEXT_glGetUniformLocation( CastToGlHandle( m_shader ), "viewport_parameters" ) );
 		CheckGLError( m_texture_location = GLEXT_glGetUniformLocation( CastToGlHandle( m_shader ), "texture0" ) );
+		CheckGLError( m_transform_texture_location = GLEXT_glGetUniformLocation( CastToGlHandle( m_shader ), "transform_texture" ) );
+		CheckGLError( m_atlas_array_location = GLEXT_glGetUniformLocation( CastToGlHandle( m_shader ), "atlas_array" ) );
+		CheckGLError( m_use_texture_array_location = GLEXT_glGetUniformLocation( CastToGlHandle( m_shader ), "use_texture_array" ) );
+		CheckGLError( m_viewport_offsets_location = GLEXT_glGetUniformLocation( CastToGlHandle( m_shader ), "viewport_offsets" ) );
 
 		CheckGLError( m_vertex_location = GetAttributeLocation( m_shader, "vertex" ) );
 		CheckGLError( m_color_location = GetAttributeLocation( m_shader, "color" ) );
 		CheckGLError( m_texture_coordinate_location = GetAttributeLocation( m_shader, "texture_coordinate" ) );
+		CheckGLError( m_transform_index_location = GetAttributeLocation( m_shader, "transform_index" ) );
+		CheckGLError( m_texture_layer_location = GetAttributeLocation( m_shader, "texture_layer" ) );
+		CheckGLError( m_viewport_index_location = GetAttributeLocation( m_shader, "viewport_index" ) );
 
 		CheckGLError( m_fbo_texture_location = GLEXT_glGetUniformLocation( CastToGlHandle( m_fbo_shader ), "texture0" ) );
 
@@ -293,9 +518,13 @@ NonLegacyRenderer::NonLegacyRenderer() :
 		CheckGLError( m_fbo_texture_coordinate_location = GetAttributeLocation( m_fbo_shader, "texture_coordinate" ) );
 
 		CheckGLError( GLEXT_glGenBuffers( 1, &m_vertex_vbo ) );
-		CheckGLError( GLEXT_glGenBuffers( 1, &m_color_vbo ) );
-		CheckGLError( GLEXT_glGenBuffers( 1, &m_texture_vbo ) );
 		CheckGLError( GLEXT_glGenBuffers( 1, &m_index_vbo ) );
+
+		CheckGLError( glGenTextures( 1, &m_transform_texture ) );
+		CheckGLError( glGenTextures( 1, &m_atlas_array_texture ) );
+
+		// Atlas pages are copied into the texture array on the GPU.
+		m_use_texture_array = fbo_supported;
 	}
 	else {
 #if defined( SFGUI_DEBUG )
@@ -309,9 +538,24 @@ NonLegacyRenderer::~NonLegacyRenderer() {
 
 	DestroyFBO();
 
+	// Frame buffers and vertex array objects of the other targets aren't
+	// shared between contexts and die along with them, everything else is shared.
+	for( auto& objects : m_target_objects ) {
+		if( objects.second.fbo_vbo ) {
+			CheckGLError( GLEXT_glDeleteBuffers( 1, &objects.second.fbo_vbo ) );
+		}
+
+		if( objects.second.frame_buffer_texture ) {
+			CheckGLError( glDeleteTextures( 1, &objects.second.frame_buffer_texture ) );
+		}
+	}
+
+	DeleteStreamFences();
+
+	CheckGLError( glDeleteTextures( 1, &m_atlas_array_texture ) );
+	CheckGLError( glDeleteTextures( 1, &m_transform_texture ) );
+
 	CheckGLError( GLEXT_glDeleteBuffers( 1, &m_index_vbo ) );
-	CheckGLError( GLEXT_glDeleteBuffers( 1, &m_texture_vbo ) );
-	CheckGLError( GLEXT_glDeleteBuffers( 1, &m_color_vbo ) );
 	CheckGLError( GLEXT_glDeleteBuffers( 1, &m_vertex_vbo ) );
 
 	CheckGLError( GLEXT_glDeleteVertexArrays( 1, &m_vao ) );
@@ -380,6 +624,10 @@ bool NonLegacyRenderer::IsAvailable() {
 			fbo_supported = true;
 		}
 
+		if( GLEXT_map_buffer_range && GLEXT_sync ) {
+			streaming_ring_supported = true;
+		}
+
 		checked = true;
 	}
 
@@ -395,6 +643,8 @@ void NonLegacyRenderer::Display( sf::Window& target ) const {
 
 	target.setActive( true );
 
+	SelectTarget( &target );
+
 	auto blend_enabled = CheckGLError( glIsEnabled( GL_BLEND ) );
 
 	if( !blend_enabled ) {
@@ -426,6 +676,8 @@ void NonLegacyRenderer::Display( sf::RenderWindow& target ) const {
 
 	target.setActive( true );
 
+	SelectTarget( &target );
+
 	DisplayImpl();
 }
 
@@ -434,6 +686,8 @@ void NonLegacyRenderer::Display( sf::RenderTexture& target ) const {
 
 	target.setActive( true );
 
+	SelectTarget( &target );
+
 	DisplayImpl();
 }
 
@@ -442,19 +696,21 @@ void NonLegacyRenderer::DisplayImpl() const {
 		return;
 	}
 
+	BeginFrameStatistics();
+
 	auto previous_program = CheckGLError( GLEXT_glGetHandle( GLEXT_GL_PROGRAM_OBJECT ) );
 
+	auto resized = false;
+
 	if( m_last_window_size != m_window_size ) {
 		CheckGLError( glViewport( 0, 0, m_window_size.x, m_window_size.y ) );
 
 		m_last_window_size = m_window_size;
+		resized = true;
 
 		if( m_window_size.x && m_window_size.y ) {
 			const_cast<NonLegacyRenderer*>( this )->Invalidate( INVALIDATE_VERTEX | INVALIDATE_TEXTURE );
 
-			CheckGLError( GLEXT_glUseProgramObject( CastToGlHandle( m_shader ) ) );
-			CheckGLError( GLEXT_glUniform2f(m_viewport_parameters_location, 2.f / static_cast<float>( m_window_size.x ), -2.f / static_cast<float>( m_window_size.y ) ) );
-
 			const_cast<NonLegacyRenderer*>( this )->SetupFBO( m_window_size.x, m_window_size.y );
 		}
 	}
@@ -472,9 +728,28 @@ void NonLegacyRenderer::DisplayImpl() const {
 		// again this might be all wrong...
 
 		// Refresh VBO data if out of sync
-		const_cast<NonLegacyRenderer*>( this )->RefreshVBO();
+		sf::Clock refresh_clock;
+
+		// Scrolling only moves viewport offsets around unless some viewport
+		// didn't fit into the uniform array. With culling, the primitives
+		// of the scrolled viewports have to be culled again.
+		const auto scrolled = ( m_vbo_sync_type == INVALIDATE_VIEWPORT ) && !m_viewport_offsets_exhausted;
+
+		if( scrolled && !m_cull ) {
+			const_cast<NonLegacyRenderer*>( this )->RefreshViewportOffsets();
+		}
+		else if( scrolled && m_cull_grids_valid ) {
+			const_cast<NonLegacyRenderer*>( this )->RefreshCulling();
+		}
+		else {
+			const_cast<NonLegacyRenderer*>( this )->RefreshVBO();
+		}
+
+		m_frame_statistics.refresh_time = refresh_clock.getElapsedTime();
 	}
 
+	UpdateDamagedArea( resized || m_force_redraw );
+
 	if( !GLEXT_glIsVertexArray( m_vao ) ) {
 		const_cast<NonLegacyRenderer*>( this )->SetupVAO();
 	}
@@ -482,37 +757,80 @@ void NonLegacyRenderer::DisplayImpl() const {
 	CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 + 1 ) );
 	auto texture_binding = 0;
 	CheckGLError( glGetIntegerv( GL_TEXTURE_BINDING_2D, &texture_binding) );
+	CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 + 2 ) );
+	auto transform_texture_binding = 0;
+	CheckGLError( glGetIntegerv( GL_TEXTURE_BINDING_2D, &transform_texture_binding) );
+	CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 + 3 ) );
+	auto atlas_array_binding = 0;
+	CheckGLError( glGetIntegerv( GLEXT_GL_TEXTURE_BINDING_2D_ARRAY, &atlas_array_binding) );
 	CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 ) );
 
-	if( !m_use_fbo || !m_vbo_synced || m_force_redraw ) {
+	// The FBO keeps the last frame, only the damaged area has to be redrawn into it.
+	const auto redraw_area = m_use_fbo ? m_damaged_area : sf::IntRect( 0, 0, m_window_size.x, m_window_size.y );
+
+	if( !m_use_fbo || ( ( redraw_area.width > 0 ) && ( redraw_area.height > 0 ) ) ) {
 		// Thanks to color / texture modulation we can draw the entire
 		// frame in a single pass by pseudo-disabling the texturing with
 		// the help of a white texture ( 1.f * something = something ).
 		// Further, we stick all referenced textures into our giant atlas
 		// so we don't have to rebind during the draw.
 
+		CheckGLError( glEnable( GL_SCISSOR_TEST ) );
+
 		if( m_use_fbo ) {
 			CheckGLError( GLEXT_glBindFramebuffer( GLEXT_GL_FRAMEBUFFER, m_frame_buffer ) );
 
+			// Clearing respects the scissor box.
+			CheckGLError( glScissor( redraw_area.left, m_window_size.y - redraw_area.top - redraw_area.height, redraw_area.width, redraw_area.height ) );
 			CheckGLError( glClear( GL_COLOR_BUFFER_BIT ) );
 		}
 
 		CheckGLError( GLEXT_glUseProgramObject( CastToGlHandle( m_shader ) ) );
+		// The program is shared by all targets, which don't need to have the same size.
+		CheckGLError( GLEXT_glUniform2f( m_viewport_parameters_location, 2.f / static_cast<float>( std::max( m_window_size.x, 1 ) ), -2.f / static_cast<float>( std::max( m_window_size.y, 1 ) ) ) );
 		CheckGLError( GLEXT_glUniform1i( m_texture_location, 1 ) );
+		CheckGLError( GLEXT_glUniform1i( m_transform_texture_location, 2 ) );
+		CheckGLError( GLEXT_glUniform1i( m_atlas_array_location, 3 ) );
+		CheckGLError( GLEXT_glUniform1i( m_use_texture_array_location, m_use_texture_array ? 1 : 0 ) );
+		CheckGLError( GLEXT_glUniform2fv( m_viewport_offsets_location, static_cast<GLsizei>( m_viewport_offsets.size() ), &m_viewport_offsets[0].x ) );
 
 		CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 + 1 ) );
 		sf::Texture::bind( m_texture_atlas[0].get() );
+		CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 + 2 ) );
+		CheckGLError( glBindTexture( GL_TEXTURE_2D, m_transform_texture ) );
+		CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 + 3 ) );
+		CheckGLError( glBindTexture( GLEXT_GL_TEXTURE_2D_ARRAY, m_atlas_array_texture ) );
 		CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 ) );
 
 		CheckGLError( GLEXT_glBindVertexArray( m_vao ) );
 
-		CheckGLError( glEnable( GL_SCISSOR_TEST ) );
+		// Streaming buffers hold several copies of the data,
+		// point the attributes at the one written last.
+		const auto index_type = static_cast<GLenum>( m_use_short_indices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT );
+		const auto index_size = m_use_short_indices ? sizeof( GLushort ) : sizeof( GLuint );
+
+		std::size_t index_offset = 0;
+
+		if( m_use_streaming_buffers ) {
+			SetupVertexAttributes( m_stream_segment * m_vertex_vbo_capacity );
+			CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, 0 ) );
+
+			index_offset = m_stream_segment * m_index_vbo_capacity * index_size;
+		}
 
 		auto current_atlas_page = 0;
 
 		for( const auto& batch : m_batches ) {
 			auto viewport = batch.viewport;
 
+			const auto batch_area = GetBatchArea( viewport, *m_default_viewport, redraw_area );
+
+			if( ( batch_area.width <= 0 ) || ( batch_area.height <= 0 ) ) {
+				continue;
+			}
+
+			CheckGLError( glScissor( batch_area.left, m_window_size.y - batch_area.top - batch_area.height, batch_area.width, batch_area.height ) );
+
 			if( batch.custom_draw ) {
 				auto destination = static_cast<sf::Vector2i>( viewport->GetDestinationOrigin() );
 				auto size = static_cast<sf::Vector2i>( viewport->GetSize() );
@@ -531,33 +849,25 @@ void NonLegacyRenderer::DisplayImpl() const {
 				// Draw canvas.
 				( *batch.custom_draw_callback )();
 
+				++m_frame_statistics.draw_call_count;
+
 				CheckGLError( glViewport( 0, 0, m_window_size.x, m_window_size.y ) );
 
 				CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 + 1 ) );
 				CheckGLError( glBindTexture( GL_TEXTURE_2D, static_cast<unsigned int>( custom_draw_texture_binding ) ) );
+				CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 + 2 ) );
+				CheckGLError( glBindTexture( GL_TEXTURE_2D, m_transform_texture ) );
+				CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 + 3 ) );
+				CheckGLError( glBindTexture( GLEXT_GL_TEXTURE_2D_ARRAY, m_atlas_array_texture ) );
 				CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 ) );
 
 				CheckGLError( GLEXT_glUseProgramObject( CastToGlHandle( m_shader ) ) );
 				CheckGLError( GLEXT_glBindVertexArray( m_vao ) );
 			}
 			else {
-				if( viewport && ( ( *viewport ) != ( *m_default_viewport ) ) ) {
-					auto destination_origin = viewport->GetDestinationOrigin();
-					auto size = viewport->GetSize();
-
-					CheckGLError( glScissor(
-						static_cast<int>( destination_origin.x ),
-						m_window_size.y - static_cast<int>( destination_origin.y + size.y ),
-						static_cast<int>( size.x ),
-						static_cast<int>( size.y )
-					) );
-				}
-				else {
-					CheckGLError( glScissor( 0, 0, m_window_size.x, m_window_size.y ) );
-				}
-
 				if( batch.index_count ) {
-					if( batch.atlas_page != current_atlas_page ) {
+					// With the texture array every page is always bound.
+					if( !m_use_texture_array && ( batch.atlas_page != current_atlas_page ) ) {
 						current_atlas_page = batch.atlas_page;
 
 						CheckGLError( GLEXT_glUseProgramObject( CastToGlHandle( m_shader ) ) );
@@ -572,15 +882,19 @@ void NonLegacyRenderer::DisplayImpl() const {
 						static_cast<unsigned int>( batch.min_index ),
 						static_cast<unsigned int>( batch.max_index ),
 						batch.index_count,
-						GL_UNSIGNED_INT,
-						reinterpret_cast<const GLvoid*>( static_cast<std::size_t>( batch.start_index ) * sizeof( GLuint ) )
+						index_type,
+						reinterpret_cast<const GLvoid*>( index_offset + static_cast<std::size_t>( batch.start_index ) * index_size )
 					) );
+
+					++m_frame_statistics.draw_call_count;
 				}
 			}
 		}
 
 		CheckGLError( glDisable( GL_SCISSOR_TEST ) );
 
+		InsertStreamFence();
+
 		m_force_redraw = false;
 
 		if( m_use_fbo ) {
@@ -604,6 +918,8 @@ void NonLegacyRenderer::DisplayImpl() const {
 			assert( m_fbo_vao != 0 );
 
 			CheckGLError( glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 ) );
+
+			++m_frame_statistics.draw_call_count;
 		}
 	}
 	else {
@@ -625,6 +941,9 @@ void NonLegacyRenderer::DisplayImpl() const {
 		assert( m_fbo_vao != 0 );
 
 		CheckGLError( glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 ) );
+
+		++m_frame_statistics.draw_call_count;
+		m_frame_statistics.cache_hit = true;
 	}
 
 	// Needed otherwise SFML will blow up...
@@ -634,65 +953,186 @@ void NonLegacyRenderer::DisplayImpl() const {
 
 	CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 + 1 ) );
 	CheckGLError( glBindTexture( GL_TEXTURE_2D, static_cast<unsigned int>( texture_binding ) ) );
+	CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 + 2 ) );
+	CheckGLError( glBindTexture( GL_TEXTURE_2D, static_cast<unsigned int>( transform_texture_binding ) ) );
+	CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 + 3 ) );
+	CheckGLError( glBindTexture( GLEXT_GL_TEXTURE_2D_ARRAY, static_cast<unsigned int>( atlas_array_binding ) ) );
 	CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 ) );
 
 	m_vbo_synced = true;
+
+	EndFrameStatistics();
 }
 
 void NonLegacyRenderer::RefreshVBO() {
 	SortPrimitives();
+	CollectDamage();
 
-	m_vertex_data.clear();
-	m_color_data.clear();
-	m_texture_data.clear();
-	m_index_data.clear();
-
-	m_vertex_data.reserve( static_cast<std::size_t>( m_vertex_count ) );
-	m_color_data.reserve( static_cast<std::size_t>( m_vertex_count ) );
-	m_texture_data.reserve( static_cast<std::size_t>( m_vertex_count ) );
-	m_index_data.reserve( static_cast<std::size_t>( m_index_count ) );
+	++m_sync_pass;
 
-	m_batches.clear();
+	// Texture coordinates are normalized against the size of the atlas
+	// page they live in, or the texture array. If any of them was resized
+	// since the last sync, every slot has to be rewritten, otherwise only
+	// the primitives that actually changed need to be touched.
+	auto rewrite_all = false;
 
-	m_last_vertex_count = 0;
-	m_last_index_count = 0;
+	if( m_vbo_sync_type & INVALIDATE_TEXTURE ) {
+		if( m_atlas_page_sizes.size() != m_texture_atlas.size() ) {
+			m_atlas_page_sizes.resize( m_texture_atlas.size() );
+			rewrite_all = true;
+		}
 
-	// Default viewport
-	priv::RendererBatch current_batch;
-	current_batch.viewport = m_default_viewport;
-	current_batch.atlas_page = 0;
-	current_batch.start_index = 0;
-	current_batch.index_count = 0;
-	current_batch.min_index = 0;
-	current_batch.max_index = m_vertex_count - 1;
-	current_batch.custom_draw = false;
+		for( std::size_t page = 0; page < m_texture_atlas.size(); ++page ) {
+			if( m_atlas_page_sizes[page] != m_texture_atlas[page]->getSize() ) {
+				m_atlas_page_sizes[page] = m_texture_atlas[page]->getSize();
+				rewrite_all = true;
+			}
+		}
 
-	sf::FloatRect window_viewport( 0.f, 0.f, static_cast<float>( m_window_size.x ), static_cast<float>( m_window_size.y ) );
+		if( m_use_texture_array && UploadAtlasArray() ) {
+			rewrite_all = true;
+		}
+	}
 
-	const auto max_texture_size = GetMaxTextureSize();
-	const auto default_texture_size = m_texture_atlas[0]->getSize();
+	// First pass: make sure every primitive owns a slot large enough
+	// for its vertices. Slots whose primitives are gone get released.
+	std::vector<std::pair<Primitive*, priv::RendererBufferSlot*>> pending_allocations;
 
 	for( const auto& primitive_ptr : m_primitives ) {
 		auto primitive = primitive_ptr.get();
 
-		primitive->SetSynced();
+		if( primitive->GetCustomDrawCallback() ) {
+			continue;
+		}
+
+		auto result = m_vertex_slots.emplace( primitive, priv::RendererBufferSlot() );
+		auto& slot = result.first->second;
+
+		if( result.second ) {
+			AllocateTransform( slot );
+		}
+
+		slot.sync_pass = m_sync_pass;
+
+		const auto vertex_count = primitive->GetVertices().size();
+
+		if( vertex_count > slot.capacity ) {
+			FreeVertexSlot( slot );
+			pending_allocations.emplace_back( primitive, &slot );
+		}
+	}
+
+	for( auto iter = m_vertex_slots.begin(); iter != m_vertex_slots.end(); ) {
+		if( iter->second.sync_pass != m_sync_pass ) {
+			FreeVertexSlot( iter->second );
+			FreeTransform( iter->second );
+			iter = m_vertex_slots.erase( iter );
+		}
+		else {
+			++iter;
+		}
+	}
+
+	for( const auto& allocation : pending_allocations ) {
+		if( !AllocateVertexSlot( *allocation.second, allocation.first->GetVertices().size() ) ) {
+			// Out of contiguous space, grow the buffers and repack all
+			// slots. This also gets rid of any fragmentation.
+			RepackVertexSlots();
+			rewrite_all = true;
+			break;
+		}
+
+		allocation.first->SetSynced( false );
+	}
+
+	if( m_vertex_data.size() != m_vertex_capacity ) {
+		m_vertex_data.resize( m_vertex_capacity );
+	}
+
+	// 16-bit indices halve the index data as long as they can address every
+	// vertex. Switching the index type invalidates the whole index buffer.
+	const auto use_short_indices = ( m_vertex_capacity <= static_cast<std::size_t>( std::numeric_limits<sf::Uint16>::max() ) + 1 );
+
+	if( use_short_indices != m_use_short_indices ) {
+		m_use_short_indices = use_short_indices;
+
+		m_index_data.clear();
+		m_short_index_data.clear();
+		m_index_vbo_capacity = 0;
+	}
+
+	m_viewport_offsets_exhausted = false;
+
+	// Find every slot that has to be rewritten first. Slots never overlap,
+	// so the rewriting itself can be spread over all cores.
+	m_pending_slot_writes.clear();
+
+	for( const auto& primitive_ptr : m_primitives ) {
+		auto primitive = primitive_ptr.get();
 
-		if( !primitive->IsVisible() ) {
+		if( primitive->GetCustomDrawCallback() ) {
 			continue;
 		}
 
+		auto viewport = primitive->GetViewport();
+
+		// The shader scrolls the primitive along with its viewport if the
+		// viewport got an offset, otherwise the offset goes into the transform.
+		const auto viewport_index = ( viewport && ( ( *viewport ) != ( *m_default_viewport ) ) ) ? GetViewportOffsetIndex( viewport ) : 0;
+
+		auto& slot = m_vertex_slots[primitive];
+
+		// Only rewrite the slot if the geometry of the primitive changed.
+		if( rewrite_all || !primitive->IsSynced() || ( slot.viewport_index != viewport_index ) ) {
+			slot.viewport_index = viewport_index;
+
+			m_pending_slot_writes.emplace_back( primitive, &slot );
+		}
+	}
+
+	m_worker_pool->ParallelFor( m_pending_slot_writes.size(), write_slots_per_thread, [this]( std::size_t begin, std::size_t end ) {
+		for( auto write_index = begin; write_index != end; ++write_index ) {
+			WriteVertexSlot( *m_pending_slot_writes[write_index].first, *m_pending_slot_writes[write_index].second );
+		}
+	} );
+
+	for( const auto& write : m_pending_slot_writes ) {
+		const auto vertex_count = write.second->vertex_count;
+
+		m_frame_statistics.rebuilt_vertex_count += vertex_count;
+
+		if( vertex_count ) {
+			m_dirty_vertex_ranges.emplace_back( write.second->offset, vertex_count );
+		}
+	}
+
+	sf::FloatRect window_viewport( 0.f, 0.f, static_cast<float>( m_window_size.x ), static_cast<float>( m_window_size.y ) );
+
+	m_frame_statistics.culled_primitive_count = 0;
+
+	m_drawn_primitives.clear();
+	m_cull_candidates.clear();
+	m_unscrolled_candidates.clear();
+	m_cull_grids.clear();
+	m_cull_grid_indices.clear();
+
+	for( const auto& primitive_ptr : m_primitives ) {
+		auto primitive = primitive_ptr.get();
+
 		auto position_transform = primitive->GetPosition();
 
 		auto viewport = primitive->GetViewport();
 
 		auto viewport_rect = window_viewport;
 
+		sf::Vector2f viewport_offset;
+
 		// Check if primitive needs to be rendered in a custom viewport.
 		if( viewport && ( ( *viewport ) != ( *m_default_viewport ) ) ) {
 			auto destination_origin = viewport->GetDestinationOrigin();
 			auto size = viewport->GetSize();
 
-			position_transform += ( destination_origin - viewport->GetSourceOrigin() );
+			viewport_offset = destination_origin - viewport->GetSourceOrigin();
 
 			if( m_cull ) {
 				viewport_rect.left = destination_origin.x;
@@ -705,183 +1145,877 @@ void NonLegacyRenderer::RefreshVBO() {
 		const auto& custom_draw_callback = primitive->GetCustomDrawCallback();
 
 		if( custom_draw_callback ) {
-			// Start a new batch.
-			current_batch.max_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-			m_batches.push_back( current_batch );
+			primitive->SetSynced();
 
-			// Mark current_batch custom draw batch.
-			current_batch.viewport = viewport;
-			current_batch.start_index = 0;
-			current_batch.index_count = 0;
-			current_batch.min_index = 0;
-			current_batch.max_index = 0;
-			current_batch.custom_draw = true;
-			current_batch.custom_draw_callback = custom_draw_callback;
+			if( !primitive->IsVisible() ) {
+				continue;
+			}
 
-			// Start a new batch.
-			m_batches.push_back( current_batch );
+			if( m_cull ) {
+				m_unscrolled_candidates.push_back( m_cull_candidates.size() );
+				m_cull_candidates.push_back( primitive );
+			}
 
-			// Reset current_batch to defaults.
-			current_batch.viewport = m_default_viewport;
-			current_batch.start_index = m_last_index_count;
-			current_batch.index_count = 0;
-			current_batch.min_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-			current_batch.custom_draw = false;
+			m_drawn_primitives.push_back( primitive );
+
+			continue;
 		}
-		else {
-			// Process primitive's vertices and indices
-			const std::vector<PrimitiveVertex>& vertices( primitive->GetVertices() );
-			const std::vector<GLuint>& indices( primitive->GetIndices() );
 
-			sf::Vector2f position( 0.f, 0.f );
+		auto& slot = m_vertex_slots[primitive];
 
-			sf::FloatRect bounding_rect( 0.f, 0.f, 0.f, 0.f );
+		const auto viewport_index = slot.viewport_index;
 
-			auto atlas_page = 0;
+		if( !viewport_index ) {
+			position_transform += viewport_offset;
+		}
 
-			const auto vertices_size = vertices.size();
-			sf::Vector2f normalizer;
+		// Moving the primitive or scrolling its viewport
+		// only touches its entry in the transform texture.
+		if( slot.position_transform != position_transform ) {
+			WriteTransform( slot, position_transform );
+		}
 
-			for( std::size_t index = 0; index < vertices_size; ++index ) {
-				const auto vertex = vertices[index];
-				position.x = vertex.position.x + position_transform.x;
-				position.y = vertex.position.y + position_transform.y;
+		primitive->SetSynced();
 
-				m_vertex_data.push_back( position );
-				m_color_data.push_back( vertex.color );
+		if( !primitive->IsVisible() || !slot.vertex_count ) {
+			continue;
+		}
 
-				// The bound texture can only change between triangles.
-				if( index % 3 == 0 ) {
-					atlas_page = static_cast<int>( vertex.texture_coordinate.y ) / max_texture_size;
-					auto texture_size = ( vertex.texture_coordinate.y <= 1.f ) ? default_texture_size : m_texture_atlas[static_cast<std::size_t>( atlas_page )]->getSize();
+		if( m_cull ) {
+			auto bounding_rect = primitive->GetBounds();
+			bounding_rect.left += position_transform.x;
+			bounding_rect.top += position_transform.y;
 
-					// Used to normalize texture coordinates.
-					normalizer.x = 1.f / static_cast<float>( texture_size.x );
-					normalizer.y = 1.f / static_cast<float>( texture_size.y );
-				}
+			const auto candidate = m_cull_candidates.size();
 
-				// Normalize SFML's pixel texture coordinates.
-				m_texture_data.emplace_back( vertex.texture_coordinate.x * normalizer.x, static_cast<float>( static_cast<int>( vertex.texture_coordinate.y ) % max_texture_size ) * normalizer.y );
+			m_cull_candidates.push_back( primitive );
 
-				// Update the bounding rect.
-				if( m_cull ) {
-					if( position.x < bounding_rect.left ) {
-						bounding_rect.width += bounding_rect.left - position.x;
-						bounding_rect.left = position.x;
-					}
-					else if( position.x > bounding_rect.left + bounding_rect.width ) {
-						bounding_rect.width = position.x - bounding_rect.left;
-					}
+			// Primitives scrolled by the shader keep their transform when their
+			// viewport scrolls. Index them by where they are in the viewport's
+			// source area, so a scroll can cull them again by looking only at
+			// what is in view.
+			if( viewport_index ) {
+				GetCullGrid( viewport ).Insert( candidate, bounding_rect );
 
-					if( position.y < bounding_rect.top ) {
-						bounding_rect.height += bounding_rect.top - position.y;
-						bounding_rect.top = position.y;
-					}
-					else if( position.y > bounding_rect.top + bounding_rect.height ) {
-						bounding_rect.height = position.y - bounding_rect.top;
-					}
-				}
+				bounding_rect.left += viewport_offset.x;
+				bounding_rect.top += viewport_offset.y;
 			}
 
-			if( m_cull && !viewport_rect.intersects( bounding_rect ) ) {
-				m_vertex_data.resize( static_cast<std::size_t>( m_last_vertex_count ) );
-				m_color_data.resize( static_cast<std::size_t>( m_last_vertex_count ) );
-				m_texture_data.resize( static_cast<std::size_t>( m_last_vertex_count ) );
+			if( !viewport_rect.intersects( bounding_rect ) ) {
+				++m_frame_statistics.culled_primitive_count;
+				continue;
 			}
-			else {
-				for( const auto& index : indices ) {
-					m_index_data.push_back( static_cast<unsigned int>( m_last_vertex_count ) + index );
-				}
 
-				// Check if we need to start a new batch.
-				if( ( ( *viewport ) != ( *current_batch.viewport ) ) || ( atlas_page != current_batch.atlas_page ) ) {
-					current_batch.max_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-					m_batches.push_back( current_batch );
-
-					// Reset current_batch to defaults.
-					current_batch.viewport = viewport;
-					current_batch.atlas_page = atlas_page;
-					current_batch.start_index = m_last_index_count;
-					current_batch.index_count = 0;
-					current_batch.min_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-					current_batch.custom_draw = false;
-				}
-
-				current_batch.index_count += static_cast<int>( indices.size() );
-
-				m_last_vertex_count += static_cast<GLsizei>( vertices.size() );
-				m_last_index_count += static_cast<GLsizei>( indices.size() );
+			if( !viewport_index ) {
+				m_unscrolled_candidates.push_back( candidate );
 			}
 		}
+
+		m_drawn_primitives.push_back( primitive );
 	}
 
-	current_batch.max_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-	m_batches.push_back( current_batch );
+	m_cull_grids_valid = m_cull;
 
-	if( !m_vertex_data.empty() && !m_color_data.empty() && !m_texture_data.empty() ) {
-		if( m_vbo_sync_type & INVALIDATE_VERTEX ) {
-			// Sync vertex data
-			CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_vertex_vbo ) );
-			CheckGLError( GLEXT_glBufferData( GLEXT_GL_ARRAY_BUFFER, static_cast<int>( m_vertex_data.size() * sizeof( sf::Vector3f ) ), 0, GLEXT_GL_DYNAMIC_DRAW ) );
+	const auto first_changed_index = WriteDrawnIndices();
 
-			if( m_vertex_data.size() > 0 ) {
-				CheckGLError( GLEXT_glBufferSubData( GLEXT_GL_ARRAY_BUFFER, 0, static_cast<int>( m_vertex_data.size() * sizeof( sf::Vector2f ) ), m_vertex_data.data() ) );
-			}
-		}
+	if( m_use_streaming_buffers ) {
+		StreamBufferData( first_changed_index );
+	}
+	else {
+		UploadVertexData();
+		UploadIndexData( first_changed_index );
+	}
 
-		if( m_vbo_sync_type & INVALIDATE_COLOR ) {
-			// Sync color data
-			CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_color_vbo ) );
-			CheckGLError( GLEXT_glBufferData( GLEXT_GL_ARRAY_BUFFER, static_cast<int>( m_color_data.size() * sizeof( sf::Color ) ), 0, GLEXT_GL_DYNAMIC_DRAW ) );
+	UploadTransformData();
 
-			if( m_color_data.size() > 0 ) {
-				CheckGLError( GLEXT_glBufferSubData( GLEXT_GL_ARRAY_BUFFER, 0, static_cast<int>( m_color_data.size() * sizeof( sf::Color ) ), m_color_data.data() ) );
-			}
-		}
+	ReleaseViewportOffsets();
+	UpdateViewportOffsets();
 
-		if( m_vbo_sync_type & INVALIDATE_TEXTURE ) {
-			// Sync texture coord data
-			CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_texture_vbo ) );
-			CheckGLError( GLEXT_glBufferData( GLEXT_GL_ARRAY_BUFFER, static_cast<int>( m_texture_data.size() * sizeof( sf::Vector2f ) ), 0, GLEXT_GL_DYNAMIC_DRAW ) );
+	m_vbo_sync_type = 0;
+}
 
-			if( m_texture_data.size() > 0 ) {
-				CheckGLError( GLEXT_glBufferSubData( GLEXT_GL_ARRAY_BUFFER, 0, static_cast<int>( m_texture_data.size() * sizeof( sf::Vector2f ) ), m_texture_data.data() ) );
-			}
-		}
+void NonLegacyRenderer::RefreshCulling() {
+	// Nothing but the viewport source origins changed. Primitives outside
+	// of the scrolled viewports stay culled or drawn as they are, the grids
+	// tell which of the others are in view now.
+	CollectDamage();
 
-		if( m_vbo_sync_type & INVALIDATE_INDEX ) {
-			// Sync index data
-			CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, m_index_vbo ) );
-			CheckGLError( GLEXT_glBufferData( GLEXT_GL_ELEMENT_ARRAY_BUFFER, static_cast<int>( m_index_data.size() * sizeof( GLuint ) ), 0, GLEXT_GL_DYNAMIC_DRAW ) );
+	m_visible_candidates = m_unscrolled_candidates;
 
-			if( m_index_data.size() > 0 ) {
-				CheckGLError( GLEXT_glBufferSubData( GLEXT_GL_ELEMENT_ARRAY_BUFFER, 0, static_cast<int>( m_index_data.size() * sizeof( GLuint ) ), m_index_data.data() ) );
-			}
+	for( const auto& cull_grid : m_cull_grids ) {
+		const auto& viewport = cull_grid.first;
 
-			CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, 0 ) );
-		}
+		cull_grid.second.Query( sf::FloatRect( viewport->GetSourceOrigin(), viewport->GetSize() ), m_visible_candidates );
 	}
 
-	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, 0 ) );
+	// Candidates are numbered in draw order.
+	std::sort( m_visible_candidates.begin(), m_visible_candidates.end() );
 
-	m_vbo_sync_type = 0;
-}
+	m_drawn_primitives.clear();
 
-void NonLegacyRenderer::InvalidateVBO( unsigned char datasets ) {
-	m_vbo_sync_type |= datasets;
-	m_vbo_synced = false;
-}
+	for( auto candidate : m_visible_candidates ) {
+		m_drawn_primitives.push_back( m_cull_candidates[candidate] );
+	}
 
-void NonLegacyRenderer::SetupFBO( int width, int height ) {
-	if( !m_use_fbo || !width || !height ) {
-		DestroyFBO();
+	m_frame_statistics.culled_primitive_count = m_cull_candidates.size() - m_drawn_primitives.size();
 
-		return;
-	}
+	const auto first_changed_index = WriteDrawnIndices();
 
-	// Create FBO.
-	if( !m_frame_buffer ) {
-		CheckGLError( GLEXT_glGenFramebuffers( 1, &m_frame_buffer ) );
+	if( m_use_streaming_buffers ) {
+		StreamBufferData( first_changed_index );
+	}
+	else {
+		UploadIndexData( first_changed_index );
+	}
+
+	UpdateViewportOffsets();
+
+	m_vbo_sync_type = 0;
+}
+
+priv::RendererSpatialGrid& NonLegacyRenderer::GetCullGrid( const std::shared_ptr<RendererViewport>& viewport ) {
+	auto result = m_cull_grid_indices.emplace( viewport->GetId(), m_cull_grids.size() );
+
+	if( result.second ) {
+		m_cull_grids.emplace_back( viewport, priv::RendererSpatialGrid() );
+	}
+
+	return m_cull_grids[result.first->second].second;
+}
+
+std::size_t NonLegacyRenderer::WriteDrawnIndices() {
+	m_batches.clear();
+
+	m_last_index_count = 0;
+
+	// Track the first index that differs from what is already in the
+	// index buffer so we only have to upload what changed.
+	auto first_changed_index = std::numeric_limits<std::size_t>::max();
+
+	// Default viewport
+	priv::RendererBatch current_batch;
+	current_batch.viewport = m_default_viewport;
+	current_batch.atlas_page = 0;
+	current_batch.start_index = 0;
+	current_batch.index_count = 0;
+	current_batch.min_index = 0;
+	current_batch.max_index = 0;
+	current_batch.custom_draw = false;
+
+	m_frame_statistics.visible_primitive_count = m_drawn_primitives.size();
+
+	for( auto primitive : m_drawn_primitives ) {
+		auto viewport = primitive->GetViewport();
+
+		const auto& custom_draw_callback = primitive->GetCustomDrawCallback();
+
+		if( custom_draw_callback ) {
+			// Start a new batch.
+			m_batches.push_back( current_batch );
+
+			// Mark current_batch custom draw batch.
+			current_batch.viewport = viewport;
+			current_batch.start_index = 0;
+			current_batch.index_count = 0;
+			current_batch.min_index = 0;
+			current_batch.max_index = 0;
+			current_batch.custom_draw = true;
+			current_batch.custom_draw_callback = custom_draw_callback;
+
+			// Start a new batch.
+			m_batches.push_back( current_batch );
+
+			// Reset current_batch to defaults.
+			current_batch.viewport = m_default_viewport;
+			current_batch.start_index = m_last_index_count;
+			current_batch.index_count = 0;
+			current_batch.min_index = 0;
+			current_batch.max_index = 0;
+			current_batch.custom_draw = false;
+
+			continue;
+		}
+
+		const auto& slot = m_vertex_slots[primitive];
+
+		const auto& indices = primitive->GetIndices();
+
+		const auto index_position = static_cast<std::size_t>( m_last_index_count );
+
+		if( m_use_short_indices ) {
+			WriteIndices( m_short_index_data, index_position, slot.offset, indices, first_changed_index );
+		}
+		else {
+			WriteIndices( m_index_data, index_position, slot.offset, indices, first_changed_index );
+		}
+
+		// Check if we need to start a new batch. With the texture
+		// array, primitives from any page can share a batch.
+		if( ( ( *viewport ) != ( *current_batch.viewport ) ) || ( !m_use_texture_array && ( slot.atlas_page != current_batch.atlas_page ) ) ) {
+			m_batches.push_back( current_batch );
+
+			// Reset current_batch to defaults.
+			current_batch.viewport = viewport;
+			current_batch.atlas_page = slot.atlas_page;
+			current_batch.start_index = m_last_index_count;
+			current_batch.index_count = 0;
+			current_batch.min_index = 0;
+			current_batch.max_index = 0;
+			current_batch.custom_draw = false;
+		}
+
+		// Slots are not laid out in draw order, so the index
+		// range of a batch has to be tracked explicitly.
+		const auto slot_first = static_cast<int>( slot.offset );
+		const auto slot_last = static_cast<int>( slot.offset + slot.vertex_count - 1 );
+
+		if( !current_batch.index_count ) {
+			current_batch.min_index = slot_first;
+			current_batch.max_index = slot_last;
+		}
+		else {
+			current_batch.min_index = std::min( current_batch.min_index, slot_first );
+			current_batch.max_index = std::max( current_batch.max_index, slot_last );
+		}
+
+		current_batch.index_count += static_cast<int>( indices.size() );
+
+		m_last_index_count += static_cast<GLsizei>( indices.size() );
+	}
+
+	m_batches.push_back( current_batch );
+
+	m_frame_statistics.batch_count = m_batches.size();
+
+	if( first_changed_index < static_cast<std::size_t>( m_last_index_count ) ) {
+		m_frame_statistics.rebuilt_index_count += static_cast<std::size_t>( m_last_index_count ) - first_changed_index;
+	}
+
+	if( m_use_short_indices ) {
+		m_short_index_data.resize( static_cast<std::size_t>( m_last_index_count ) );
+	}
+	else {
+		m_index_data.resize( static_cast<std::size_t>( m_last_index_count ) );
+	}
+
+	return first_changed_index;
+}
+
+void NonLegacyRenderer::RefreshViewportOffsets() {
+	// Nothing but the viewport source origins changed. The
+	// geometry stays as it is, only the damage has to be found.
+	CollectDamage();
+
+	UpdateViewportOffsets();
+
+	m_vbo_sync_type = 0;
+}
+
+std::size_t NonLegacyRenderer::GetViewportOffsetIndex( const std::shared_ptr<RendererViewport>& viewport ) {
+	auto iter = m_viewport_offset_indices.find( viewport->GetId() );
+
+	if( iter != m_viewport_offset_indices.end() ) {
+		m_offset_viewport_sync_passes[iter->second] = m_sync_pass;
+
+		return iter->second;
+	}
+
+	// Reuse an entry that was released or append a new one.
+	std::size_t index = 1;
+
+	while( ( index < m_offset_viewports.size() ) && m_offset_viewports[index] ) {
+		++index;
+	}
+
+	if( index >= max_viewport_offsets ) {
+		m_viewport_offsets_exhausted = true;
+
+		return 0;
+	}
+
+	if( index == m_offset_viewports.size() ) {
+		m_offset_viewports.emplace_back();
+		m_offset_viewport_sync_passes.emplace_back();
+		m_viewport_offsets.emplace_back();
+	}
+
+	m_offset_viewports[index] = viewport;
+	m_offset_viewport_sync_passes[index] = m_sync_pass;
+	m_viewport_offset_indices[viewport->GetId()] = index;
+
+	return index;
+}
+
+void NonLegacyRenderer::UpdateViewportOffsets() {
+	for( std::size_t index = 1; index < m_offset_viewports.size(); ++index ) {
+		const auto& viewport = m_offset_viewports[index];
+
+		m_viewport_offsets[index] = viewport ? ( viewport->GetDestinationOrigin() - viewport->GetSourceOrigin() ) : sf::Vector2f( 0.f, 0.f );
+	}
+}
+
+void NonLegacyRenderer::ReleaseViewportOffsets() {
+	// Every primitive referencing an entry was visited during this
+	// sync pass, entries that weren't touched are no longer in use.
+	for( std::size_t index = 1; index < m_offset_viewports.size(); ++index ) {
+		if( m_offset_viewports[index] && ( m_offset_viewport_sync_passes[index] != m_sync_pass ) ) {
+			m_viewport_offset_indices.erase( m_offset_viewports[index]->GetId() );
+			m_offset_viewports[index].reset();
+		}
+	}
+
+	while( ( m_offset_viewports.size() > 1 ) && !m_offset_viewports.back() ) {
+		m_offset_viewports.pop_back();
+		m_offset_viewport_sync_passes.pop_back();
+		m_viewport_offsets.pop_back();
+	}
+}
+
+bool NonLegacyRenderer::AllocateVertexSlot( priv::RendererBufferSlot& slot, std::size_t vertex_count ) {
+	// First fit over the free ranges. The ranges are kept
+	// coalesced by FreeVertexSlot so there are never many.
+	for( auto iter = m_free_vertex_ranges.begin(); iter != m_free_vertex_ranges.end(); ++iter ) {
+		if( iter->second < vertex_count ) {
+			continue;
+		}
+
+		auto offset = iter->first;
+		auto remaining = iter->second - vertex_count;
+
+		m_free_vertex_ranges.erase( iter );
+
+		if( remaining ) {
+			m_free_vertex_ranges[offset + vertex_count] = remaining;
+		}
+
+		slot.offset = offset;
+		slot.capacity = vertex_count;
+		slot.vertex_count = 0;
+
+		return true;
+	}
+
+	return false;
+}
+
+void NonLegacyRenderer::FreeVertexSlot( priv::RendererBufferSlot& slot ) {
+	if( !slot.capacity ) {
+		return;
+	}
+
+	auto offset = slot.offset;
+	auto size = slot.capacity;
+
+	slot.offset = 0;
+	slot.capacity = 0;
+	slot.vertex_count = 0;
+
+	// Merge with the following range.
+	auto next = m_free_vertex_ranges.lower_bound( offset );
+
+	if( ( next != m_free_vertex_ranges.end() ) && ( next->first == offset + size ) ) {
+		size += next->second;
+		next = m_free_vertex_ranges.erase( next );
+	}
+
+	// Merge with the preceding range.
+	if( next != m_free_vertex_ranges.begin() ) {
+		auto previous = std::prev( next );
+
+		if( previous->first + previous->second == offset ) {
+			previous->second += size;
+			return;
+		}
+	}
+
+	m_free_vertex_ranges[offset] = size;
+}
+
+void NonLegacyRenderer::RepackVertexSlots() {
+	std::size_t required_capacity = 0;
+
+	for( const auto& primitive_ptr : m_primitives ) {
+		if( !primitive_ptr->GetCustomDrawCallback() ) {
+			required_capacity += primitive_ptr->GetVertices().size();
+		}
+	}
+
+	// Grow geometrically so that adding primitives one
+	// at a time does not repack on every single sync.
+	m_vertex_capacity = std::max( m_vertex_capacity * 2, required_capacity );
+
+	m_free_vertex_ranges.clear();
+
+	// Lay the slots out in draw order, this keeps
+	// batch index ranges as tight as possible.
+	std::size_t offset = 0;
+
+	for( const auto& primitive_ptr : m_primitives ) {
+		auto iter = m_vertex_slots.find( primitive_ptr.get() );
+
+		if( iter == m_vertex_slots.end() ) {
+			continue;
+		}
+
+		auto& slot = iter->second;
+
+		slot.offset = offset;
+		slot.capacity = primitive_ptr->GetVertices().size();
+		slot.vertex_count = 0;
+
+		offset += slot.capacity;
+	}
+
+	assert( offset <= m_vertex_capacity );
+
+	if( offset < m_vertex_capacity ) {
+		m_free_vertex_ranges[offset] = m_vertex_capacity - offset;
+	}
+}
+
+void NonLegacyRenderer::AllocateTransform( priv::RendererBufferSlot& slot ) {
+	if( !m_free_transforms.empty() ) {
+		slot.transform_index = m_free_transforms.back();
+		m_free_transforms.pop_back();
+	}
+	else {
+		slot.transform_index = m_transform_count++;
+
+		if( m_transform_data.size() < m_transform_count ) {
+			m_transform_data.resize( std::max( m_transform_data.size() * 2, transform_texture_width ) );
+		}
+	}
+
+	// The entry might still hold the translation of a previous owner.
+	WriteTransform( slot, sf::Vector2f( 0.f, 0.f ) );
+}
+
+void NonLegacyRenderer::FreeTransform( priv::RendererBufferSlot& slot ) {
+	m_free_transforms.push_back( slot.transform_index );
+}
+
+void NonLegacyRenderer::WriteTransform( priv::RendererBufferSlot& slot, const sf::Vector2f& position_transform ) {
+	slot.position_transform = position_transform;
+
+	m_transform_data[slot.transform_index] = position_transform;
+	m_dirty_transforms.push_back( slot.transform_index );
+}
+
+void NonLegacyRenderer::WriteVertexSlot( Primitive& primitive, priv::RendererBufferSlot& slot ) {
+	const auto max_texture_size = GetMaxTextureSize();
+	const auto default_texture_size = m_texture_atlas[0]->getSize();
+
+	const auto& vertices = primitive.GetVertices();
+	const auto vertices_size = vertices.size();
+
+	assert( vertices_size <= slot.capacity );
+
+	slot.vertex_count = vertices_size;
+
+	// Without a texture array only one page can be bound per slot.
+	slot.atlas_page = GetAtlasPage( primitive );
+
+	for( std::size_t index = 0; index < vertices_size; ++index ) {
+		const auto& vertex = vertices[index];
+		const auto& position = vertex.position;
+		const auto destination = slot.offset + index;
+
+		auto& destination_vertex = m_vertex_data[destination];
+
+		destination_vertex.vertex.position = position;
+		destination_vertex.vertex.color = vertex.color;
+		destination_vertex.transform_index = static_cast<float>( slot.transform_index );
+
+		// Glyphs of one text can lie on different pages, look the page up per vertex.
+		const auto atlas_page = static_cast<int>( vertex.texture_coordinate.y ) / max_texture_size;
+		const auto texture_size = m_use_texture_array ? m_atlas_array_size : ( ( vertex.texture_coordinate.y <= 1.f ) ? default_texture_size : m_texture_atlas[static_cast<std::size_t>( atlas_page )]->getSize() );
+
+		// Used to normalize texture coordinates.
+		const sf::Vector2f normalizer( 1.f / static_cast<float>( texture_size.x ), 1.f / static_cast<float>( texture_size.y ) );
+
+		// Normalize SFML's pixel texture coordinates.
+		destination_vertex.vertex.SetTextureCoordinate( sf::Vector2f( vertex.texture_coordinate.x * normalizer.x, static_cast<float>( static_cast<int>( vertex.texture_coordinate.y ) % max_texture_size ) * normalizer.y ) );
+		destination_vertex.texture_layer = static_cast<sf::Uint16>( atlas_page );
+		destination_vertex.viewport_index = static_cast<sf::Uint16>( slot.viewport_index );
+	}
+}
+
+void NonLegacyRenderer::UploadVertexData() {
+	if( m_vertex_vbo_capacity != m_vertex_capacity ) {
+		// Storage was (re)allocated, respecify the buffer entirely.
+		m_vertex_vbo_capacity = m_vertex_capacity;
+
+		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_vertex_vbo ) );
+		CheckGLError( GLEXT_glBufferData( GLEXT_GL_ARRAY_BUFFER, static_cast<int>( m_vertex_capacity * sizeof( priv::RendererShaderVertex ) ), m_vertex_data.data(), GLEXT_GL_DYNAMIC_DRAW ) );
+		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, 0 ) );
+
+		m_frame_statistics.uploaded_vertex_bytes += m_vertex_capacity * sizeof( priv::RendererShaderVertex );
+
+		m_dirty_vertex_ranges.clear();
+
+		return;
+	}
+
+	if( m_dirty_vertex_ranges.empty() ) {
+		return;
+	}
+
+	MergeRanges( m_dirty_vertex_ranges );
+
+	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_vertex_vbo ) );
+
+	for( const auto& range : m_dirty_vertex_ranges ) {
+		CheckGLError( GLEXT_glBufferSubData( GLEXT_GL_ARRAY_BUFFER, static_cast<int>( range.first * sizeof( priv::RendererShaderVertex ) ), static_cast<int>( range.second * sizeof( priv::RendererShaderVertex ) ), m_vertex_data.data() + range.first ) );
+
+		m_frame_statistics.uploaded_vertex_bytes += range.second * sizeof( priv::RendererShaderVertex );
+	}
+
+	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, 0 ) );
+
+	m_dirty_vertex_ranges.clear();
+}
+
+void NonLegacyRenderer::UploadIndexData( std::size_t first_changed_index ) {
+	const auto index_count = static_cast<std::size_t>( m_last_index_count );
+
+	if( !index_count ) {
+		return;
+	}
+
+	const auto index_size = m_use_short_indices ? sizeof( GLushort ) : sizeof( GLuint );
+	const auto index_data = m_use_short_indices ? static_cast<const void*>( m_short_index_data.data() ) : static_cast<const void*>( m_index_data.data() );
+
+	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, m_index_vbo ) );
+
+	if( index_count > m_index_vbo_capacity ) {
+		// Leave some headroom so a couple of new primitives
+		// don't force the buffer to be respecified again.
+		m_index_vbo_capacity = index_count + index_count / 2;
+
+		CheckGLError( GLEXT_glBufferData( GLEXT_GL_ELEMENT_ARRAY_BUFFER, static_cast<int>( m_index_vbo_capacity * index_size ), 0, GLEXT_GL_DYNAMIC_DRAW ) );
+
+		first_changed_index = 0;
+	}
+
+	if( first_changed_index < index_count ) {
+		CheckGLError( GLEXT_glBufferSubData( GLEXT_GL_ELEMENT_ARRAY_BUFFER, static_cast<int>( first_changed_index * index_size ), static_cast<int>( ( index_count - first_changed_index ) * index_size ), static_cast<const char*>( index_data ) + first_changed_index * index_size ) );
+
+		m_frame_statistics.uploaded_index_bytes += ( index_count - first_changed_index ) * index_size;
+	}
+
+	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, 0 ) );
+}
+
+void NonLegacyRenderer::UploadTransformData() {
+	const auto rows = m_transform_data.size() / transform_texture_width;
+
+	if( !rows ) {
+		return;
+	}
+
+	CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 + 2 ) );
+
+	auto old_texture_id = 0u;
+	CheckGLError( glGetIntegerv( GL_TEXTURE_BINDING_2D, reinterpret_cast<GLint*>( &old_texture_id ) ) );
+
+	CheckGLError( glBindTexture( GL_TEXTURE_2D, m_transform_texture ) );
+
+	if( rows != m_transform_texture_rows ) {
+		// Storage was (re)allocated, respecify the texture entirely.
+		m_transform_texture_rows = rows;
+
+		CheckGLError( glTexImage2D( GL_TEXTURE_2D, 0, GLEXT_GL_RG32F, static_cast<GLsizei>( transform_texture_width ), static_cast<GLsizei>( rows ), 0, GLEXT_GL_RG, GL_FLOAT, m_transform_data.data() ) );
+
+		m_frame_statistics.uploaded_texture_bytes += m_transform_data.size() * sizeof( m_transform_data[0] );
+		CheckGLError( glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST ) );
+		CheckGLError( glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST ) );
+	}
+	else if( !m_dirty_transforms.empty() ) {
+		// Upload the dirty span of every row that was touched. Moving
+		// a window usually touches a handful of neighbouring entries.
+		std::sort( m_dirty_transforms.begin(), m_dirty_transforms.end() );
+
+		auto span_begin = m_dirty_transforms.begin();
+
+		while( span_begin != m_dirty_transforms.end() ) {
+			const auto row = *span_begin / transform_texture_width;
+			auto span_end = span_begin;
+
+			while( ( std::next( span_end ) != m_dirty_transforms.end() ) && ( *std::next( span_end ) / transform_texture_width == row ) ) {
+				++span_end;
+			}
+
+			const auto first = *span_begin;
+			const auto count = *span_end - first + 1;
+
+			CheckGLError( glTexSubImage2D( GL_TEXTURE_2D, 0, static_cast<GLint>( first % transform_texture_width ), static_cast<GLint>( row ), static_cast<GLsizei>( count ), 1, GLEXT_GL_RG, GL_FLOAT, m_transform_data.data() + first ) );
+
+			m_frame_statistics.uploaded_texture_bytes += count * sizeof( m_transform_data[0] );
+
+			span_begin = std::next( span_end );
+		}
+	}
+
+	CheckGLError( glBindTexture( GL_TEXTURE_2D, old_texture_id ) );
+
+	CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 ) );
+
+	m_dirty_transforms.clear();
+}
+
+void NonLegacyRenderer::StreamBufferData( std::size_t first_changed_index ) {
+	const auto segment_count = streaming_ring_supported ? stream_segment_count : 1;
+	const auto index_count = static_cast<std::size_t>( m_last_index_count );
+	const auto index_size = m_use_short_indices ? sizeof( GLushort ) : sizeof( GLuint );
+
+	auto respecify = false;
+
+	if( m_vertex_vbo_capacity != m_vertex_capacity ) {
+		m_vertex_vbo_capacity = m_vertex_capacity;
+		respecify = true;
+	}
+
+	if( index_count > m_index_vbo_capacity ) {
+		// Leave some headroom so a couple of new primitives
+		// don't force the buffer to be respecified again.
+		m_index_vbo_capacity = index_count + index_count / 2;
+		respecify = true;
+	}
+
+	if( respecify ) {
+		// Storage was (re)allocated for every segment, each of
+		// them has to be filled entirely before it is drawn from.
+		DeleteStreamFences();
+
+		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_vertex_vbo ) );
+		CheckGLError( GLEXT_glBufferData( GLEXT_GL_ARRAY_BUFFER, static_cast<int>( segment_count * m_vertex_vbo_capacity * sizeof( priv::RendererShaderVertex ) ), nullptr, GLEXT_GL_STREAM_DRAW ) );
+
+		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, m_index_vbo ) );
+		CheckGLError( GLEXT_glBufferData( GLEXT_GL_ELEMENT_ARRAY_BUFFER, static_cast<int>( segment_count * m_index_vbo_capacity * index_size ), nullptr, GLEXT_GL_STREAM_DRAW ) );
+
+		for( std::size_t segment = 0; segment < segment_count; ++segment ) {
+			m_stream_dirty_ranges[segment].assign( 1, std::make_pair( std::size_t( 0 ), m_vertex_vbo_capacity ) );
+			m_stream_first_changed_indices[segment] = 0;
+		}
+	}
+	else if( m_dirty_vertex_ranges.empty() && ( first_changed_index >= index_count ) ) {
+		return;
+	}
+	else {
+		// Every segment in use has to catch up on
+		// the changes the next time it is written to.
+		for( std::size_t segment = 0; segment < segment_count; ++segment ) {
+			m_stream_dirty_ranges[segment].insert( m_stream_dirty_ranges[segment].end(), m_dirty_vertex_ranges.begin(), m_dirty_vertex_ranges.end() );
+			m_stream_first_changed_indices[segment] = std::min( m_stream_first_changed_indices[segment], first_changed_index );
+		}
+	}
+
+	m_dirty_vertex_ranges.clear();
+
+	const auto index_data = m_use_short_indices ? static_cast<const void*>( m_short_index_data.data() ) : static_cast<const void*>( m_index_data.data() );
+
+	if( !streaming_ring_supported ) {
+		// Without fences there is no telling when the GPU is done with
+		// the buffers. Orphan them instead, the driver hands out fresh
+		// storage while the old one is still being drawn from.
+		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_vertex_vbo ) );
+		CheckGLError( GLEXT_glBufferData( GLEXT_GL_ARRAY_BUFFER, static_cast<int>( m_vertex_vbo_capacity * sizeof( priv::RendererShaderVertex ) ), m_vertex_data.data(), GLEXT_GL_STREAM_DRAW ) );
+
+		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, m_index_vbo ) );
+		CheckGLError( GLEXT_glBufferData( GLEXT_GL_ELEMENT_ARRAY_BUFFER, static_cast<int>( m_index_vbo_capacity * index_size ), nullptr, GLEXT_GL_STREAM_DRAW ) );
+		CheckGLError( GLEXT_glBufferSubData( GLEXT_GL_ELEMENT_ARRAY_BUFFER, 0, static_cast<int>( index_count * index_size ), index_data ) );
+
+		m_frame_statistics.uploaded_vertex_bytes += m_vertex_vbo_capacity * sizeof( priv::RendererShaderVertex );
+		m_frame_statistics.uploaded_index_bytes += index_count * index_size;
+
+		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, 0 ) );
+		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, 0 ) );
+
+		m_stream_dirty_ranges[0].clear();
+		m_stream_first_changed_indices[0] = std::numeric_limits<std::size_t>::max();
+
+		return;
+	}
+
+	m_stream_segment = ( m_stream_segment + 1 ) % stream_segment_count;
+
+	WaitForStreamSegment( m_stream_segment );
+
+	auto& ranges = m_stream_dirty_ranges[m_stream_segment];
+
+	MergeRanges( ranges );
+
+	for( const auto& range : ranges ) {
+		m_frame_statistics.uploaded_vertex_bytes += range.second * sizeof( priv::RendererShaderVertex );
+	}
+
+	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_vertex_vbo ) );
+	StreamRanges( GLEXT_GL_ARRAY_BUFFER, m_stream_segment * m_vertex_vbo_capacity, m_vertex_data.data(), ranges );
+	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, 0 ) );
+
+	ranges.clear();
+
+	auto& first_index = m_stream_first_changed_indices[m_stream_segment];
+
+	if( first_index < index_count ) {
+		const std::vector<std::pair<std::size_t, std::size_t>> index_ranges( 1, std::make_pair( first_index, index_count - first_index ) );
+		const auto first_segment_index = m_stream_segment * m_index_vbo_capacity;
+
+		m_frame_statistics.uploaded_index_bytes += ( index_count - first_index ) * index_size;
+
+		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, m_index_vbo ) );
+
+		if( m_use_short_indices ) {
+			StreamRanges( GLEXT_GL_ELEMENT_ARRAY_BUFFER, first_segment_index, m_short_index_data.data(), index_ranges );
+		}
+		else {
+			StreamRanges( GLEXT_GL_ELEMENT_ARRAY_BUFFER, first_segment_index, m_index_data.data(), index_ranges );
+		}
+
+		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, 0 ) );
+	}
+
+	first_index = std::numeric_limits<std::size_t>::max();
+}
+
+void NonLegacyRenderer::WaitForStreamSegment( std::size_t segment ) {
+	if( !m_stream_fences[segment] ) {
+		return;
+	}
+
+	auto fence = static_cast<GLEXT_GLsync>( m_stream_fences[segment] );
+
+	// With three segments in flight the GPU is almost
+	// always done with this one by the time we get here.
+	GLenum result = GLEXT_GL_TIMEOUT_EXPIRED;
+
+	while( ( result != GLEXT_GL_ALREADY_SIGNALED ) && ( result != GLEXT_GL_CONDITION_SATISFIED ) && ( result != GLEXT_GL_WAIT_FAILED ) ) {
+		result = CheckGLError( GLEXT_glClientWaitSync( fence, GLEXT_GL_SYNC_FLUSH_COMMANDS_BIT, stream_fence_timeout ) );
+	}
+
+	CheckGLError( GLEXT_glDeleteSync( fence ) );
+
+	m_stream_fences[segment] = nullptr;
+}
+
+void NonLegacyRenderer::InsertStreamFence() const {
+	if( !m_use_streaming_buffers || !streaming_ring_supported ) {
+		return;
+	}
+
+	auto& fence = m_stream_fences[m_stream_segment];
+
+	if( fence ) {
+		CheckGLError( GLEXT_glDeleteSync( static_cast<GLEXT_GLsync>( fence ) ) );
+	}
+
+	fence = CheckGLError( GLEXT_glFenceSync( GLEXT_GL_SYNC_GPU_COMMANDS_COMPLETE, 0 ) );
+}
+
+void NonLegacyRenderer::DeleteStreamFences() {
+	for( auto& fence : m_stream_fences ) {
+		if( fence ) {
+			CheckGLError( GLEXT_glDeleteSync( static_cast<GLEXT_GLsync>( fence ) ) );
+			fence = nullptr;
+		}
+	}
+}
+
+bool NonLegacyRenderer::UploadAtlasArray() {
+	// All layers share the size of the largest atlas page.
+	sf::Vector2u size;
+
+	for( const auto& page : m_texture_atlas ) {
+		size.x = std::max( size.x, page->getSize().x );
+		size.y = std::max( size.y, page->getSize().y );
+	}
+
+	auto reallocated = false;
+
+	CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 + 3 ) );
+
+	auto old_texture_id = 0u;
+	CheckGLError( glGetIntegerv( GLEXT_GL_TEXTURE_BINDING_2D_ARRAY, reinterpret_cast<GLint*>( &old_texture_id ) ) );
+
+	CheckGLError( glBindTexture( GLEXT_GL_TEXTURE_2D_ARRAY, m_atlas_array_texture ) );
+
+	if( ( size != m_atlas_array_size ) || ( m_texture_atlas.size() != m_atlas_array_layers ) ) {
+		// Storage was (re)allocated, copy every page over again.
+		m_atlas_array_size = size;
+		m_atlas_array_layers = m_texture_atlas.size();
+
+		CheckGLError( glTexImage3D( GLEXT_GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, static_cast<GLsizei>( size.x ), static_cast<GLsizei>( size.y ), static_cast<GLsizei>( m_atlas_array_layers ), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr ) );
+		CheckGLError( glTexParameteri( GLEXT_GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST ) );
+		CheckGLError( glTexParameteri( GLEXT_GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST ) );
+
+		m_dirty_atlas_rects.clear();
+
+		for( std::size_t page = 0; page < m_texture_atlas.size(); ++page ) {
+			const auto page_size = static_cast<sf::Vector2i>( m_texture_atlas[page]->getSize() );
+
+			m_dirty_atlas_rects.emplace_back( page, sf::IntRect( sf::Vector2i( 0, 0 ), page_size ) );
+		}
+
+		reallocated = true;
+	}
+
+	if( !m_dirty_atlas_rects.empty() ) {
+		// Copy the changed regions from the page textures into
+		// their layers without a round trip through system memory.
+		GLuint frame_buffer = 0;
+
+		auto old_frame_buffer = 0u;
+		CheckGLError( glGetIntegerv( GL_FRAMEBUFFER_BINDING_EXT, reinterpret_cast<GLint*>( &old_frame_buffer ) ) );
+
+		CheckGLError( GLEXT_glGenFramebuffers( 1, &frame_buffer ) );
+		CheckGLError( GLEXT_glBindFramebuffer( GLEXT_GL_FRAMEBUFFER, frame_buffer ) );
+
+		auto attached_page = std::numeric_limits<std::size_t>::max();
+
+		for( const auto& dirty_rect : m_dirty_atlas_rects ) {
+			const auto& rect = dirty_rect.second;
+
+			if( ( dirty_rect.first >= m_atlas_array_layers ) || ( rect.width <= 0 ) || ( rect.height <= 0 ) ) {
+				continue;
+			}
+
+			if( dirty_rect.first != attached_page ) {
+				attached_page = dirty_rect.first;
+
+				CheckGLError( GLEXT_glFramebufferTexture2D( GLEXT_GL_FRAMEBUFFER, GLEXT_GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture_atlas[attached_page]->getNativeHandle(), 0 ) );
+			}
+
+			CheckGLError( glCopyTexSubImage3D( GLEXT_GL_TEXTURE_2D_ARRAY, 0, rect.left, rect.top, static_cast<GLint>( attached_page ), rect.left, rect.top, rect.width, rect.height ) );
+		}
+
+		CheckGLError( GLEXT_glBindFramebuffer( GLEXT_GL_FRAMEBUFFER, old_frame_buffer ) );
+		CheckGLError( GLEXT_glDeleteFramebuffers( 1, &frame_buffer ) );
+
+		m_dirty_atlas_rects.clear();
+	}
+
+	CheckGLError( glBindTexture( GLEXT_GL_TEXTURE_2D_ARRAY, old_texture_id ) );
+
+	CheckGLError( GLEXT_glActiveTexture( GLEXT_GL_TEXTURE0 ) );
+
+	return reallocated;
+}
+
+void NonLegacyRenderer::InvalidateVBO( unsigned char datasets ) {
+	m_vbo_sync_type |= datasets;
+	m_vbo_synced = false;
+}
+
+void NonLegacyRenderer::SetupFBO( int width, int height ) {
+	if( !m_use_fbo || !width || !height ) {
+		DestroyFBO();
+
+		return;
+	}
+
+	// Create FBO.
+	if( !m_frame_buffer ) {
+		CheckGLError( GLEXT_glGenFramebuffers( 1, &m_frame_buffer ) );
 	}
 
 	CheckGLError( GLEXT_glBindFramebuffer( GLEXT_GL_FRAMEBUFFER, m_frame_buffer ) );
@@ -958,6 +2092,7 @@ void NonLegacyRenderer::DestroyFBO() {
 
 void NonLegacyRenderer::TuneCull( bool enable ) {
 	m_cull = enable;
+	m_cull_grids_valid = false;
 }
 
 void NonLegacyRenderer::TuneUseFBO( bool enable ) {
@@ -971,48 +2106,223 @@ void NonLegacyRenderer::TuneUseFBO( bool enable ) {
 
 	if( m_use_fbo ) {
 		SetupFBO( m_window_size.x, m_window_size.y );
+
+		// The new FBO doesn't hold anything yet.
+		Redraw();
 	}
 	else {
 		DestroyFBO();
 	}
 }
 
+void NonLegacyRenderer::TuneUseTextureArray( bool enable ) {
+	if( !fbo_supported && enable ) {
+#if defined( SFGUI_DEBUG )
+		std::cerr << "FBO extension unavailable, texture array atlas disabled.\n";
+#endif
+	}
+
+	m_use_texture_array = enable && fbo_supported;
+
+	// Texture coordinates are normalized differently in both modes,
+	// forget the sizes we know of so everything gets rewritten.
+	m_atlas_page_sizes.clear();
+	m_atlas_array_size = sf::Vector2u();
+	m_atlas_array_layers = 0;
+	m_dirty_atlas_rects.clear();
+
+	InvalidateVBO( INVALIDATE_TEXTURE );
+}
+
+void NonLegacyRenderer::TuneUseStreamingBuffers( bool enable ) {
+	if( !streaming_ring_supported && enable ) {
+#if defined( SFGUI_DEBUG )
+		std::cerr << "Buffer mapping or sync extension unavailable, streaming buffers fall back to orphaning.\n";
+#endif
+	}
+
+	if( m_use_streaming_buffers == enable ) {
+		return;
+	}
+
+	m_use_streaming_buffers = enable;
+
+	// Both modes lay out the buffers differently. Force them to be
+	// respecified and the vertex array object to be set up again.
+	DeleteStreamFences();
+
+	m_stream_segment = 0;
+	m_vertex_vbo_capacity = 0;
+	m_index_vbo_capacity = 0;
+
+	if( m_vao ) {
+		CheckGLError( GLEXT_glDeleteVertexArrays( 1, &m_vao ) );
+		m_vao = 0;
+	}
+
+	InvalidateVBO( INVALIDATE_VERTEX );
+}
+
+void NonLegacyRenderer::ForgetTargetImpl( const void* target, bool current ) {
+	priv::RendererTargetObjects objects;
+
+	if( current ) {
+		objects.frame_buffer = m_frame_buffer;
+		objects.frame_buffer_texture = m_frame_buffer_texture;
+		objects.fbo_vbo = m_fbo_vbo;
+		objects.fbo_vao = m_fbo_vao;
+		objects.vao = m_vao;
+
+		m_frame_buffer = 0;
+		m_frame_buffer_texture = 0;
+		m_fbo_vbo = 0;
+		m_fbo_vao = 0;
+		m_vao = 0;
+	}
+	else {
+		auto iter = m_target_objects.find( target );
+
+		if( iter == m_target_objects.end() ) {
+			return;
+		}
+
+		objects = iter->second;
+
+		m_target_objects.erase( iter );
+	}
+
+	if( objects.vao ) {
+		CheckGLError( GLEXT_glDeleteVertexArrays( 1, &objects.vao ) );
+	}
+
+	if( objects.fbo_vao ) {
+		CheckGLError( GLEXT_glDeleteVertexArrays( 1, &objects.fbo_vao ) );
+	}
+
+	if( objects.fbo_vbo ) {
+		CheckGLError( GLEXT_glDeleteBuffers( 1, &objects.fbo_vbo ) );
+	}
+
+	if( objects.frame_buffer ) {
+		CheckGLError( GLEXT_glDeleteFramebuffers( 1, &objects.frame_buffer ) );
+	}
+
+	if( objects.frame_buffer_texture ) {
+		CheckGLError( glDeleteTextures( 1, &objects.frame_buffer_texture ) );
+	}
+}
+
 void NonLegacyRenderer::InvalidateImpl( unsigned char datasets ) {
 	InvalidateVBO( datasets );
 }
 
+void NonLegacyRenderer::SelectTargetImpl( const void* previous_target, const void* target ) const {
+	auto self = const_cast<NonLegacyRenderer*>( this );
+
+	if( previous_target ) {
+		auto& previous_objects = m_target_objects[previous_target];
+		previous_objects.frame_buffer = m_frame_buffer;
+		previous_objects.frame_buffer_texture = m_frame_buffer_texture;
+		previous_objects.fbo_vbo = m_fbo_vbo;
+		previous_objects.fbo_vao = m_fbo_vao;
+		previous_objects.vao = m_vao;
+	}
+
+	auto iter = m_target_objects.find( target );
+
+	// The first target keeps whatever was set up before anything was drawn.
+	if( previous_target || ( iter != m_target_objects.end() ) ) {
+		priv::RendererTargetObjects objects;
+
+		if( iter != m_target_objects.end() ) {
+			objects = iter->second;
+
+			m_target_objects.erase( iter );
+		}
+
+		// Missing vertex array objects are set up again when drawing.
+		self->m_frame_buffer = objects.frame_buffer;
+		self->m_frame_buffer_texture = objects.frame_buffer_texture;
+		self->m_fbo_vbo = objects.fbo_vbo;
+		self->m_fbo_vao = objects.fbo_vao;
+		self->m_vao = objects.vao;
+	}
+
+	// The viewport only gets set when a target's size changes.
+	CheckGLError( glViewport( 0, 0, m_window_size.x, m_window_size.y ) );
+
+	// FBO caching might have been enabled while another target was drawn to.
+	if( m_use_fbo && !m_frame_buffer && m_window_size.x && m_window_size.y ) {
+		self->SetupFBO( m_window_size.x, m_window_size.y );
+
+		m_force_redraw = true;
+	}
+
+	// Vertex data is laid out in window coordinates and can be
+	// drawn to any target, unless culling threw some of it away.
+	if( m_cull ) {
+		self->InvalidateVBO( INVALIDATE_VERTEX );
+	}
+}
+
+void NonLegacyRenderer::InvalidateAtlasImpl( std::size_t page, const sf::IntRect& rect ) {
+	if( !m_use_texture_array ) {
+		return;
+	}
+
+	m_dirty_atlas_rects.emplace_back( page, rect );
+
+	InvalidateVBO( INVALIDATE_TEXTURE );
+}
+
 void NonLegacyRenderer::SetupVAO() {
 	CheckGLError( GLEXT_glGenVertexArrays( 1, &m_vao ) );
 	CheckGLError( GLEXT_glBindVertexArray( m_vao ) );
 
 	assert( m_vertex_vbo != 0 );
-	assert( m_color_vbo != 0 );
-	assert( m_texture_vbo != 0 );
 	assert( m_index_vbo != 0 );
 	assert( m_vao != 0 );
 
+	SetupVertexAttributes( 0 );
+
+	CheckGLError( GLEXT_glBindVertexArray( 0 ) );
+
+	CheckGLError( GLEXT_glDisableVertexAttribArray( m_viewport_index_location ) );
+	CheckGLError( GLEXT_glDisableVertexAttribArray( m_texture_layer_location ) );
+	CheckGLError( GLEXT_glDisableVertexAttribArray( m_transform_index_location ) );
+	CheckGLError( GLEXT_glDisableVertexAttribArray( m_texture_coordinate_location ) );
+	CheckGLError( GLEXT_glDisableVertexAttribArray( m_color_location ) );
+	CheckGLError( GLEXT_glDisableVertexAttribArray( m_vertex_location ) );
+
+	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, 0 ) );
+	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, 0 ) );
+}
+
+void NonLegacyRenderer::SetupVertexAttributes( std::size_t first_vertex ) const {
+	const auto stride = static_cast<GLsizei>( sizeof( priv::RendererShaderVertex ) );
+	const auto base = first_vertex * sizeof( priv::RendererShaderVertex ) + offsetof( priv::RendererShaderVertex, vertex );
+
 	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_vertex_vbo ) );
+
 	CheckGLError( GLEXT_glEnableVertexAttribArray( m_vertex_location ) );
-	CheckGLError( GLEXT_glVertexAttribPointer( m_vertex_location, 2, GL_FLOAT, GL_FALSE, 0, 0 ) );
+	CheckGLError( GLEXT_glVertexAttribPointer( m_vertex_location, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<GLvoid*>( base + offsetof( priv::RendererVertex, position ) ) ) );
 
-	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_color_vbo ) );
 	CheckGLError( GLEXT_glEnableVertexAttribArray( m_color_location ) );
-	CheckGLError( GLEXT_glVertexAttribPointer( m_color_location, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, 0 ) );
+	CheckGLError( GLEXT_glVertexAttribPointer( m_color_location, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, reinterpret_cast<GLvoid*>( base + offsetof( priv::RendererVertex, color ) ) ) );
 
-	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_texture_vbo ) );
 	CheckGLError( GLEXT_glEnableVertexAttribArray( m_texture_coordinate_location ) );
-	CheckGLError( GLEXT_glVertexAttribPointer( m_texture_coordinate_location, 2, GL_FLOAT, GL_FALSE, 0, 0 ) );
+	CheckGLError( GLEXT_glVertexAttribPointer( m_texture_coordinate_location, 2, GL_SHORT, GL_TRUE, stride, reinterpret_cast<GLvoid*>( base + offsetof( priv::RendererVertex, texture_coordinate ) ) ) );
 
-	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, m_index_vbo ) );
+	CheckGLError( GLEXT_glEnableVertexAttribArray( m_transform_index_location ) );
+	CheckGLError( GLEXT_glVertexAttribPointer( m_transform_index_location, 1, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<GLvoid*>( first_vertex * sizeof( priv::RendererShaderVertex ) + offsetof( priv::RendererShaderVertex, transform_index ) ) ) );
 
-	CheckGLError( GLEXT_glBindVertexArray( 0 ) );
+	CheckGLError( GLEXT_glEnableVertexAttribArray( m_texture_layer_location ) );
+	CheckGLError( GLEXT_glVertexAttribPointer( m_texture_layer_location, 1, GL_UNSIGNED_SHORT, GL_FALSE, stride, reinterpret_cast<GLvoid*>( first_vertex * sizeof( priv::RendererShaderVertex ) + offsetof( priv::RendererShaderVertex, texture_layer ) ) ) );
 
-	CheckGLError( GLEXT_glDisableVertexAttribArray( m_texture_coordinate_location ) );
-	CheckGLError( GLEXT_glDisableVertexAttribArray( m_color_location ) );
-	CheckGLError( GLEXT_glDisableVertexAttribArray( m_vertex_location ) );
+	CheckGLError( GLEXT_glEnableVertexAttribArray( m_viewport_index_location ) );
+	CheckGLError( GLEXT_glVertexAttribPointer( m_viewport_index_location, 1, GL_UNSIGNED_SHORT, GL_FALSE, stride, reinterpret_cast<GLvoid*>( first_vertex * sizeof( priv::RendererShaderVertex ) + offsetof( priv::RendererShaderVertex, viewport_index ) ) ) );
 
-	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, 0 ) );
-	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, 0 ) );
+	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, m_index_vbo ) );
 }
 
 void NonLegacyRenderer::SetupFBOVAO() {
@@ -0,0 +1,661 @@
+#include <SFGUI/Renderers/SoftwareRenderer.hpp>
+#include <SFGUI/RendererViewport.hpp>
+#include <SFGUI/Primitive.hpp>
+#include <SFGUI/PrimitiveVertex.hpp>
+
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/BlendMode.hpp>
+#include <SFML/Graphics/View.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/System/Clock.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+sf::Uint32 PackColor( const sf::Color& color ) {
+	const sf::Uint8 bytes[4] = { color.r, color.g, color.b, color.a };
+
+	sf::Uint32 pixel;
+	std::memcpy( &pixel, bytes, sizeof( pixel ) );
+
+	return pixel;
+}
+
+sf::Color UnpackColor( sf::Uint32 pixel ) {
+	sf::Uint8 bytes[4];
+	std::memcpy( bytes, &pixel, sizeof( pixel ) );
+
+	return sf::Color( bytes[0], bytes[1], bytes[2], bytes[3] );
+}
+
+sf::Uint8 BlendChannel( sf::Uint8 source, sf::Uint8 destination, int alpha ) {
+	return static_cast<sf::Uint8>( ( source * alpha + destination * ( 255 - alpha ) + 127 ) / 255 );
+}
+
+// The image is kept premultiplied, so it can be composited onto the target
+// without applying alpha a second time. The source is premultiplied here,
+// blending is GL_ONE, GL_ONE_MINUS_SRC_ALPHA for all channels.
+sf::Uint32 Blend( sf::Uint32 destination, const sf::Color& source ) {
+	if( source.a == 255 ) {
+		return PackColor( source );
+	}
+
+	if( !source.a ) {
+		return destination;
+	}
+
+	auto color = UnpackColor( destination );
+
+	color.r = BlendChannel( source.r, color.r, source.a );
+	color.g = BlendChannel( source.g, color.g, source.a );
+	color.b = BlendChannel( source.b, color.b, source.a );
+	color.a = BlendChannel( 255, color.a, source.a );
+
+	return PackColor( color );
+}
+
+// Every other channel of a packed pixel, each in its own 16 bit lane.
+const sf::Uint32 lane_mask = 0x00ff00ffu;
+
+// x / 255 == ( x + 1 + ( x >> 8 ) ) >> 8 for every value a lane holds here.
+sf::Uint32 DivideLanes( sf::Uint32 lanes ) {
+	return ( ( lanes + 0x00010001u + ( ( lanes >> 8 ) & lane_mask ) ) >> 8 ) & lane_mask;
+}
+
+// The part of BlendChannel() that only depends on the source,
+// source * alpha + 127, laid out like the lanes of a packed pixel.
+void GetSourceLanes( const sf::Color& source, sf::Uint32& even_lanes, sf::Uint32& odd_lanes ) {
+	const int terms[4] = { source.r * source.a + 127, source.g * source.a + 127, source.b * source.a + 127, 255 * source.a + 127 };
+
+	const auto low_bytes = PackColor( sf::Color(
+		static_cast<sf::Uint8>( terms[0] & 0xff ), static_cast<sf::Uint8>( terms[1] & 0xff ),
+		static_cast<sf::Uint8>( terms[2] & 0xff ), static_cast<sf::Uint8>( terms[3] & 0xff )
+	) );
+	const auto high_bytes = PackColor( sf::Color(
+		static_cast<sf::Uint8>( terms[0] >> 8 ), static_cast<sf::Uint8>( terms[1] >> 8 ),
+		static_cast<sf::Uint8>( terms[2] >> 8 ), static_cast<sf::Uint8>( terms[3] >> 8 )
+	) );
+
+	even_lanes = ( low_bytes & lane_mask ) | ( ( high_bytes & lane_mask ) << 8 );
+	odd_lanes = ( ( low_bytes >> 8 ) & lane_mask ) | ( high_bytes & ~lane_mask );
+}
+
+// Same result as Blend(), two channels at a time. A lane never
+// exceeds 255 * 255 + 127, so nothing carries into the next one.
+sf::Uint32 BlendLanes( sf::Uint32 destination, sf::Uint32 inverse_alpha, sf::Uint32 even_lanes, sf::Uint32 odd_lanes ) {
+	const auto even = DivideLanes( ( destination & lane_mask ) * inverse_alpha + even_lanes );
+	const auto odd = DivideLanes( ( ( destination >> 8 ) & lane_mask ) * inverse_alpha + odd_lanes );
+
+	return even | ( odd << 8 );
+}
+
+float EdgeFunction( const sf::Vector2f& begin, const sf::Vector2f& end, const sf::Vector2f& point ) {
+	return ( end.x - begin.x ) * ( point.y - begin.y ) - ( end.y - begin.y ) * ( point.x - begin.x );
+}
+
+// Pixels centered on an edge two triangles share may only be drawn once,
+// translucent quads would show a seam along their diagonal otherwise.
+// With consistent winding the shared edge runs in opposite directions
+// in both triangles, so only one of them includes it.
+bool IncludesEdge( const sf::Vector2f& begin, const sf::Vector2f& end ) {
+	return ( end.y > begin.y ) || ( ( end.y == begin.y ) && ( end.x > begin.x ) );
+}
+
+sf::Uint8 InterpolateChannel( float weight0, float weight1, float weight2, sf::Uint8 channel0, sf::Uint8 channel1, sf::Uint8 channel2 ) {
+	return static_cast<sf::Uint8>( std::min( 255.f, weight0 * channel0 + weight1 * channel1 + weight2 * channel2 + .5f ) );
+}
+
+// First pixel whose center lies at or beyond coordinate.
+int PixelBoundary( float coordinate ) {
+	return static_cast<int>( std::ceil( coordinate - .5f ) );
+}
+
+}
+
+namespace sfg {
+
+SoftwareRenderer::SoftwareRenderer() :
+	Renderer( true ),
+	m_dirty( true ) {
+}
+
+SoftwareRenderer::~SoftwareRenderer() {
+}
+
+SoftwareRenderer::Ptr SoftwareRenderer::Create() {
+	return Ptr( new SoftwareRenderer );
+}
+
+const std::string& SoftwareRenderer::GetName() const {
+	static const std::string name( "Software Renderer" );
+	return name;
+}
+
+void SoftwareRenderer::Display( sf::Window& target ) const {
+	m_window_size = static_cast<sf::Vector2i>( target.getSize() );
+
+	SelectTarget( &target );
+
+	BeginFrameStatistics();
+
+	DisplayImpl();
+
+	EndFrameStatistics();
+}
+
+void SoftwareRenderer::Display( sf::RenderWindow& target ) const {
+	m_window_size = static_cast<sf::Vector2i>( target.getSize() );
+
+	target.setActive( true );
+
+	SelectTarget( &target );
+
+	BeginFrameStatistics();
+
+	DisplayImpl();
+
+	Present( target );
+
+	EndFrameStatistics();
+}
+
+void SoftwareRenderer::Display( sf::RenderTexture& target ) const {
+	m_window_size = static_cast<sf::Vector2i>( target.getSize() );
+
+	target.setActive( true );
+
+	SelectTarget( &target );
+
+	BeginFrameStatistics();
+
+	DisplayImpl();
+
+	Present( target );
+
+	EndFrameStatistics();
+}
+
+void SoftwareRenderer::Rasterize( const sf::Vector2u& size ) const {
+	m_window_size = static_cast<sf::Vector2i>( size );
+
+	// Rasterizing without a target is a target of its own.
+	SelectTarget( this );
+
+	BeginFrameStatistics();
+
+	DisplayImpl();
+
+	EndFrameStatistics();
+}
+
+sf::Image SoftwareRenderer::GetImage() const {
+	sf::Image image;
+
+	if( !m_pixels.empty() ) {
+		image.create( static_cast<unsigned int>( m_last_window_size.x ), static_cast<unsigned int>( m_last_window_size.y ), GetPixels() );
+	}
+
+	return image;
+}
+
+const sf::Uint8* SoftwareRenderer::GetPixels() const {
+	return reinterpret_cast<const sf::Uint8*>( m_pixels.data() );
+}
+
+void SoftwareRenderer::DisplayImpl() const {
+	auto resized = false;
+
+	if( m_last_window_size != m_window_size ) {
+		m_last_window_size = m_window_size;
+
+		m_pixels.assign( static_cast<std::size_t>( std::max( m_window_size.x, 0 ) ) * static_cast<std::size_t>( std::max( m_window_size.y, 0 ) ), 0 );
+
+		resized = true;
+	}
+
+	// Rasterization is the refresh, time all of it.
+	sf::Clock refresh_clock;
+
+	if( m_dirty ) {
+		// See the disclaimer in the other renderers,
+		// the singleton instance is never const.
+		const_cast<SoftwareRenderer*>( this )->Refresh();
+	}
+
+	UpdateDamagedArea( resized || m_force_redraw );
+
+	m_force_redraw = false;
+
+	if( ( m_damaged_area.width <= 0 ) || ( m_damaged_area.height <= 0 ) ) {
+		m_frame_statistics.cache_hit = true;
+		return;
+	}
+
+	// The rest of the image is still valid, clear the damaged
+	// area and draw everything overlapping it back to front.
+	for( auto y = m_damaged_area.top; y < m_damaged_area.top + m_damaged_area.height; ++y ) {
+		std::fill_n( m_pixels.begin() + y * m_window_size.x + m_damaged_area.left, m_damaged_area.width, 0u );
+	}
+
+	m_frame_statistics.visible_primitive_count = 0;
+	m_frame_statistics.culled_primitive_count = 0;
+
+	for( const auto& primitive : m_primitives ) {
+		RasterizePrimitive( *primitive );
+	}
+
+	m_frame_statistics.refresh_time = refresh_clock.getElapsedTime();
+}
+
+void SoftwareRenderer::Refresh() {
+	SortPrimitives();
+	CollectDamage();
+
+	for( const auto& primitive : m_primitives ) {
+		primitive->SetSynced();
+	}
+
+	m_dirty = false;
+}
+
+void SoftwareRenderer::RasterizePrimitive( Primitive& primitive ) const {
+	// Custom draw callbacks issue OpenGL calls, there is nothing to rasterize.
+	if( !primitive.IsVisible() || primitive.GetCustomDrawCallback() ) {
+		return;
+	}
+
+	auto clip_rect = m_damaged_area;
+	auto offset = primitive.GetPosition();
+
+	auto viewport = primitive.GetViewport();
+
+	if( viewport && ( ( *viewport ) != ( *m_default_viewport ) ) ) {
+		const auto& destination_origin = viewport->GetDestinationOrigin();
+		const auto& size = viewport->GetSize();
+
+		offset += destination_origin - viewport->GetSourceOrigin();
+
+		const sf::IntRect viewport_rect( static_cast<int>( destination_origin.x ), static_cast<int>( destination_origin.y ), static_cast<int>( size.x ), static_cast<int>( size.y ) );
+
+		if( !m_damaged_area.intersects( viewport_rect, clip_rect ) ) {
+			++m_frame_statistics.culled_primitive_count;
+			return;
+		}
+	}
+
+	// Nothing outside of the clip rect gets touched, skip
+	// primitives that don't reach into it without looking at them.
+	const auto& bounds = primitive.GetBounds();
+
+	if( !sf::FloatRect( clip_rect ).intersects( sf::FloatRect( bounds.left + offset.x, bounds.top + offset.y, bounds.width, bounds.height ) ) ) {
+		++m_frame_statistics.culled_primitive_count;
+		return;
+	}
+
+	++m_frame_statistics.visible_primitive_count;
+
+	const auto& vertices = primitive.GetVertices();
+	const auto& indices = primitive.GetIndices();
+	const auto index_count = indices.size();
+
+	const PrimitiveVertex* corners[6];
+
+	for( std::size_t index = 0; index + 2 < index_count; ) {
+		const auto corner_count = std::min<std::size_t>( 6, index_count - index );
+
+		for( std::size_t corner = 0; corner < corner_count; ++corner ) {
+			corners[corner] = &vertices[indices[index + corner]];
+		}
+
+		if( ( corner_count == 6 ) && RasterizeQuad( corners, offset, clip_rect ) ) {
+			index += 6;
+			continue;
+		}
+
+		RasterizeTriangle( corners, offset, clip_rect );
+		index += 3;
+	}
+}
+
+bool SoftwareRenderer::RasterizeQuad( const PrimitiveVertex* const* vertices, const sf::Vector2f& offset, const sf::IntRect& clip_rect ) const {
+	// Most of the GUI consists of axis aligned quads, either in a single
+	// color or showing an unrotated part of the atlas such as a glyph.
+	// Those are filled row by row instead of being tested pixel by pixel.
+	const auto& color = vertices[0]->color;
+
+	auto minimum = vertices[0]->position;
+	auto maximum = vertices[0]->position;
+
+	for( std::size_t index = 1; index < 6; ++index ) {
+		if( vertices[index]->color != color ) {
+			return false;
+		}
+
+		minimum.x = std::min( minimum.x, vertices[index]->position.x );
+		minimum.y = std::min( minimum.y, vertices[index]->position.y );
+		maximum.x = std::max( maximum.x, vertices[index]->position.x );
+		maximum.y = std::max( maximum.y, vertices[index]->position.y );
+	}
+
+	if( ( minimum.x >= maximum.x ) || ( minimum.y >= maximum.y ) ) {
+		return false;
+	}
+
+	// Every vertex has to sit on a corner, each triangle has to cover three
+	// distinct corners and together they have to cover all four of them.
+	// The texture coordinates may only depend on the corner's x or y.
+	unsigned int triangle_corners[2] = { 0, 0 };
+	float u[2] = { 0.f, 0.f };
+	float v[2] = { 0.f, 0.f };
+	bool u_set[2] = { false, false };
+	bool v_set[2] = { false, false };
+
+	for( std::size_t index = 0; index < 6; ++index ) {
+		const auto& position = vertices[index]->position;
+		const auto& texture_coordinate = vertices[index]->texture_coordinate;
+
+		if( ( ( position.x != minimum.x ) && ( position.x != maximum.x ) ) || ( ( position.y != minimum.y ) && ( position.y != maximum.y ) ) ) {
+			return false;
+		}
+
+		const auto column = ( position.x == maximum.x ) ? 1u : 0u;
+		const auto row = ( position.y == maximum.y ) ? 1u : 0u;
+
+		triangle_corners[index / 3] |= 1u << ( row * 2 + column );
+
+		if( u_set[column] && ( u[column] != texture_coordinate.x ) ) {
+			return false;
+		}
+
+		if( v_set[row] && ( v[row] != texture_coordinate.y ) ) {
+			return false;
+		}
+
+		u[column] = texture_coordinate.x;
+		v[row] = texture_coordinate.y;
+		u_set[column] = true;
+		v_set[row] = true;
+	}
+
+	const auto corner_count = [] ( unsigned int mask ) {
+		return ( mask & 1u ) + ( ( mask >> 1 ) & 1u ) + ( ( mask >> 2 ) & 1u ) + ( ( mask >> 3 ) & 1u );
+	};
+
+	if( ( corner_count( triangle_corners[0] ) != 3 ) || ( corner_count( triangle_corners[1] ) != 3 ) || ( ( triangle_corners[0] | triangle_corners[1] ) != 0xfu ) ) {
+		return false;
+	}
+
+	const auto max_texture_size = GetMaxTextureSize();
+	const auto page = static_cast<std::size_t>( static_cast<int>( v[0] ) / max_texture_size );
+	const auto page_offset = static_cast<float>( static_cast<int>( page ) * max_texture_size );
+
+	if( static_cast<std::size_t>( static_cast<int>( v[1] ) / max_texture_size ) != page ) {
+		return false;
+	}
+
+	minimum += offset;
+	maximum += offset;
+
+	const auto left = std::max( clip_rect.left, PixelBoundary( minimum.x ) );
+	const auto right = std::min( clip_rect.left + clip_rect.width, PixelBoundary( maximum.x ) );
+	const auto top = std::max( clip_rect.top, PixelBoundary( minimum.y ) );
+	const auto bottom = std::min( clip_rect.top + clip_rect.height, PixelBoundary( maximum.y ) );
+
+	if( ( left >= right ) || ( top >= bottom ) ) {
+		return true;
+	}
+
+	if( ( u[0] == u[1] ) && ( v[0] == v[1] ) ) {
+		// Untextured, e.g. the pseudo-texture, every pixel ends up the same.
+		const auto fill_color = color * SampleAtlas( page, u[0], v[0] - page_offset );
+
+		for( auto y = top; y < bottom; ++y ) {
+			FillSpan( left, y, right - left, fill_color );
+		}
+
+		return true;
+	}
+
+	const auto u_step = ( u[1] - u[0] ) / ( maximum.x - minimum.x );
+	const auto v_step = ( v[1] - v[0] ) / ( maximum.y - minimum.y );
+
+	for( auto y = top; y < bottom; ++y ) {
+		const auto texel_v = v[0] - page_offset + ( static_cast<float>( y ) + .5f - minimum.y ) * v_step;
+
+		for( auto x = left; x < right; ++x ) {
+			const auto texel_u = u[0] + ( static_cast<float>( x ) + .5f - minimum.x ) * u_step;
+
+			BlendPixel( x, y, color * SampleAtlas( page, texel_u, texel_v ) );
+		}
+	}
+
+	return true;
+}
+
+void SoftwareRenderer::RasterizeTriangle( const PrimitiveVertex* const* vertices, const sf::Vector2f& offset, const sf::IntRect& clip_rect ) const {
+	const PrimitiveVertex* corners[3] = { vertices[0], vertices[1], vertices[2] };
+	sf::Vector2f points[3] = { corners[0]->position + offset, corners[1]->position + offset, corners[2]->position + offset };
+
+	auto area = EdgeFunction( points[0], points[1], points[2] );
+
+	if( area == 0.f ) {
+		return;
+	}
+
+	// Wind every triangle the same way.
+	if( area < 0.f ) {
+		std::swap( corners[1], corners[2] );
+		std::swap( points[1], points[2] );
+		area = -area;
+	}
+
+	const auto left = std::max( clip_rect.left, PixelBoundary( std::min( { points[0].x, points[1].x, points[2].x } ) ) );
+	const auto right = std::min( clip_rect.left + clip_rect.width, PixelBoundary( std::max( { points[0].x, points[1].x, points[2].x } ) ) );
+	const auto top = std::max( clip_rect.top, PixelBoundary( std::min( { points[0].y, points[1].y, points[2].y } ) ) );
+	const auto bottom = std::min( clip_rect.top + clip_rect.height, PixelBoundary( std::max( { points[0].y, points[1].y, points[2].y } ) ) );
+
+	if( ( left >= right ) || ( top >= bottom ) ) {
+		return;
+	}
+
+	// The atlas page can only change between triangles.
+	const auto max_texture_size = GetMaxTextureSize();
+	const auto page = static_cast<std::size_t>( static_cast<int>( corners[0]->texture_coordinate.y ) / max_texture_size );
+	const auto page_offset = static_cast<float>( static_cast<int>( page ) * max_texture_size );
+
+	const bool include_edge[3] = { IncludesEdge( points[1], points[2] ), IncludesEdge( points[2], points[0] ), IncludesEdge( points[0], points[1] ) };
+
+	for( auto y = top; y < bottom; ++y ) {
+		for( auto x = left; x < right; ++x ) {
+			const sf::Vector2f center( static_cast<float>( x ) + .5f, static_cast<float>( y ) + .5f );
+
+			const float weights[3] = { EdgeFunction( points[1], points[2], center ), EdgeFunction( points[2], points[0], center ), EdgeFunction( points[0], points[1], center ) };
+
+			auto inside = true;
+
+			for( std::size_t edge = 0; edge < 3; ++edge ) {
+				if( ( weights[edge] < 0.f ) || ( ( weights[edge] == 0.f ) && !include_edge[edge] ) ) {
+					inside = false;
+					break;
+				}
+			}
+
+			if( !inside ) {
+				continue;
+			}
+
+			const auto weight0 = weights[0] / area;
+			const auto weight1 = weights[1] / area;
+			const auto weight2 = weights[2] / area;
+
+			const auto& color0 = corners[0]->color;
+			const auto& color1 = corners[1]->color;
+			const auto& color2 = corners[2]->color;
+
+			const sf::Color color(
+				InterpolateChannel( weight0, weight1, weight2, color0.r, color1.r, color2.r ),
+				InterpolateChannel( weight0, weight1, weight2, color0.g, color1.g, color2.g ),
+				InterpolateChannel( weight0, weight1, weight2, color0.b, color1.b, color2.b ),
+				InterpolateChannel( weight0, weight1, weight2, color0.a, color1.a, color2.a )
+			);
+
+			const auto texel_u = weight0 * corners[0]->texture_coordinate.x + weight1 * corners[1]->texture_coordinate.x + weight2 * corners[2]->texture_coordinate.x;
+			const auto texel_v = weight0 * corners[0]->texture_coordinate.y + weight1 * corners[1]->texture_coordinate.y + weight2 * corners[2]->texture_coordinate.y - page_offset;
+
+			BlendPixel( x, y, color * SampleAtlas( page, texel_u, texel_v ) );
+		}
+	}
+}
+
+void SoftwareRenderer::FillSpan( int x, int y, int length, const sf::Color& color ) const {
+	auto span = m_pixels.begin() + y * m_window_size.x + x;
+
+	if( color.a == 255 ) {
+		// Opaque spans are plain stores of one packed pixel,
+		// simple enough for the compiler to vectorize.
+		std::fill_n( span, length, PackColor( color ) );
+		return;
+	}
+
+	if( !color.a ) {
+		return;
+	}
+
+	// Translucent spans blend the same color onto every pixel. Work on
+	// packed pixels, four of them per step, without unpacking channels.
+	const auto inverse_alpha = static_cast<sf::Uint32>( 255 - color.a );
+
+	sf::Uint32 even_lanes;
+	sf::Uint32 odd_lanes;
+	GetSourceLanes( color, even_lanes, odd_lanes );
+
+	auto pixel = span;
+
+	for( ; span + length - pixel >= 4; pixel += 4 ) {
+		pixel[0] = BlendLanes( pixel[0], inverse_alpha, even_lanes, odd_lanes );
+		pixel[1] = BlendLanes( pixel[1], inverse_alpha, even_lanes, odd_lanes );
+		pixel[2] = BlendLanes( pixel[2], inverse_alpha, even_lanes, odd_lanes );
+		pixel[3] = BlendLanes( pixel[3], inverse_alpha, even_lanes, odd_lanes );
+	}
+
+	for( ; pixel != span + length; ++pixel ) {
+		*pixel = BlendLanes( *pixel, inverse_alpha, even_lanes, odd_lanes );
+	}
+}
+
+void SoftwareRenderer::BlendPixel( int x, int y, const sf::Color& color ) const {
+	auto& pixel = m_pixels[static_cast<std::size_t>( y * m_window_size.x + x )];
+
+	pixel = Blend( pixel, color );
+}
+
+sf::Color SoftwareRenderer::SampleAtlas( std::size_t page, float u, float v ) const {
+	if( page >= m_atlas_images.size() ) {
+		return sf::Color::White;
+	}
+
+	const auto& image = m_atlas_images[page];
+	const auto size = static_cast<sf::Vector2i>( image.getSize() );
+
+	if( !size.x || !size.y ) {
+		return sf::Color::White;
+	}
+
+	// Nearest neighbour, the atlas is sampled 1:1 almost everywhere.
+	const auto x = std::min( std::max( static_cast<int>( std::floor( u ) ), 0 ), size.x - 1 );
+	const auto y = std::min( std::max( static_cast<int>( std::floor( v ) ), 0 ), size.y - 1 );
+
+	const auto texel = image.getPixelsPtr() + ( y * size.x + x ) * 4;
+
+	return sf::Color( texel[0], texel[1], texel[2], texel[3] );
+}
+
+void SoftwareRenderer::Present( sf::RenderTarget& target ) const {
+	if( m_pixels.empty() ) {
+		return;
+	}
+
+	const auto size = static_cast<sf::Vector2u>( m_window_size );
+
+	if( !m_texture ) {
+		m_texture.reset( new sf::Texture );
+	}
+
+	if( m_texture->getSize() != size ) {
+		m_texture->create( size.x, size.y );
+		m_texture->update( GetPixels() );
+
+		m_frame_statistics.uploaded_texture_bytes += m_pixels.size() * sizeof( m_pixels[0] );
+	}
+	else if( ( m_damaged_area.width > 0 ) && ( m_damaged_area.height > 0 ) ) {
+		// Only upload what changed.
+		std::vector<sf::Uint32> damaged_pixels( static_cast<std::size_t>( m_damaged_area.width * m_damaged_area.height ) );
+
+		for( auto row = 0; row < m_damaged_area.height; ++row ) {
+			const auto source = m_pixels.begin() + ( m_damaged_area.top + row ) * m_window_size.x + m_damaged_area.left;
+
+			std::copy( source, source + m_damaged_area.width, damaged_pixels.begin() + row * m_damaged_area.width );
+		}
+
+		m_texture->update( reinterpret_cast<const sf::Uint8*>( damaged_pixels.data() ), static_cast<unsigned int>( m_damaged_area.width ), static_cast<unsigned int>( m_damaged_area.height ), static_cast<unsigned int>( m_damaged_area.left ), static_cast<unsigned int>( m_damaged_area.top ) );
+
+		m_frame_statistics.uploaded_texture_bytes += damaged_pixels.size() * sizeof( damaged_pixels[0] );
+	}
+
+	WipeStateCache( target );
+
+	const auto view = target.getView();
+
+	target.setView( sf::View( sf::FloatRect( 0.f, 0.f, static_cast<float>( size.x ), static_cast<float>( size.y ) ) ) );
+	// The pixels are premultiplied.
+	target.draw( sf::Sprite( *m_texture ), sf::RenderStates( sf::BlendMode( sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha ) ) );
+	target.setView( view );
+
+	++m_frame_statistics.draw_call_count;
+}
+
+void SoftwareRenderer::InvalidateImpl( unsigned char /*datasets*/ ) {
+	m_dirty = true;
+}
+
+void SoftwareRenderer::ForgetTargetImpl( const void* target, bool current ) {
+	if( current ) {
+		m_pixels.clear();
+		m_texture.reset();
+
+		return;
+	}
+
+	m_target_images.erase( target );
+}
+
+void SoftwareRenderer::SelectTargetImpl( const void* previous_target, const void* target ) const {
+	if( previous_target ) {
+		auto& previous_image = m_target_images[previous_target];
+		previous_image.first.swap( m_pixels );
+		previous_image.second.swap( m_texture );
+	}
+
+	auto iter = m_target_images.find( target );
+
+	if( iter != m_target_images.end() ) {
+		m_pixels.swap( iter->second.first );
+		m_texture.swap( iter->second.second );
+
+		m_target_images.erase( iter );
+	}
+	else if( previous_target ) {
+		// Allocated when the size mismatch is noticed. The first
+		// target keeps whatever was rasterized before.
+		m_pixels.clear();
+		m_texture.reset();
+	}
+}
+
+}
@@ -1,17 +1,27 @@
 #include <SFGUI/Renderers/VertexArrayRenderer.hpp>
 #include <SFGUI/RendererBatch.hpp>
+#include <SFGUI/RendererPrimitiveRange.hpp>
 #include <SFGUI/RendererViewport.hpp>
 #include <SFGUI/Signal.hpp>
 #include <SFGUI/Primitive.hpp>
 #include <SFGUI/PrimitiveVertex.hpp>
 #include <SFGUI/GLCheck.hpp>
+#include <SFGUI/ParallelFor.hpp>
 
 #include <SFML/Graphics/Color.hpp>
 #include <SFML/Graphics/Texture.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/System/Clock.hpp>
 #include <SFML/OpenGL.hpp>
 
+namespace {
+
+// Filling in fewer primitives than this per thread isn't worth starting the thread.
+const std::size_t fill_primitives_per_thread = 1024;
+
+}
+
 namespace sfg {
 
 VertexArrayRenderer::VertexArrayRenderer() :
@@ -36,6 +46,8 @@ void VertexArrayRenderer::Display( sf::Window& target ) const {
 
 	target.setActive( true );
 
+	SelectTarget( &target );
+
 	CheckGLError( glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT ) );
 	CheckGLError( glPushAttrib( GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT ) );
 
@@ -61,6 +73,8 @@ void VertexArrayRenderer::Display( sf::RenderWindow& target ) const {
 
 	target.setActive( true );
 
+	SelectTarget( &target );
+
 	DisplayImpl();
 
 	WipeStateCache( target );
@@ -71,12 +85,16 @@ void VertexArrayRenderer::Display( sf::RenderTexture& target ) const {
 
 	target.setActive( true );
 
+	SelectTarget( &target );
+
 	DisplayImpl();
 
 	WipeStateCache( target );
 }
 
 void VertexArrayRenderer::DisplayImpl() const {
+	BeginFrameStatistics();
+
 	CheckGLError( glMatrixMode( GL_MODELVIEW ) );
 	CheckGLError( glPushMatrix() );
 	CheckGLError( glLoadIdentity() );
@@ -91,10 +109,13 @@ void VertexArrayRenderer::DisplayImpl() const {
 	// SFML doesn't seem to bother updating the OpenGL viewport when
 	// it's window resizes and nothing is drawn directly through SFML...
 
+	auto resized = false;
+
 	if( m_last_window_size != m_window_size ) {
 		CheckGLError( glViewport( 0, 0, m_window_size.x, m_window_size.y ) );
 
 		m_last_window_size = m_window_size;
+		resized = true;
 
 		if( m_window_size.x && m_window_size.y ) {
 			const_cast<VertexArrayRenderer*>( this )->Invalidate( INVALIDATE_VERTEX | INVALIDATE_TEXTURE );
@@ -125,13 +146,25 @@ void VertexArrayRenderer::DisplayImpl() const {
 		// again this might be all wrong...
 
 		// Refresh array data if out of sync
+		sf::Clock refresh_clock;
+
 		const_cast<VertexArrayRenderer*>( this )->RefreshArray();
+
+		m_frame_statistics.refresh_time = refresh_clock.getElapsedTime();
 	}
 
+	UpdateDamagedArea( resized || m_force_redraw );
+
+	m_force_redraw = false;
+
 	CheckGLError( glVertexPointer( 2, GL_FLOAT, 0, &m_vertex_data[0] ) );
 	CheckGLError( glColorPointer( 4, GL_UNSIGNED_BYTE, 0, &m_color_data[0] ) );
 	CheckGLError( glTexCoordPointer( 2, GL_FLOAT, 0, &m_texture_data[0] ) );
 
+	// Client side arrays are sourced by the driver anew every frame.
+	m_frame_statistics.uploaded_vertex_bytes += m_vertex_data.size() * ( sizeof( m_vertex_data[0] ) + sizeof( m_color_data[0] ) + sizeof( m_texture_data[0] ) );
+	m_frame_statistics.uploaded_index_bytes += m_index_data.size() * sizeof( m_index_data[0] );
+
 	// Not needed, constantly kept enabled by SFML... -_-
 	//CheckGLError( glEnableClientState( GL_VERTEX_ARRAY ) );
 	//CheckGLError( glEnableClientState( GL_COLOR_ARRAY ) );
@@ -155,6 +188,8 @@ void VertexArrayRenderer::DisplayImpl() const {
 			// Draw canvas.
 			( *batch.custom_draw_callback )();
 
+			++m_frame_statistics.draw_call_count;
+
 			CheckGLError( glViewport( 0, 0, m_window_size.x, m_window_size.y ) );
 
 			sf::Texture::bind( m_texture_atlas[static_cast<std::size_t>( current_atlas_page )].get() );
@@ -188,6 +223,8 @@ void VertexArrayRenderer::DisplayImpl() const {
 					GL_UNSIGNED_INT,
 					reinterpret_cast<const char*>( &m_index_data[0] ) + static_cast<unsigned int>( batch.start_index * static_cast<int>( sizeof( GLuint ) ) )
 				) );
+
+				++m_frame_statistics.draw_call_count;
 			}
 		}
 	}
@@ -212,188 +249,66 @@ void VertexArrayRenderer::DisplayImpl() const {
 
 	CheckGLError( glMatrixMode( GL_MODELVIEW ) );
 	CheckGLError( glPopMatrix() );
+
+	EndFrameStatistics();
 }
 
 void VertexArrayRenderer::RefreshArray() {
 	SortPrimitives();
+	CollectDamage();
 
-	m_vertex_data.clear();
-	m_color_data.clear();
-	m_texture_data.clear();
-	m_index_data.clear();
-
-	m_vertex_data.reserve( static_cast<std::size_t>( m_vertex_count ) );
-	m_color_data.reserve( static_cast<std::size_t>( m_vertex_count ) );
-	m_texture_data.reserve( static_cast<std::size_t>( m_vertex_count ) );
-	m_index_data.reserve( static_cast<std::size_t>( m_index_count ) );
+	LayoutPrimitives( m_cull, m_primitive_ranges, m_batches, m_last_vertex_count, m_last_index_count );
 
-	m_batches.clear();
+	m_vertex_data.resize( static_cast<std::size_t>( m_last_vertex_count ) );
+	m_color_data.resize( static_cast<std::size_t>( m_last_vertex_count ) );
+	m_texture_data.resize( static_cast<std::size_t>( m_last_vertex_count ) );
+	m_index_data.resize( static_cast<std::size_t>( m_last_index_count ) );
 
-	m_last_vertex_count = 0;
-	m_last_index_count = 0;
-
-	auto primitives_size = m_primitives.size();
-
-	// Default viewport
-	priv::RendererBatch current_batch;
-	current_batch.viewport = m_default_viewport;
-	current_batch.atlas_page = 0;
-	current_batch.start_index = 0;
-	current_batch.index_count = 0;
-	current_batch.min_index = 0;
-	current_batch.max_index = m_vertex_count - 1;
-	current_batch.custom_draw = false;
+	// Every primitive has its own place in the arrays, fill them in on all cores.
+	m_worker_pool->ParallelFor( m_primitive_ranges.size(), fill_primitives_per_thread, [this]( std::size_t begin, std::size_t end ) {
+		for( auto range_index = begin; range_index != end; ++range_index ) {
+			FillPrimitive( m_primitive_ranges[range_index] );
+		}
+	} );
 
-	sf::FloatRect window_viewport( 0.f, 0.f, static_cast<float>( m_window_size.x ), static_cast<float>( m_window_size.y ) );
+	// Everything is rebuilt from scratch.
+	m_frame_statistics.rebuilt_vertex_count += m_vertex_data.size();
+	m_frame_statistics.rebuilt_index_count += m_index_data.size();
+}
 
+void VertexArrayRenderer::FillPrimitive( const priv::RendererPrimitiveRange& range ) {
 	const auto max_texture_size = GetMaxTextureSize();
 	const auto default_texture_size = m_texture_atlas[0]->getSize();
 
-	for( std::size_t primitive_index = 1; primitive_index != primitives_size + 1; primitive_index += 1 ) {
-		Primitive* primitive = m_primitives[primitive_index - 1].get();
-
-		primitive->SetSynced();
-
-		if( !primitive->IsVisible() ) {
-			continue;
-		}
-
-		sf::Vector2f position_transform( primitive->GetPosition() );
-
-		auto viewport = primitive->GetViewport();
-
-		auto viewport_rect = window_viewport;
+	const auto& vertices = range.primitive->GetVertices();
+	const auto& indices = range.primitive->GetIndices();
 
-		// Check if primitive needs to be rendered in a custom viewport.
-		if( viewport && ( ( *viewport ) != ( *m_default_viewport ) ) ) {
-			sf::Vector2f destination_origin( viewport->GetDestinationOrigin() );
-			sf::Vector2f size( viewport->GetSize() );
+	const auto vertices_size = vertices.size();
 
-			position_transform += ( destination_origin - viewport->GetSourceOrigin() );
+	for( std::size_t index = 0; index < vertices_size; ++index ) {
+		const auto& vertex = vertices[index];
+		const auto destination = range.vertex_offset + index;
 
-			if( m_cull ) {
-				viewport_rect.left = destination_origin.x;
-				viewport_rect.top = destination_origin.y;
-				viewport_rect.width = size.x;
-				viewport_rect.height = size.y;
-			}
-		}
-
-		const std::shared_ptr<Signal>& custom_draw_callback( primitive->GetCustomDrawCallback() );
-
-		if( custom_draw_callback ) {
-			// Start a new batch.
-			current_batch.max_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-			m_batches.push_back( current_batch );
-
-			// Mark current_batch custom draw batch.
-			current_batch.viewport = viewport;
-			current_batch.start_index = 0;
-			current_batch.index_count = 0;
-			current_batch.min_index = 0;
-			current_batch.max_index = 0;
-			current_batch.custom_draw = true;
-			current_batch.custom_draw_callback = custom_draw_callback;
-
-			// Start a new batch.
-			m_batches.push_back( current_batch );
-
-			// Reset current_batch to defaults.
-			current_batch.viewport = m_default_viewport;
-			current_batch.start_index = m_last_index_count;
-			current_batch.index_count = 0;
-			current_batch.min_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-			current_batch.custom_draw = false;
-		}
-		else {
-			// Process primitive's vertices and indices
-			const std::vector<PrimitiveVertex>& vertices( primitive->GetVertices() );
-			const std::vector<GLuint>& indices( primitive->GetIndices() );
-
-			sf::Vector2f position( 0.f, 0.f );
-
-			sf::FloatRect bounding_rect( 0.f, 0.f, 0.f, 0.f );
-
-			auto atlas_page = 0;
-
-			const auto vertices_size = vertices.size();
-			sf::Vector2f normalizer;
-
-			for( std::size_t index = 0; index < vertices_size; ++index ) {
-				const auto vertex = vertices[index];
-				position.x = vertex.position.x + position_transform.x;
-				position.y = vertex.position.y + position_transform.y;
-
-				m_vertex_data.push_back( position );
-				m_color_data.push_back( vertex.color );
-
-				// The bound texture can only change between triangles.
-				if( index % 3 == 0 ) {
-					atlas_page = static_cast<int>( vertex.texture_coordinate.y ) / max_texture_size;
-					auto texture_size = ( vertex.texture_coordinate.y <= 1.f ) ? default_texture_size : m_texture_atlas[static_cast<std::size_t>( atlas_page )]->getSize();
-
-					// Used to normalize texture coordinates.
-					normalizer.x = 1.f / static_cast<float>( texture_size.x );
-					normalizer.y = 1.f / static_cast<float>( texture_size.y );
-				}
+		m_vertex_data[destination] = vertex.position + range.position_transform;
+		m_color_data[destination] = vertex.color;
 
-				// Normalize SFML's pixel texture coordinates.
-				m_texture_data.emplace_back( vertex.texture_coordinate.x * normalizer.x, static_cast<float>( static_cast<int>( vertex.texture_coordinate.y ) % max_texture_size ) * normalizer.y );
-
-				// Update the bounding rect.
-				if( m_cull ) {
-					if( position.x < bounding_rect.left ) {
-						bounding_rect.width += bounding_rect.left - position.x;
-						bounding_rect.left = position.x;
-					}
-					else if( position.x > bounding_rect.left + bounding_rect.width ) {
-						bounding_rect.width = position.x - bounding_rect.left;
-					}
-
-					if( position.y < bounding_rect.top ) {
-						bounding_rect.height += bounding_rect.top - position.y;
-						bounding_rect.top = position.y;
-					}
-					else if( position.y > bounding_rect.top + bounding_rect.height ) {
-						bounding_rect.height = position.y - bounding_rect.top;
-					}
-				}
-			}
+		// Glyphs of one text can lie on different pages, look the page up per vertex.
+		const auto atlas_page = static_cast<int>( vertex.texture_coordinate.y ) / max_texture_size;
+		const auto texture_size = ( vertex.texture_coordinate.y <= 1.f ) ? default_texture_size : m_texture_atlas[static_cast<std::size_t>( atlas_page )]->getSize();
 
-			if( m_cull && !viewport_rect.intersects( bounding_rect ) ) {
-				m_vertex_data.resize( static_cast<std::size_t>( m_last_vertex_count ) );
-				m_color_data.resize( static_cast<std::size_t>( m_last_vertex_count ) );
-				m_texture_data.resize( static_cast<std::size_t>( m_last_vertex_count ) );
-			}
-			else {
-				for( const auto& index : indices ) {
-					m_index_data.push_back( m_last_vertex_count + static_cast<int>( index ) );
-				}
+		// Used to normalize texture coordinates.
+		const sf::Vector2f normalizer( 1.f / static_cast<float>( texture_size.x ), 1.f / static_cast<float>( texture_size.y ) );
 
-				// Check if we need to start a new batch.
-				if( ( ( *viewport ) != ( *current_batch.viewport ) ) || ( atlas_page != current_batch.atlas_page ) ) {
-					current_batch.max_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-					m_batches.push_back( current_batch );
-
-					// Reset current_batch to defaults.
-					current_batch.viewport = viewport;
-					current_batch.atlas_page = atlas_page;
-					current_batch.start_index = m_last_index_count;
-					current_batch.index_count = 0;
-					current_batch.min_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-					current_batch.custom_draw = false;
-				}
+		// Normalize SFML's pixel texture coordinates.
+		m_texture_data[destination] = sf::Vector2f( vertex.texture_coordinate.x * normalizer.x, static_cast<float>( static_cast<int>( vertex.texture_coordinate.y ) % max_texture_size ) * normalizer.y );
+	}
 
-				current_batch.index_count += static_cast<int>( indices.size() );
+	const auto first_vertex = static_cast<int>( range.vertex_offset );
+	auto destination = m_index_data.begin() + static_cast<std::ptrdiff_t>( range.index_offset );
 
-				m_last_vertex_count += static_cast<GLsizei>( vertices.size() );
-				m_last_index_count += static_cast<GLsizei>( indices.size() );
-			}
-		}
+	for( const auto& index : indices ) {
+		*destination++ = first_vertex + static_cast<int>( index );
 	}
-
-	current_batch.max_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-	m_batches.push_back( current_batch );
 }
 
 void VertexArrayRenderer::TuneAlphaThreshold( float alpha_threshold ) {
@@ -408,4 +323,15 @@ void VertexArrayRenderer::InvalidateImpl( unsigned char /*datasets*/ ) {
 	m_dirty = true;
 }
 
+void VertexArrayRenderer::SelectTargetImpl( const void* /*previous_target*/, const void* /*target*/ ) const {
+	// The viewport only gets set when a target's size changes.
+	CheckGLError( glViewport( 0, 0, m_window_size.x, m_window_size.y ) );
+
+	// Culling depends on the size of the target, the arrays
+	// only have to be rebuilt for another target if it is enabled.
+	if( m_cull ) {
+		const_cast<VertexArrayRenderer*>( this )->m_dirty = true;
+	}
+}
+
 }
@@ -9,11 +9,14 @@
 
 #include <SFGUI/Renderers/VertexBufferRenderer.hpp>
 #include <SFGUI/RendererBatch.hpp>
+#include <SFGUI/RendererPrimitiveRange.hpp>
 #include <SFGUI/RendererViewport.hpp>
+#include <SFGUI/RendererVertex.hpp>
 #include <SFGUI/Signal.hpp>
 #include <SFGUI/Primitive.hpp>
 #include <SFGUI/PrimitiveVertex.hpp>
 #include <SFGUI/GLCheck.hpp>
+#include <SFGUI/ParallelFor.hpp>
 
 #include <SFML/Graphics/Color.hpp>
 #include <SFML/Graphics/Texture.hpp>
@@ -21,6 +24,10 @@
 #include <SFML/Graphics/RenderTexture.hpp>
 #include <SFML/Window/Context.hpp>
 #include <SFML/System/Vector3.hpp>
+#include <SFML/System/Clock.hpp>
+
+#include <cstddef>
+#include <limits>
 
 #define GLEXT_framebuffer_object sfgogl_ext_EXT_framebuffer_object
 
@@ -50,6 +57,26 @@ namespace {
 
 bool gl_initialized = false;
 
+// Filling in fewer primitives than this per thread isn't worth starting the thread.
+const std::size_t fill_primitives_per_thread = 1024;
+
+// Window area a batch drawn in the given viewport may touch,
+// restricted to the area that is being redrawn.
+sf::IntRect GetBatchArea( const sfg::RendererViewport::Ptr& viewport, const sfg::RendererViewport& default_viewport, const sf::IntRect& redraw_area ) {
+	if( !viewport || ( ( *viewport ) == default_viewport ) ) {
+		return redraw_area;
+	}
+
+	const auto& destination_origin = viewport->GetDestinationOrigin();
+	const auto& size = viewport->GetSize();
+
+	sf::IntRect area;
+
+	redraw_area.intersects( sf::IntRect( static_cast<int>( destination_origin.x ), static_cast<int>( destination_origin.y ), static_cast<int>( size.x ), static_cast<int>( size.y ) ), area );
+
+	return area;
+}
+
 }
 
 namespace sfg {
@@ -65,6 +92,7 @@ VertexBufferRenderer::VertexBufferRenderer() :
 	m_vbo_synced( false ),
 	m_cull( false ),
 	m_use_fbo( false ),
+	m_use_short_indices( false ),
 	m_vbo_supported( false ),
 	m_fbo_supported( false ) {
 
@@ -89,8 +117,6 @@ VertexBufferRenderer::VertexBufferRenderer() :
 		m_vbo_supported = true;
 
 		CheckGLError( GLEXT_glGenBuffers( 1, &m_vertex_vbo ) );
-		CheckGLError( GLEXT_glGenBuffers( 1, &m_color_vbo ) );
-		CheckGLError( GLEXT_glGenBuffers( 1, &m_texture_vbo ) );
 		CheckGLError( GLEXT_glGenBuffers( 1, &m_index_vbo ) );
 	}
 	else {
@@ -109,10 +135,20 @@ VertexBufferRenderer::~VertexBufferRenderer() {
 
 	DestroyFBO();
 
+	// Frame buffers of the other targets aren't shared between
+	// contexts and die along with them, everything else is shared.
+	for( auto& objects : m_target_objects ) {
+		if( objects.second.display_list ) {
+			CheckGLError( glDeleteLists( objects.second.display_list, 1 ) );
+		}
+
+		if( objects.second.frame_buffer_texture ) {
+			CheckGLError( glDeleteTextures( 1, &objects.second.frame_buffer_texture ) );
+		}
+	}
+
 	if( m_vbo_supported ) {
 		CheckGLError( GLEXT_glDeleteBuffers( 1, &m_index_vbo ) );
-		CheckGLError( GLEXT_glDeleteBuffers( 1, &m_texture_vbo ) );
-		CheckGLError( GLEXT_glDeleteBuffers( 1, &m_color_vbo ) );
 		CheckGLError( GLEXT_glDeleteBuffers( 1, &m_vertex_vbo ) );
 	}
 }
@@ -156,6 +192,8 @@ void VertexBufferRenderer::Display( sf::Window& target ) const {
 
 	target.setActive( true );
 
+	SelectTarget( &target );
+
 	CheckGLError( glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT ) );
 	CheckGLError( glPushAttrib( GL_COLOR_BUFFER_BIT | GL_ENABLE_BIT | GL_TEXTURE_BIT ) );
 
@@ -181,6 +219,8 @@ void VertexBufferRenderer::Display( sf::RenderWindow& target ) const {
 
 	target.setActive( true );
 
+	SelectTarget( &target );
+
 	DisplayImpl();
 
 	WipeStateCache( target );
@@ -191,6 +231,8 @@ void VertexBufferRenderer::Display( sf::RenderTexture& target ) const {
 
 	target.setActive( true );
 
+	SelectTarget( &target );
+
 	DisplayImpl();
 
 	WipeStateCache( target );
@@ -201,6 +243,8 @@ void VertexBufferRenderer::DisplayImpl() const {
 		return;
 	}
 
+	BeginFrameStatistics();
+
 	CheckGLError( glMatrixMode( GL_MODELVIEW ) );
 	CheckGLError( glPushMatrix() );
 	CheckGLError( glLoadIdentity() );
@@ -215,10 +259,13 @@ void VertexBufferRenderer::DisplayImpl() const {
 	// SFML doesn't seem to bother updating the OpenGL viewport when
 	// it's window resizes and nothing is drawn directly through SFML...
 
+	auto resized = false;
+
 	if( m_last_window_size != m_window_size ) {
 		CheckGLError( glViewport( 0, 0, m_window_size.x, m_window_size.y ) );
 
 		m_last_window_size = m_window_size;
+		resized = true;
 
 		if( m_window_size.x && m_window_size.y ) {
 			const_cast<VertexBufferRenderer*>( this )->Invalidate( INVALIDATE_VERTEX | INVALIDATE_TEXTURE );
@@ -251,40 +298,56 @@ void VertexBufferRenderer::DisplayImpl() const {
 		// again this might be all wrong...
 
 		// Refresh VBO data if out of sync
+		sf::Clock refresh_clock;
+
 		const_cast<VertexBufferRenderer*>( this )->RefreshVBO();
+
+		m_frame_statistics.refresh_time = refresh_clock.getElapsedTime();
 	}
 
-	if( !m_use_fbo || !m_vbo_synced || m_force_redraw ) {
+	UpdateDamagedArea( resized || m_force_redraw );
+
+	// The FBO keeps the last frame, only the damaged area has to be redrawn into it.
+	const auto redraw_area = m_use_fbo ? m_damaged_area : sf::IntRect( 0, 0, m_window_size.x, m_window_size.y );
+
+	if( !m_use_fbo || ( ( redraw_area.width > 0 ) && ( redraw_area.height > 0 ) ) ) {
 		// Thanks to color / texture modulation we can draw the entire
 		// frame in a single pass by pseudo-disabling the texturing with
 		// the help of a white texture ( 1.f * something = something ).
 		// Further, we stick all referenced textures into our giant atlas
 		// so we don't have to rebind during the draw.
 
+		const auto stride = static_cast<GLsizei>( sizeof( priv::RendererVertex ) );
+
 		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_vertex_vbo ) );
-		CheckGLError( glVertexPointer( 2, GL_FLOAT, 0, 0 ) );
+		CheckGLError( glVertexPointer( 2, GL_FLOAT, stride, reinterpret_cast<GLvoid*>( offsetof( priv::RendererVertex, position ) ) ) );
+		CheckGLError( glColorPointer( 4, GL_UNSIGNED_BYTE, stride, reinterpret_cast<GLvoid*>( offsetof( priv::RendererVertex, color ) ) ) );
+		CheckGLError( glTexCoordPointer( 2, GL_SHORT, stride, reinterpret_cast<GLvoid*>( offsetof( priv::RendererVertex, texture_coordinate ) ) ) );
 
-		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_color_vbo ) );
-		CheckGLError( glColorPointer( 4, GL_UNSIGNED_BYTE, 0, 0 ) );
+		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, m_index_vbo ) );
 
-		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_texture_vbo ) );
-		CheckGLError( glTexCoordPointer( 2, GL_FLOAT, 0, 0 ) );
+		// Fixed function texture coordinates aren't normalized,
+		// scale the 16-bit values back down to [0, 1].
+		CheckGLError( glScalef( 1.f / priv::texture_coordinate_scale, 1.f / priv::texture_coordinate_scale, 1.f ) );
 
-		CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, m_index_vbo ) );
+		const auto index_type = static_cast<GLenum>( m_use_short_indices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT );
+		const auto index_size = m_use_short_indices ? sizeof( GLushort ) : sizeof( GLuint );
 
 		// Not needed, constantly kept enabled by SFML... -_-
 		//CheckGLError( glEnableClientState( GL_VERTEX_ARRAY ) );
 		//CheckGLError( glEnableClientState( GL_COLOR_ARRAY ) );
 		//CheckGLError( glEnableClientState( GL_TEXTURE_COORD_ARRAY ) );
 
+		CheckGLError( glEnable( GL_SCISSOR_TEST ) );
+
 		if( m_use_fbo ) {
 			CheckGLError( GLEXT_glBindFramebuffer( GLEXT_GL_FRAMEBUFFER, m_frame_buffer ) );
 
+			// Clearing respects the scissor box.
+			CheckGLError( glScissor( redraw_area.left, m_window_size.y - redraw_area.top - redraw_area.height, redraw_area.width, redraw_area.height ) );
 			CheckGLError( glClear( GL_COLOR_BUFFER_BIT ) );
 		}
 
-		CheckGLError( glEnable( GL_SCISSOR_TEST ) );
-
 		auto current_atlas_page = 0;
 
 		sf::Texture::bind( m_texture_atlas[0].get() );
@@ -292,6 +355,14 @@ void VertexBufferRenderer::DisplayImpl() const {
 		for( const auto& batch : m_batches ) {
 			auto viewport = batch.viewport;
 
+			const auto batch_area = GetBatchArea( viewport, *m_default_viewport, redraw_area );
+
+			if( ( batch_area.width <= 0 ) || ( batch_area.height <= 0 ) ) {
+				continue;
+			}
+
+			CheckGLError( glScissor( batch_area.left, m_window_size.y - batch_area.top - batch_area.height, batch_area.width, batch_area.height ) );
+
 			if( batch.custom_draw ) {
 				auto destination = static_cast<sf::Vector2i>( viewport->GetDestinationOrigin() );
 				auto size = static_cast<sf::Vector2i>( viewport->GetSize() );
@@ -299,28 +370,19 @@ void VertexBufferRenderer::DisplayImpl() const {
 				CheckGLError( glViewport( destination.x, m_window_size.y - destination.y - size.y, size.x, size.y ) );
 
 				// Draw canvas.
+				CheckGLError( glLoadIdentity() );
+
 				( *batch.custom_draw_callback )();
 
+				++m_frame_statistics.draw_call_count;
+
+				CheckGLError( glScalef( 1.f / priv::texture_coordinate_scale, 1.f / priv::texture_coordinate_scale, 1.f ) );
+
 				CheckGLError( glViewport( 0, 0, m_window_size.x, m_window_size.y ) );
 
 				sf::Texture::bind( m_texture_atlas[static_cast<std::size_t>( current_atlas_page )].get() );
 			}
 			else {
-				if( viewport && ( ( *viewport ) != ( *m_default_viewport ) ) ) {
-					auto destination_origin = viewport->GetDestinationOrigin();
-					auto size = viewport->GetSize();
-
-					CheckGLError( glScissor(
-						static_cast<int>( destination_origin.x ),
-						m_window_size.y - static_cast<int>( destination_origin.y + size.y ),
-						static_cast<int>( size.x ),
-						static_cast<int>( size.y )
-					) );
-				}
-				else {
-					CheckGLError( glScissor( 0, 0, m_window_size.x, m_window_size.y ) );
-				}
-
 				if( batch.index_count ) {
 					if( batch.atlas_page != current_atlas_page ) {
 						current_atlas_page = batch.atlas_page;
@@ -333,15 +395,18 @@ void VertexBufferRenderer::DisplayImpl() const {
 						static_cast<unsigned int>( batch.min_index ),
 						static_cast<unsigned int>( batch.max_index ),
 						batch.index_count,
-						GL_UNSIGNED_INT,
-						reinterpret_cast<const GLvoid*>( static_cast<std::size_t>( batch.start_index ) * sizeof( GLuint ) )
+						index_type,
+						reinterpret_cast<const GLvoid*>( static_cast<std::size_t>( batch.start_index ) * index_size )
 					) );
+
+					++m_frame_statistics.draw_call_count;
 				}
 			}
 		}
 
 		CheckGLError( glDisable( GL_SCISSOR_TEST ) );
 
+		CheckGLError( glLoadIdentity() );
 
 		//CheckGLError( glDisableClientState( GL_TEXTURE_COORD_ARRAY ) );
 		//CheckGLError( glDisableClientState( GL_COLOR_ARRAY ) );
@@ -355,12 +420,17 @@ void VertexBufferRenderer::DisplayImpl() const {
 			CheckGLError( GLEXT_glBindFramebuffer( GLEXT_GL_FRAMEBUFFER, 0 ) );
 
 			CheckGLError( glCallList( m_display_list ) );
+
+			++m_frame_statistics.draw_call_count;
 		}
 
 		m_force_redraw = false;
 	}
 	else {
 		CheckGLError( glCallList( m_display_list ) );
+
+		++m_frame_statistics.draw_call_count;
+		m_frame_statistics.cache_hit = true;
 	}
 
 	m_vbo_synced = true;
@@ -377,234 +447,169 @@ void VertexBufferRenderer::DisplayImpl() const {
 
 	CheckGLError( glMatrixMode( GL_MODELVIEW ) );
 	CheckGLError( glPopMatrix() );
+
+	EndFrameStatistics();
 }
 
 void VertexBufferRenderer::RefreshVBO() {
 	SortPrimitives();
+	CollectDamage();
 
-	m_vertex_data.clear();
-	m_color_data.clear();
-	m_texture_data.clear();
-	m_index_data.clear();
-
-	m_vertex_data.reserve( static_cast<std::size_t>( m_vertex_count ) );
-	m_color_data.reserve( static_cast<std::size_t>( m_vertex_count ) );
-	m_texture_data.reserve( static_cast<std::size_t>( m_vertex_count ) );
-	m_index_data.reserve( static_cast<std::size_t>( m_index_count ) );
+	// Recolored primitives stay where they are, only their colors need to be rewritten.
+	if( m_vbo_sync_type == INVALIDATE_COLOR ) {
+		RefreshColors();
 
-	m_batches.clear();
+		m_vbo_sync_type = 0;
 
-	m_last_vertex_count = 0;
-	m_last_index_count = 0;
-
-	// Default viewport
-	priv::RendererBatch current_batch;
-	current_batch.viewport = m_default_viewport;
-	current_batch.atlas_page = 0;
-	current_batch.start_index = 0;
-	current_batch.index_count = 0;
-	current_batch.min_index = 0;
-	current_batch.max_index = m_vertex_count - 1;
-	current_batch.custom_draw = false;
+		return;
+	}
 
-	sf::FloatRect window_viewport( 0.f, 0.f, static_cast<float>( m_window_size.x ), static_cast<float>( m_window_size.y ) );
+	// 16-bit indices halve the index data as long as they can address every vertex.
+	m_use_short_indices = ( static_cast<std::size_t>( m_vertex_count ) <= static_cast<std::size_t>( std::numeric_limits<sf::Uint16>::max() ) + 1 );
 
-	const auto max_texture_size = GetMaxTextureSize();
-	const auto default_texture_size = m_texture_atlas[0]->getSize();
+	LayoutPrimitives( m_cull, m_primitive_ranges, m_batches, m_last_vertex_count, m_last_index_count );
 
-	for( const auto& primitive_ptr : m_primitives ) {
-		auto primitive = primitive_ptr.get();
+	m_vertex_data.resize( static_cast<std::size_t>( m_last_vertex_count ) );
 
-		primitive->SetSynced();
+	if( m_use_short_indices ) {
+		m_index_data.clear();
+		m_short_index_data.resize( static_cast<std::size_t>( m_last_index_count ) );
+	}
+	else {
+		m_short_index_data.clear();
+		m_index_data.resize( static_cast<std::size_t>( m_last_index_count ) );
+	}
 
-		if( !primitive->IsVisible() ) {
-			continue;
+	// Every primitive has its own place in the arrays, fill them in on all cores.
+	m_worker_pool->ParallelFor( m_primitive_ranges.size(), fill_primitives_per_thread, [this]( std::size_t begin, std::size_t end ) {
+		for( auto range_index = begin; range_index != end; ++range_index ) {
+			FillPrimitive( m_primitive_ranges[range_index] );
 		}
+	} );
 
-		auto position_transform = primitive->GetPosition();
+	// Everything is rebuilt from scratch.
+	m_frame_statistics.rebuilt_vertex_count += m_vertex_data.size();
+	m_frame_statistics.rebuilt_index_count += static_cast<std::size_t>( m_last_index_count );
 
-		auto viewport = primitive->GetViewport();
+	if( !m_vertex_data.empty() ) {
+		if( m_vbo_sync_type & ( INVALIDATE_VERTEX | INVALIDATE_COLOR | INVALIDATE_TEXTURE ) ) {
+			// Sync interleaved vertex data
+			CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_vertex_vbo ) );
+			CheckGLError( GLEXT_glBufferData( GLEXT_GL_ARRAY_BUFFER, static_cast<int>( m_vertex_data.size() * sizeof( priv::RendererVertex ) ), 0, GLEXT_GL_DYNAMIC_DRAW ) );
+			CheckGLError( GLEXT_glBufferSubData( GLEXT_GL_ARRAY_BUFFER, 0, static_cast<int>( m_vertex_data.size() * sizeof( priv::RendererVertex ) ), m_vertex_data.data() ) );
 
-		auto viewport_rect = window_viewport;
+			m_frame_statistics.uploaded_vertex_bytes += m_vertex_data.size() * sizeof( priv::RendererVertex );
+		}
 
-		// Check if primitive needs to be rendered in a custom viewport.
-		if( viewport && ( ( *viewport ) != ( *m_default_viewport ) ) ) {
-			auto destination_origin = viewport->GetDestinationOrigin();
-			auto size = viewport->GetSize();
+		if( m_vbo_sync_type & INVALIDATE_INDEX ) {
+			// Sync index data
+			const auto index_count = m_use_short_indices ? m_short_index_data.size() : m_index_data.size();
+			const auto index_size = m_use_short_indices ? sizeof( GLushort ) : sizeof( GLuint );
+			const auto index_data = m_use_short_indices ? static_cast<const void*>( m_short_index_data.data() ) : static_cast<const void*>( m_index_data.data() );
 
-			position_transform += ( destination_origin - viewport->GetSourceOrigin() );
+			CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, m_index_vbo ) );
+			CheckGLError( GLEXT_glBufferData( GLEXT_GL_ELEMENT_ARRAY_BUFFER, static_cast<int>( index_count * index_size ), 0, GLEXT_GL_DYNAMIC_DRAW ) );
 
-			if( m_cull ) {
-				viewport_rect.left = destination_origin.x;
-				viewport_rect.top = destination_origin.y;
-				viewport_rect.width = size.x;
-				viewport_rect.height = size.y;
+			if( index_count > 0 ) {
+				CheckGLError( GLEXT_glBufferSubData( GLEXT_GL_ELEMENT_ARRAY_BUFFER, 0, static_cast<int>( index_count * index_size ), index_data ) );
+
+				m_frame_statistics.uploaded_index_bytes += index_count * index_size;
 			}
-		}
 
-		const auto& custom_draw_callback = primitive->GetCustomDrawCallback();
-
-		if( custom_draw_callback ) {
-			// Start a new batch.
-			current_batch.max_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-			m_batches.push_back( current_batch );
-
-			// Mark current_batch custom draw batch.
-			current_batch.viewport = viewport;
-			current_batch.start_index = 0;
-			current_batch.index_count = 0;
-			current_batch.min_index = 0;
-			current_batch.max_index = 0;
-			current_batch.custom_draw = true;
-			current_batch.custom_draw_callback = custom_draw_callback;
-
-			// Start a new batch.
-			m_batches.push_back( current_batch );
-
-			// Reset current_batch to defaults.
-			current_batch.viewport = m_default_viewport;
-			current_batch.start_index = m_last_index_count;
-			current_batch.index_count = 0;
-			current_batch.min_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-			current_batch.custom_draw = false;
+			CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, 0 ) );
 		}
-		else {
-			// Process primitive's vertices and indices
-			const std::vector<PrimitiveVertex>& vertices( primitive->GetVertices() );
-			const std::vector<GLuint>& indices( primitive->GetIndices() );
+	}
 
-			sf::Vector2f position( 0.f, 0.f );
+	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, 0 ) );
 
-			sf::FloatRect bounding_rect( 0.f, 0.f, 0.f, 0.f );
+	m_vbo_sync_type = 0;
+}
 
-			auto atlas_page = 0;
+void VertexBufferRenderer::RefreshColors() {
+	auto first_vertex = m_vertex_data.size();
+	std::size_t last_vertex = 0;
 
-			const auto vertices_size = vertices.size();
-			sf::Vector2f normalizer;
+	for( const auto& range : m_primitive_ranges ) {
+		if( range.primitive->IsSynced() ) {
+			continue;
+		}
 
-			for( std::size_t index = 0; index < vertices_size; ++index ) {
-				const auto vertex = vertices[index];
-				position.x = vertex.position.x + position_transform.x;
-				position.y = vertex.position.y + position_transform.y;
+		const auto& vertices = range.primitive->GetVertices();
 
-				m_vertex_data.push_back( position );
-				m_color_data.push_back( vertex.color );
+		for( std::size_t index = 0; index < vertices.size(); ++index ) {
+			m_vertex_data[range.vertex_offset + index].color = vertices[index].color;
+		}
 
-				// The bound texture can only change between triangles.
-				if( index % 3 == 0 ) {
-					atlas_page = static_cast<int>( vertex.texture_coordinate.y ) / max_texture_size;
-					auto texture_size = ( vertex.texture_coordinate.y <= 1.f ) ? default_texture_size : m_texture_atlas[static_cast<std::size_t>( atlas_page )]->getSize();
+		first_vertex = std::min( first_vertex, range.vertex_offset );
+		last_vertex = std::max( last_vertex, range.vertex_offset + vertices.size() );
 
-					// Used to normalize texture coordinates.
-					normalizer.x = 1.f / static_cast<float>( texture_size.x );
-					normalizer.y = 1.f / static_cast<float>( texture_size.y );
-				}
+		m_frame_statistics.rebuilt_vertex_count += vertices.size();
+	}
 
-				// Normalize SFML's pixel texture coordinates.
-				m_texture_data.emplace_back( vertex.texture_coordinate.x * normalizer.x, static_cast<float>( static_cast<int>( vertex.texture_coordinate.y ) % max_texture_size ) * normalizer.y );
+	// Culled and hidden primitives are picked up once they are laid out again.
+	for( const auto& primitive : m_primitives ) {
+		primitive->SetSynced();
+	}
 
-				// Update the bounding rect.
-				if( m_cull ) {
-					if( position.x < bounding_rect.left ) {
-						bounding_rect.width += bounding_rect.left - position.x;
-						bounding_rect.left = position.x;
-					}
-					else if( position.x > bounding_rect.left + bounding_rect.width ) {
-						bounding_rect.width = position.x - bounding_rect.left;
-					}
+	if( first_vertex >= last_vertex ) {
+		return;
+	}
 
-					if( position.y < bounding_rect.top ) {
-						bounding_rect.height += bounding_rect.top - position.y;
-						bounding_rect.top = position.y;
-					}
-					else if( position.y > bounding_rect.top + bounding_rect.height ) {
-						bounding_rect.height = position.y - bounding_rect.top;
-					}
-				}
-			}
+	// Only upload the span that covers the recolored primitives.
+	const auto offset = first_vertex * sizeof( priv::RendererVertex );
+	const auto size = ( last_vertex - first_vertex ) * sizeof( priv::RendererVertex );
 
-			if( m_cull && !viewport_rect.intersects( bounding_rect ) ) {
-				m_vertex_data.resize( static_cast<std::size_t>( m_last_vertex_count ) );
-				m_color_data.resize( static_cast<std::size_t>( m_last_vertex_count ) );
-				m_texture_data.resize( static_cast<std::size_t>( m_last_vertex_count ) );
-			}
-			else {
-				for( const auto& index : indices ) {
-					m_index_data.push_back( static_cast<unsigned int>( m_last_vertex_count ) + index );
-				}
+	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_vertex_vbo ) );
+	CheckGLError( GLEXT_glBufferSubData( GLEXT_GL_ARRAY_BUFFER, static_cast<GLintptr>( offset ), static_cast<GLsizeiptr>( size ), &m_vertex_data[first_vertex] ) );
+	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, 0 ) );
 
-				// Check if we need to start a new batch.
-				if( ( ( *viewport ) != ( *current_batch.viewport ) ) || ( atlas_page != current_batch.atlas_page ) ) {
-					current_batch.max_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-					m_batches.push_back( current_batch );
-
-					// Reset current_batch to defaults.
-					current_batch.viewport = viewport;
-					current_batch.atlas_page = atlas_page;
-					current_batch.start_index = m_last_index_count;
-					current_batch.index_count = 0;
-					current_batch.min_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-					current_batch.custom_draw = false;
-				}
+	m_frame_statistics.uploaded_vertex_bytes += size;
+}
 
-				current_batch.index_count += static_cast<int>( indices.size() );
+void VertexBufferRenderer::FillPrimitive( const priv::RendererPrimitiveRange& range ) {
+	const auto max_texture_size = GetMaxTextureSize();
+	const auto default_texture_size = m_texture_atlas[0]->getSize();
 
-				m_last_vertex_count += static_cast<GLsizei>( vertices.size() );
-				m_last_index_count += static_cast<GLsizei>( indices.size() );
-			}
-		}
-	}
+	const auto& vertices = range.primitive->GetVertices();
+	const auto& indices = range.primitive->GetIndices();
 
-	current_batch.max_index = m_last_vertex_count ? ( m_last_vertex_count - 1 ) : 0;
-	m_batches.push_back( current_batch );
+	const auto vertices_size = vertices.size();
 
-	if( !m_vertex_data.empty() && !m_color_data.empty() && !m_texture_data.empty() ) {
-		if( m_vbo_sync_type & INVALIDATE_VERTEX ) {
-			// Sync vertex data
-			CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_vertex_vbo ) );
-			CheckGLError( GLEXT_glBufferData( GLEXT_GL_ARRAY_BUFFER, static_cast<int>( m_vertex_data.size() * sizeof( sf::Vector3f ) ), 0, GLEXT_GL_DYNAMIC_DRAW ) );
+	for( std::size_t index = 0; index < vertices_size; ++index ) {
+		const auto& vertex = vertices[index];
 
-			if( m_vertex_data.size() > 0 ) {
-				CheckGLError( GLEXT_glBufferSubData( GLEXT_GL_ARRAY_BUFFER, 0, static_cast<int>( m_vertex_data.size() * sizeof( sf::Vector2f ) ), m_vertex_data.data() ) );
-			}
-		}
+		auto& destination_vertex = m_vertex_data[range.vertex_offset + index];
 
-		if( m_vbo_sync_type & INVALIDATE_COLOR ) {
-			// Sync color data
-			CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_color_vbo ) );
-			CheckGLError( GLEXT_glBufferData( GLEXT_GL_ARRAY_BUFFER, static_cast<int>( m_color_data.size() * sizeof( sf::Color ) ), 0, GLEXT_GL_DYNAMIC_DRAW ) );
+		destination_vertex.position = vertex.position + range.position_transform;
+		destination_vertex.color = vertex.color;
 
-			if( m_color_data.size() > 0 ) {
-				CheckGLError( GLEXT_glBufferSubData( GLEXT_GL_ARRAY_BUFFER, 0, static_cast<int>( m_color_data.size() * sizeof( sf::Color ) ), m_color_data.data() ) );
-			}
-		}
+		// Glyphs of one text can lie on different pages, look the page up per vertex.
+		const auto atlas_page = static_cast<int>( vertex.texture_coordinate.y ) / max_texture_size;
+		const auto texture_size = ( vertex.texture_coordinate.y <= 1.f ) ? default_texture_size : m_texture_atlas[static_cast<std::size_t>( atlas_page )]->getSize();
 
-		if( m_vbo_sync_type & INVALIDATE_TEXTURE ) {
-			// Sync texture coord data
-			CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, m_texture_vbo ) );
-			CheckGLError( GLEXT_glBufferData( GLEXT_GL_ARRAY_BUFFER, static_cast<int>( m_texture_data.size() * sizeof( sf::Vector2f ) ), 0, GLEXT_GL_DYNAMIC_DRAW ) );
+		// Used to normalize texture coordinates.
+		const sf::Vector2f normalizer( 1.f / static_cast<float>( texture_size.x ), 1.f / static_cast<float>( texture_size.y ) );
 
-			if( m_texture_data.size() > 0 ) {
-				CheckGLError( GLEXT_glBufferSubData( GLEXT_GL_ARRAY_BUFFER, 0, static_cast<int>( m_texture_data.size() * sizeof( sf::Vector2f ) ), m_texture_data.data() ) );
-			}
-		}
+		// Normalize SFML's pixel texture coordinates.
+		destination_vertex.SetTextureCoordinate( sf::Vector2f( vertex.texture_coordinate.x * normalizer.x, static_cast<float>( static_cast<int>( vertex.texture_coordinate.y ) % max_texture_size ) * normalizer.y ) );
+	}
 
-		if( m_vbo_sync_type & INVALIDATE_INDEX ) {
-			// Sync index data
-			CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, m_index_vbo ) );
-			CheckGLError( GLEXT_glBufferData( GLEXT_GL_ELEMENT_ARRAY_BUFFER, static_cast<int>( m_index_data.size() * sizeof( GLuint ) ), 0, GLEXT_GL_DYNAMIC_DRAW ) );
+	const auto first_vertex = static_cast<unsigned int>( range.vertex_offset );
 
-			if( m_index_data.size() > 0 ) {
-				CheckGLError( GLEXT_glBufferSubData( GLEXT_GL_ELEMENT_ARRAY_BUFFER, 0, static_cast<int>( m_index_data.size() * sizeof( GLuint ) ), m_index_data.data() ) );
-			}
+	if( m_use_short_indices ) {
+		auto destination = m_short_index_data.begin() + static_cast<std::ptrdiff_t>( range.index_offset );
 
-			CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ELEMENT_ARRAY_BUFFER, 0 ) );
+		for( const auto& index : indices ) {
+			*destination++ = static_cast<sf::Uint16>( first_vertex + index );
 		}
 	}
+	else {
+		auto destination = m_index_data.begin() + static_cast<std::ptrdiff_t>( range.index_offset );
 
-	CheckGLError( GLEXT_glBindBuffer( GLEXT_GL_ARRAY_BUFFER, 0 ) );
-
-	m_vbo_sync_type = 0;
+		for( const auto& index : indices ) {
+			*destination++ = first_vertex + index;
+		}
+	}
 }
 
 void VertexBufferRenderer::InvalidateVBO( unsigned char datasets ) {
@@ -698,6 +703,8 @@ void VertexBufferRenderer::SetupFBO( int width, int height ) {
 void VertexBufferRenderer::DestroyFBO() {
 	if( m_display_list ) {
 		CheckGLError( glDeleteLists( m_display_list, 1 ) );
+
+		m_display_list = 0;
 	}
 
 	if( m_frame_buffer_texture ) {
@@ -732,14 +739,106 @@ void VertexBufferRenderer::TuneUseFBO( bool enable ) {
 
 	if( m_use_fbo ) {
 		SetupFBO( m_window_size.x, m_window_size.y );
+
+		// The new FBO doesn't hold anything yet.
+		Redraw();
 	}
 	else {
 		DestroyFBO();
 	}
 }
 
+void VertexBufferRenderer::ForgetTargetImpl( const void* target, bool current ) {
+	priv::RendererTargetObjects objects;
+
+	if( current ) {
+		objects.frame_buffer = m_frame_buffer;
+		objects.frame_buffer_texture = m_frame_buffer_texture;
+		objects.display_list = m_display_list;
+
+		m_frame_buffer = 0;
+		m_frame_buffer_texture = 0;
+		m_display_list = 0;
+	}
+	else {
+		auto iter = m_target_objects.find( target );
+
+		if( iter == m_target_objects.end() ) {
+			return;
+		}
+
+		objects = iter->second;
+
+		m_target_objects.erase( iter );
+	}
+
+	if( objects.display_list ) {
+		CheckGLError( glDeleteLists( objects.display_list, 1 ) );
+	}
+
+	if( objects.frame_buffer_texture ) {
+		CheckGLError( glDeleteTextures( 1, &objects.frame_buffer_texture ) );
+	}
+
+	if( objects.frame_buffer ) {
+		CheckGLError( GLEXT_glDeleteFramebuffers( 1, &objects.frame_buffer ) );
+	}
+}
+
 void VertexBufferRenderer::InvalidateImpl( unsigned char datasets ) {
+	// Scrolled viewports move their primitives' vertices and
+	// change which of them are culled, rewrite both buffers.
+	if( datasets & INVALIDATE_VIEWPORT ) {
+		datasets |= INVALIDATE_VERTEX | INVALIDATE_INDEX;
+	}
+
 	InvalidateVBO( datasets );
 }
 
+void VertexBufferRenderer::SelectTargetImpl( const void* previous_target, const void* target ) const {
+	auto self = const_cast<VertexBufferRenderer*>( this );
+
+	if( previous_target ) {
+		auto& previous_objects = m_target_objects[previous_target];
+		previous_objects.frame_buffer = m_frame_buffer;
+		previous_objects.frame_buffer_texture = m_frame_buffer_texture;
+		previous_objects.display_list = m_display_list;
+	}
+
+	auto iter = m_target_objects.find( target );
+
+	// The first target keeps whatever was set up before anything was drawn.
+	if( previous_target || ( iter != m_target_objects.end() ) ) {
+		priv::RendererTargetObjects objects;
+
+		if( iter != m_target_objects.end() ) {
+			objects = iter->second;
+
+			m_target_objects.erase( iter );
+		}
+
+		self->m_frame_buffer = objects.frame_buffer;
+		self->m_frame_buffer_texture = objects.frame_buffer_texture;
+		self->m_display_list = objects.display_list;
+	}
+
+	// The viewport only gets set when a target's size changes.
+	CheckGLError( glViewport( 0, 0, m_window_size.x, m_window_size.y ) );
+
+	// FBO caching might have been enabled while another target was drawn to.
+	if( m_use_fbo && !m_frame_buffer && m_window_size.x && m_window_size.y ) {
+		self->SetupFBO( m_window_size.x, m_window_size.y );
+
+		m_force_redraw = true;
+	}
+
+	// Vertex data is laid out in window coordinates and can be
+	// drawn to any target, unless culling threw some of it away.
+	// Culling against the new size also changes the batches,
+	// the index buffer has to follow them.
+	if( m_cull ) {
+		self->InvalidateVBO( INVALIDATE_VERTEX | INVALIDATE_INDEX );
+	}
+}
+
 }
@@ -7,6 +7,7 @@
 #include <SFGUI/Primitive.hpp>
 
 #include <SFML/Window/Event.hpp>
+#include <algorithm>
 #include <cmath>
 #include <limits>
 
@@ -18,6 +19,9 @@ std::weak_ptr<sfg::Widget> modal_widget;
 
 std::vector<sfg::Widget*> root_widgets;
 
+// Widgets that requested a resize since the last layout pass.
+std::vector<sfg::Widget*> layout_queue;
+
 }
 
 namespace sfg {
@@ -52,6 +56,8 @@ Widget::Widget() :
 	m_z_order( 0 ),
 	m_invalidated( true ),
 	m_parent_notified( false ),
+	m_layout_pending( false ),
+	m_layout_queued( false ),
 	m_state( State::NORMAL ),
 	m_mouse_button_down( false ),
 	m_mouse_in( false ),
@@ -73,6 +79,11 @@ Widget::~Widget() {
 			root_widgets.erase( iter );
 		}
 	}
+
+	if( m_layout_queued ) {
+		// Don't erase, FlushLayout() might be iterating the queue.
+		std::replace( layout_queue.begin(), layout_queue.end(), this, static_cast<Widget*>( nullptr ) );
+	}
 }
 
 bool Widget::IsLocallyVisible() const {
@@ -166,6 +177,30 @@ void Widget::SetAllocation( const sf::FloatRect& rect ) {
 }
 
 void Widget::RequestResize() {
+	// Ancestors of a pending widget are already pending as well.
+	if( m_layout_pending ) {
+		return;
+	}
+
+	m_layout_pending = true;
+
+	// Calculating a requisition on demand doesn't dequeue the widget.
+	if( !m_layout_queued ) {
+		m_layout_queued = true;
+		layout_queue.push_back( this );
+	}
+
+	auto parent = m_parent.lock();
+
+	if( parent ) {
+		parent->RequestResize();
+	}
+}
+
+void Widget::UpdateRequisition() {
+	// Reset first, handlers are allowed to request another resize.
+	m_layout_pending = false;
+
 	m_requisition = CalculateRequisition();
 
 	if( m_custom_requisition ) {
@@ -180,15 +215,12 @@ void Widget::RequestResize() {
 
 	HandleRequisitionChange();
 
-	auto parent = m_parent.lock();
-
 	// Notify observers.
 	GetSignals().Emit( OnSizeRequest );
 
-	if( parent ) {
-		parent->RequestResize();
-	}
-	else {
+	// The parent is pending as well and picks up the
+	// new requisition when it is calculated itself.
+	if( !m_parent.lock() ) {
 		sf::FloatRect allocation(
 			GetAllocation().left,
 			GetAllocation().top,
@@ -206,6 +238,11 @@ const sf::FloatRect& Widget::GetAllocation() const {
 }
 
 void Widget::Update( float seconds ) {
+	// Lay out the hierarchy before updating it if nobody else did.
+	if( !layout_queue.empty() && !m_parent.lock() ) {
+		FlushLayout();
+	}
+
 	if( m_invalidated ) {
 		m_invalidated = false;
 		m_parent_notified = false;
@@ -272,6 +309,11 @@ void Widget::SetParent( Widget::Ptr parent ) {
 		}
 
 		SetHierarchyLevel( parent->GetHierarchyLevel() + 1 );
+
+		// Keep the new parent pending for as long as this widget is.
+		if( m_layout_pending ) {
+			parent->RequestResize();
+		}
 	}
 	else {
 		// If this widget does not have a parent, it becomes a root widget.
@@ -575,6 +617,10 @@ void Widget::Show( bool show ) {
 }
 
 const sf::Vector2f& Widget::GetRequisition() const {
+	while( m_layout_pending ) {
+		const_cast<Widget*>( this )->UpdateRequisition();
+	}
+
 	return m_requisition;
 }
 
@@ -772,6 +818,11 @@ void Widget::HandleSizeChange() {
 }
 
 void Widget::HandleStateChange( State /*old_state*/ ) {
+	// A pending invalidation recreates the drawable anyway.
+	if( !m_invalidated && m_drawable && m_drawable->UpdateState() ) {
+		return;
+	}
+
 	Invalidate();
 }
 
@@ -824,6 +875,33 @@ void Widget::RefreshAll() {
 	}
 }
 
+void Widget::FlushLayout() {
+	// Widgets queued while flushing are appended and handled in the same pass.
+	for( std::size_t index = 0; index < layout_queue.size(); ++index ) {
+		// Handlers might destroy the widget, so always read it from the queue.
+		while( layout_queue[index] && layout_queue[index]->m_layout_pending ) {
+			// Start at the topmost pending ancestor. Each widget's requisition
+			// is then calculated once when its parent asks for it.
+			auto topmost = layout_queue[index];
+			auto parent = topmost->m_parent.lock();
+
+			while( parent && parent->m_layout_pending ) {
+				topmost = parent.get();
+				parent = topmost->m_parent.lock();
+			}
+
+			topmost->UpdateRequisition();
+		}
+
+		// Requesting a resize from now on queues the widget again.
+		if( layout_queue[index] ) {
+			layout_queue[index]->m_layout_queued = false;
+		}
+	}
+
+	layout_queue.clear();
+}
+
 void Widget::HandleRequisitionChange() {
 }
 
@@ -837,6 +915,11 @@ void Widget::HandleSetHierarchyLevel() {
 }
 
 void Widget::SetHierarchyLevel( int level ) {
+	// Restacking windows leaves most of them where they are.
+	if( level == m_hierarchy_level ) {
+		return;
+	}
+
 	m_hierarchy_level = level;
 
 	HandleSetHierarchyLevel();